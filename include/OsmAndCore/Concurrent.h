@@ -3,6 +3,7 @@
 
 #include <OsmAndCore/stdlib_common.h>
 #include <functional>
+#include <deque>
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QThreadPool>
@@ -13,6 +14,7 @@
 #include <QMutex>
 #include <QAtomicInt>
 #include <QQueue>
+#include <QList>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -145,6 +147,100 @@ namespace OsmAnd
             void shutdown();
             void shutdownAsync();
         };
+
+        // Executes tasks on fixed set of workers, each having own deque of tasks. Worker takes newest tasks from
+        // own deque first, and when it's empty, steals oldest tasks from other workers. Tasks started from
+        // a worker go to its own deque, so a task may spawn subtasks and wait for them in a group: waiting
+        // worker executes pending tasks instead of blocking, so nested parallelism does not exhaust workers.
+        class OSMAND_CORE_API WorkStealingPool
+        {
+            Q_DISABLE_COPY_AND_MOVE(WorkStealingPool);
+        public:
+            class OSMAND_CORE_API TaskGroup
+            {
+                Q_DISABLE_COPY_AND_MOVE(TaskGroup);
+            private:
+                mutable QMutex _mutex;
+                QWaitCondition _finishedCondition;
+                int _pendingTasksCount;
+            protected:
+            public:
+                TaskGroup();
+                ~TaskGroup();
+
+                bool isFinished() const;
+
+            friend class OsmAnd::Concurrent::WorkStealingPool;
+            };
+
+            struct OSMAND_CORE_API Statistics
+            {
+                Statistics();
+
+                unsigned int workersCount;
+                unsigned int executedTasks;
+                unsigned int stolenTasks;
+                unsigned int failedStealAttempts;
+                float idleTime;
+            };
+        private:
+            struct QueuedTask
+            {
+                Task* task;
+                TaskGroup* group;
+            };
+
+            struct Worker
+            {
+                Worker(const unsigned int index);
+
+                const unsigned int index;
+                std::unique_ptr<Thread> thread;
+
+                mutable QMutex dequeMutex;
+                std::deque<QueuedTask> deque;
+
+                QAtomicInt executedTasks;
+                QAtomicInt stolenTasks;
+                QAtomicInt failedStealAttempts;
+                mutable QMutex idleTimeMutex;
+                float idleTime;
+            };
+            QList<Worker*> _workers;
+            QAtomicInt _nextWorkerIndex;
+
+            volatile bool _shutdownRequested;
+            QAtomicInt _queuedTasksCount;
+            QAtomicInt _runningTasksCount;
+            mutable QMutex _wakeupMutex;
+            QWaitCondition _wakeup;
+            QWaitCondition _allTasksDone;
+
+            Worker* getCurrentWorker() const;
+            bool takeTask(Worker* const worker, QueuedTask& outQueuedTask);
+            void executeTask(Worker* const worker, const QueuedTask& queuedTask);
+            void workerProcedure(Worker* const worker);
+        protected:
+        public:
+            WorkStealingPool(const unsigned int workersCount = 0);
+            ~WorkStealingPool();
+
+            unsigned int getWorkersCount() const;
+
+            // Task is deleted after execution, if it's auto-deletable
+            void start(Task* const task, TaskGroup* const group = nullptr);
+
+            // Caller executes pending tasks while group is not finished. Only if there's nothing to execute,
+            // caller blocks until group is finished.
+            void waitFor(TaskGroup& group);
+            void waitForDone();
+
+            Statistics getStatistics() const;
+
+            // Process-wide pool with default number of workers. It's created (and its workers are started) on
+            // first call, so that nothing is spawned until some work actually needs it
+            static WorkStealingPool& shared();
+        };
     }
 }
 
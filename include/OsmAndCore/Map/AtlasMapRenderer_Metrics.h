@@ -32,6 +32,8 @@ namespace OsmAnd
         FIELD_ACTION(float, elapsedTimeForObtainingRenderableSymbolsOnlyLock, "s");                             \
         FIELD_ACTION(float, elapsedTimeForObtainRenderableSymbolCalls, "s");                                    \
         FIELD_ACTION(unsigned int, obtainRenderableSymbolCalls, "");                                            \
+        FIELD_ACTION(unsigned int, preparedSymbolsReused, "");                                                  \
+        FIELD_ACTION(unsigned int, renderableSymbolsReused, "");                                                \
         FIELD_ACTION(unsigned int, onPathSymbolsRejectedByFrustum, "");                                         \
         FIELD_ACTION(unsigned int, onSurfaceSymbolsRejectedByFrustum, "");                                      \
         FIELD_ACTION(unsigned int, billboardSymbolsRejectedByFrustum, "");                                      \
@@ -5,6 +5,7 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QVector>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonSWIG.h>
@@ -74,6 +75,21 @@ namespace OsmAnd
         virtual void forcedFrameInvalidate() = 0;
         virtual void forcedGpuProcessingCycle() = 0;
 
+        // States that are expected to be reached soon (e.g. by running animation), so that resources for them are
+        // requested in advance. Empty list cancels the prediction.
+        virtual void setPredictedStates(const QList<MapRendererState>& predictedStates) = 0;
+
+        // Map data of tiles covering corridor along path (e.g. upcoming part of route) is obtained and rasterized
+        // in advance for each zoom of given range, but not uploaded to GPU. Tiles are warmed gradually, starting
+        // from the beginning of path and not faster than given rate, with lower priority than visible ones. Amount
+        // of held data is limited, and data of tiles passed by target is released. Empty path cancels the prefetch.
+        virtual void setPrefetchCorridor(
+            const QVector<PointI>& path31,
+            const ZoomLevel minZoom,
+            const ZoomLevel maxZoom,
+            const unsigned int bufferInTiles = 1,
+            const float tilesPerSecond = 4.0f) = 0;
+
         virtual unsigned int getSymbolsCount() const = 0;
         virtual QList< std::shared_ptr<const MapSymbol> > getSymbolsAt(const PointI& screenPoint) const = 0;
         virtual bool isSymbolsUpdateSuspended(int* const pOutSuspendsCounter = nullptr) const = 0;
@@ -22,7 +22,16 @@ namespace OsmAnd
         FIELD_ACTION(float, elapsedTimeForUpdatesProcessing, "s");                      \
                                                                                         \
         /* Time elapsed to process all scheduled calls in render thread */              \
-        FIELD_ACTION(float, elapsedTimeForRenderThreadDispatcher, "s");
+        FIELD_ACTION(float, elapsedTimeForRenderThreadDispatcher, "s");                 \
+                                                                                        \
+        /* Time elapsed to sync resources in GPU from render thread */                  \
+        FIELD_ACTION(float, elapsedTimeForGpuSync, "s");                                \
+        FIELD_ACTION(unsigned int, resourcesUploadedToGPU, "");                         \
+        FIELD_ACTION(unsigned int, bytesUploadedToGPU, "B");                            \
+        FIELD_ACTION(unsigned int, resourcesUnloadedFromGPU, "");                       \
+                                                                                        \
+        /* Set if per-frame upload budget was exhausted and uploads were deferred */    \
+        FIELD_ACTION(unsigned int, gpuUploadsDeferred, "");
         struct OSMAND_CORE_API Metric_update : public Metric
         {
             Metric_update();
@@ -7,6 +7,7 @@
 #include <OsmAndCore/ignore_warnings_on_external_includes.h>
 #include <QMap>
 #include <QList>
+#include <QByteArray>
 #include <OsmAndCore/restore_internal_warnings.h>
 
 #include <OsmAndCore.h>
@@ -17,6 +18,7 @@
 #include <OsmAndCore/Map/ResolvedMapStyle.h>
 
 class SkBitmap;
+class SkPaint;
 
 namespace OsmAnd
 {
@@ -91,6 +93,11 @@ namespace OsmAnd
         bool obtainTextShield(const QString& name, std::shared_ptr<const SkBitmap>& outTextShield) const;
         bool obtainIconShield(const QString& name, std::shared_ptr<const SkBitmap>& outIconShield) const;
 
+        // Paints configured by rasterizers from style outputs, shared by all rasterizers of this environment.
+        // Null paint means that nothing is painted for such outputs
+        bool obtainCachedPaint(const QByteArray& key, std::shared_ptr<const SkPaint>& outPaint) const;
+        void cachePaint(const QByteArray& key, const std::shared_ptr<const SkPaint>& paint) const;
+
         ColorARGB getDefaultBackgroundColor(const ZoomLevel zoom) const;
         void obtainShadowOptions(const ZoomLevel zoom, ShadowMode& mode, ColorARGB& color) const;
         double getPolygonAreaMinimalThreshold(const ZoomLevel zoom) const;
@@ -0,0 +1,52 @@
+#ifndef _OSMAND_CORE_MAP_PRIMITIVES_CODEC_H_
+#define _OSMAND_CORE_MAP_PRIMITIVES_CODEC_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QByteArray>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/Map/MapPrimitiviser.h>
+
+namespace OsmAnd
+{
+    class MapPresentationEnvironment;
+
+    // Encodes primitivised objects of an area (tile) into compact versioned binary form and decodes them back,
+    // so that they can be rasterized later (e.g. many times or on other machine) without reading OBFs and
+    // evaluating style. Geometry is delta-encoded relative to the area, style outputs are referenced by name so
+    // that decoding is not bound to value definition ids of specific resolved style instance.
+    // Only data used by rasterization and symbols is kept: source objects are restored with geometry, sharing and
+    // sorting keys and visibility zoom range only.
+    class OSMAND_CORE_API MapPrimitivesCodec
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapPrimitivesCodec);
+    public:
+        enum {
+            FormatVersion = 2,
+        };
+
+    private:
+        MapPrimitivesCodec();
+        ~MapPrimitivesCodec();
+    protected:
+    public:
+        static bool encode(
+            const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+            const AreaI area31,
+            QByteArray& outData,
+            const bool compress = true);
+
+        // In case area size in pixels is specified, scale of decoded primitives is adjusted to it. Style outputs
+        // (like stroke widths) remain the same as they were evaluated on encoding
+        static std::shared_ptr<MapPrimitiviser::PrimitivisedObjects> decode(
+            const QByteArray& data,
+            const std::shared_ptr<const MapPresentationEnvironment>& environment,
+            AreaI* const outArea31 = nullptr,
+            const PointI* const areaSizeInPixels = nullptr);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_PRIMITIVES_CODEC_H_)
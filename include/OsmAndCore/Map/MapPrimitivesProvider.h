@@ -18,6 +18,7 @@
 
 namespace OsmAnd
 {
+    class RasterTilesDiskCache;
     class MapPrimitivesProvider_P;
     class OSMAND_CORE_API MapPrimitivesProvider : public IMapTiledDataProvider
     {
@@ -57,7 +58,9 @@ namespace OsmAnd
             const std::shared_ptr<IMapObjectsProvider>& mapObjectsProvider,
             const std::shared_ptr<MapPrimitiviser>& primitiviser,
             const unsigned int tileSize = 256,
-            const Mode mode = Mode::WithSurface);
+            const Mode mode = Mode::WithSurface,
+            const std::shared_ptr<RasterTilesDiskCache>& diskCache = nullptr,
+            const std::shared_ptr<MapPrimitiviser::Cache>& primitiviserCache = nullptr);
         virtual ~MapPrimitivesProvider();
 
         const std::shared_ptr<IMapObjectsProvider> mapObjectsProvider;
@@ -65,6 +68,14 @@ namespace OsmAnd
         const unsigned int tileSize;
         const Mode mode;
 
+        // Primitivised tiles are looked up in disk cache (if any) before reading map objects, and stored there
+        // afterwards. Tiles taken from disk cache carry no map objects data
+        const std::shared_ptr<RasterTilesDiskCache> diskCache;
+
+        // Primitives groups and coastlines parts are shared between tiles of same zoom via this cache (if any).
+        // It pays off when many tiles of same zoom are primitivised concurrently, e.g. by batch rendering
+        const std::shared_ptr<MapPrimitiviser::Cache> primitiviserCache;
+
         virtual ZoomLevel getMinZoom() const;
         virtual ZoomLevel getMaxZoom() const;
 
@@ -75,12 +86,26 @@ namespace OsmAnd
             std::shared_ptr<Metric>* pOutMetric = nullptr,
             const IQueryController* const queryController = nullptr);
 
+        // Newly obtained tile is retained as recent one, so that tiles of nearby zoom can be derived from it (see
+        // obtainDerivedData()). Tiles obtained in advance, not for display, should not be retained to avoid
+        // pushing recently shown tiles out.
         bool obtainData(
             const TileId tileId,
             const ZoomLevel zoom,
             std::shared_ptr<Data>& outTiledData,
             MapPrimitivesProvider_Metrics::Metric_obtainData* const metric,
-            const IQueryController* const queryController);
+            const IQueryController* const queryController,
+            const bool retainAsRecent = true);
+
+        // Derives tile from recently obtained tiles of nearby zoom without reading map objects: from nearest
+        // parent tile (overscaling) or from all four child tiles (underscaling). Primitives are clipped to the tile
+        // and scaled to it, but keep style outputs of zoom they were evaluated at, and derived tile has no symbols.
+        // Never blocks; returns false if no suitable tiles were obtained recently. Derived tile is meant to be shown
+        // only until actual tile is obtained
+        bool obtainDerivedData(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            std::shared_ptr<Data>& outTiledData);
     };
 }
 
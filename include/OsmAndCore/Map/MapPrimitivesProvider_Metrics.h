@@ -16,7 +16,13 @@ namespace OsmAnd
     {
 #define OsmAnd__MapPrimitivesProvider_Metrics__Metric_obtainData__FIELDS(FIELD_ACTION)          \
         /* Total elapsed time */                                                                \
-        FIELD_ACTION(float, elapsedTime, "s");
+        FIELD_ACTION(float, elapsedTime, "s");                                                  \
+                                                                                                \
+        /* Number of tiles taken from disk cache */                                             \
+        FIELD_ACTION(unsigned int, diskCacheHits, "");                                          \
+                                                                                                \
+        /* Number of tiles not found in disk cache */                                           \
+        FIELD_ACTION(unsigned int, diskCacheMisses, "");
         struct OSMAND_CORE_API Metric_obtainData : public Metric
         {
             Metric_obtainData();
@@ -7,6 +7,10 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QVector>
+#include <QHash>
+#include <QPair>
+#include <QReadWriteLock>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -22,6 +26,8 @@ namespace OsmAnd
 {
     class MapObject;
     class MapPresentationEnvironment;
+    class MapPrimitivesCodec;
+    class MapPrimitivesProvider_P;
 
     class MapPrimitiviser_P;
     class OSMAND_CORE_API MapPrimitiviser
@@ -86,6 +92,7 @@ namespace OsmAnd
 
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
+        friend class OsmAnd::MapPrimitivesCodec;
         };
         
         class OSMAND_CORE_API Primitive Q_DECL_FINAL
@@ -124,8 +131,14 @@ namespace OsmAnd
             int zOrder;
             int64_t doubledArea;
 
+            // Geometry of source object, simplified according to zoom and scale. In case no simplification was
+            // performed, it's implicitly shared with geometry of source object.
+            QVector< PointI > points31;
+            QList< QVector< PointI > > innerPolygonsPoints31;
+
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
+        friend class OsmAnd::MapPrimitivesCodec;
         };
 
         class Symbol;
@@ -150,6 +163,7 @@ namespace OsmAnd
         
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
+        friend class OsmAnd::MapPrimitivesCodec;
         };
 
         class OSMAND_CORE_API Symbol
@@ -182,6 +196,7 @@ namespace OsmAnd
 
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
+        friend class OsmAnd::MapPrimitivesCodec;
         };
 
         class OSMAND_CORE_API TextSymbol : public Symbol
@@ -214,6 +229,7 @@ namespace OsmAnd
 
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
+        friend class OsmAnd::MapPrimitivesCodec;
         };
 
         class OSMAND_CORE_API IconSymbol : public Symbol
@@ -238,6 +254,7 @@ namespace OsmAnd
 
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
+        friend class OsmAnd::MapPrimitivesCodec;
         };
 
         class OSMAND_CORE_API Cache
@@ -246,24 +263,73 @@ namespace OsmAnd
         public:
             typedef SharedResourcesContainer<MapObject::SharingKey, const PrimitivesGroup> SharedPrimitivesGroupsContainer;
             typedef SharedResourcesContainer<MapObject::SharingKey, const SymbolsGroup> SharedSymbolsGroupsContainer;
+            typedef QList< QVector< PointI > > CoastlineParts;
 
         private:
         protected:
-            std::array<SharedPrimitivesGroupsContainer, ZoomLevelsCount> _sharedPrimitivesGroups;
+            // Primitives groups depend on scale (geometry is simplified and tiny polygons are dropped according
+            // to it), so they are shared only between primitivisations of same zoom and same scale
+            typedef QPair<double, double> ScaleKey;
+            mutable QReadWriteLock _sharedPrimitivesGroupsLock;
+            std::array<QHash< ScaleKey, std::shared_ptr<SharedPrimitivesGroupsContainer> >, ZoomLevelsCount> _sharedPrimitivesGroups;
             std::array<SharedSymbolsGroupsContainer, ZoomLevelsCount> _sharedSymbolsGroups;
+
+            // Parts of coastlines that are inside specific block (tile of coarser zoom), shared across all tiles
+            // and zoom levels that are covered by that block
+            struct CachedCoastline
+            {
+                std::weak_ptr<const MapObject> coastline;
+                QHash< TileId, CoastlineParts > partsInBlocks;
+            };
+            mutable QReadWriteLock _coastlinesPartsLock;
+            std::array<QHash< const MapObject*, CachedCoastline >, ZoomLevelsCount> _coastlinesParts;
+            unsigned int _coastlinesPartsStoredSincePurge;
+            void purgeExpiredCoastlinesParts();
+
+            // Cached parts are limited by total count of their points (about 8MB), and parts that were stored
+            // earliest are evicted first
+            enum {
+                MaxCoastlinesPartsPointsCount = 1024 * 1024,
+            };
+            struct CoastlinePartsKey
+            {
+                ZoomLevel blockZoom;
+                const MapObject* coastline;
+                TileId blockId;
+            };
+            QList<CoastlinePartsKey> _coastlinesPartsStoreOrder;
+            size_t _coastlinesPartsPointsCount;
+            void evictEarliestCoastlineParts();
+            static size_t getPointsCount(const CoastlineParts& parts);
         public:
             Cache();
             virtual ~Cache();
 
-            virtual SharedPrimitivesGroupsContainer& getPrimitivesGroups(const ZoomLevel zoom);
-            virtual const SharedPrimitivesGroupsContainer& getPrimitivesGroups(const ZoomLevel zoom) const;
+            virtual SharedPrimitivesGroupsContainer& getPrimitivesGroups(
+                const ZoomLevel zoom,
+                const PointD scaleDivisor31ToPixel);
+            virtual const SharedPrimitivesGroupsContainer* findPrimitivesGroups(
+                const ZoomLevel zoom,
+                const PointD scaleDivisor31ToPixel) const;
             virtual SharedSymbolsGroupsContainer& getSymbolsGroups(const ZoomLevel zoom);
             virtual const SharedSymbolsGroupsContainer& getSymbolsGroups(const ZoomLevel zoom) const;
             
-            SharedPrimitivesGroupsContainer* getPrimitivesGroupsPtr(const ZoomLevel zoom);
-            const SharedPrimitivesGroupsContainer* getPrimitivesGroupsPtr(const ZoomLevel zoom) const;
+            SharedPrimitivesGroupsContainer* getPrimitivesGroupsPtr(
+                const ZoomLevel zoom,
+                const PointD scaleDivisor31ToPixel);
             SharedSymbolsGroupsContainer* getSymbolsGroupsPtr(const ZoomLevel zoom);
             const SharedSymbolsGroupsContainer* getSymbolsGroupsPtr(const ZoomLevel zoom) const;
+
+            virtual bool obtainCoastlineParts(
+                const std::shared_ptr<const MapObject>& coastline,
+                const TileId blockId,
+                const ZoomLevel blockZoom,
+                CoastlineParts& outParts) const;
+            virtual void storeCoastlineParts(
+                const std::shared_ptr<const MapObject>& coastline,
+                const TileId blockId,
+                const ZoomLevel blockZoom,
+                const CoastlineParts& parts);
         };
         
         class OSMAND_CORE_API PrimitivisedObjects Q_DECL_FINAL
@@ -295,6 +361,8 @@ namespace OsmAnd
 
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
+        friend class OsmAnd::MapPrimitivesCodec;
+        friend class OsmAnd::MapPrimitivesProvider_P;
         };
     private:
         PrivateImplementation<MapPrimitiviser_P> _p;
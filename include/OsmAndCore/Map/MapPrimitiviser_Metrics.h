@@ -69,6 +69,15 @@ namespace OsmAnd
         /* Number of obtained point primitives */                                                   \
         FIELD_ACTION(unsigned int, pointPrimitives, "");                                            \
                                                                                                     \
+        /* Time spent on simplifying geometry of primitives */                                      \
+        FIELD_ACTION(float, elapsedTimeForSimplifyingGeometry, "s");                                \
+                                                                                                    \
+        /* Number of vertices in geometry before simplification */                                  \
+        FIELD_ACTION(unsigned int, verticesBeforeSimplification, "");                               \
+                                                                                                    \
+        /* Number of vertices in geometry after simplification */                                   \
+        FIELD_ACTION(unsigned int, verticesAfterSimplification, "");                                \
+                                                                                                    \
         /* Time spent on sorting and filtering primitives */                                        \
         FIELD_ACTION(float, elapsedTimeForSortingAndFilteringPrimitives, "s");                      \
                                                                                                     \
@@ -135,6 +144,12 @@ namespace OsmAnd
         /* Number of polygonized coastlines */                                                      \
         FIELD_ACTION(unsigned int, polygonizedCoastlines, "");                                      \
                                                                                                     \
+        /* Number of coastlines which parts inside block were found in cache */                     \
+        FIELD_ACTION(unsigned int, coastlinesPartsCacheHits, "");                                   \
+                                                                                                    \
+        /* Number of coastlines which parts inside block were not found in cache */                 \
+        FIELD_ACTION(unsigned int, coastlinesPartsCacheMisses, "");                                 \
+                                                                                                    \
         /* Time spent on obtaining primitives (from coastlines) */                                  \
         FIELD_ACTION(float, elapsedTimeForObtainingPrimitivesFromCoastlines, "s");
 
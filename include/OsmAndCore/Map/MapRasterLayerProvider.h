@@ -72,6 +72,17 @@ namespace OsmAnd
             MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
             const IQueryController* const queryController);
 
+        // Checks if tile can be obtained without rasterization, e.g. from disk cache
+        bool isDataCached(const TileId tileId, const ZoomLevel zoom) const;
+
+        // Rasterizes tile derived from recently obtained primitives of nearby zoom (see
+        // MapPrimitivesProvider::obtainDerivedData()), to be shown until actual tile is obtained
+        bool obtainDerivedData(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            std::shared_ptr<Data>& outTiledData,
+            const IQueryController* const queryController = nullptr);
+
         virtual ZoomLevel getMinZoom() const;
         virtual ZoomLevel getMaxZoom() const;
     };
@@ -16,7 +16,31 @@ namespace OsmAnd
     {
 #define OsmAnd__MapRasterLayerProvider_Metrics__Metric_obtainData__FIELDS(FIELD_ACTION)                 \
         /* Total elapsed time */                                                                        \
-        FIELD_ACTION(float, elapsedTime, "s");
+        FIELD_ACTION(float, elapsedTime, "s");                                                          \
+                                                                                                        \
+        /* Number of rasterized metatiles */                                                            \
+        FIELD_ACTION(unsigned int, metatilesRasterized, "");                                            \
+                                                                                                        \
+        /* Elapsed time for rasterizing metatiles */                                                    \
+        FIELD_ACTION(float, elapsedTimeForMetatiles, "s");                                              \
+                                                                                                        \
+        /* Number of tiles served as slices of metatiles */                                             \
+        FIELD_ACTION(unsigned int, tilesFromMetatiles, "");                                             \
+                                                                                                        \
+        /* Share of metatile rasterization time per each served tile */                                 \
+        FIELD_ACTION(float, amortizedElapsedTimePerTile, "s");                                          \
+                                                                                                        \
+        /* Number of rasterization surfaces taken from pool */                                          \
+        FIELD_ACTION(unsigned int, surfacesReused, "");                                                 \
+                                                                                                        \
+        /* Number of newly allocated rasterization surfaces */                                          \
+        FIELD_ACTION(unsigned int, surfacesAllocated, "");                                              \
+                                                                                                        \
+        /* Number of tiles taken from disk cache */                                                     \
+        FIELD_ACTION(unsigned int, diskCacheHits, "");                                                  \
+                                                                                                        \
+        /* Number of tiles not found in disk cache */                                                   \
+        FIELD_ACTION(unsigned int, diskCacheMisses, "");
         struct OSMAND_CORE_API Metric_obtainData : public Metric
         {
             Metric_obtainData();
@@ -14,6 +14,7 @@
 namespace OsmAnd
 {
     class MapPrimitivesProvider;
+    class RasterTilesDiskCache;
     class MapRasterLayerProvider_Software_P;
     class OSMAND_CORE_API MapRasterLayerProvider_Software : public MapRasterLayerProvider
     {
@@ -23,8 +24,27 @@ namespace OsmAnd
     public:
         MapRasterLayerProvider_Software(
             const std::shared_ptr<MapPrimitivesProvider>& primitivesProvider,
-            const bool fillBackground = true);
+            const bool fillBackground = true,
+            const unsigned int metatileSize = 1,
+            const unsigned int rasterizationBandsCount = 1,
+            const bool limitColorDepthBy16bits = false,
+            const std::shared_ptr<RasterTilesDiskCache>& diskCache = nullptr);
         virtual ~MapRasterLayerProvider_Software();
+
+        // In case metatile size is N > 1, NxN tiles are primitivised and rasterized at once and then
+        // sliced to separate tiles
+        const unsigned int metatileSize;
+
+        // In case bands count is not 1, each tile (or metatile) is split into that many horizontal bands that are
+        // rasterized concurrently. 0 means by number of CPU cores
+        const unsigned int rasterizationBandsCount;
+
+        // Tiles are rasterized directly to RGB565 (or ARGB4444 if background is not filled) instead of RGBA8888.
+        // Should match MapRendererConfiguration::limitTextureColorDepthBy16bits to avoid conversion by renderer
+        const bool limitColorDepthBy16bits;
+
+        // Rasterized tiles are looked up in disk cache (if any) before primitivisation, and stored there afterwards
+        const std::shared_ptr<RasterTilesDiskCache> diskCache;
     };
 }
 
@@ -15,6 +15,7 @@
 #include <OsmAndCore/Map/MapRasterizer_Metrics.h>
 
 class SkCanvas;
+class SkBitmap;
 
 namespace OsmAnd
 {
@@ -41,6 +42,17 @@ namespace OsmAnd
             const AreaI* const destinationArea = nullptr,
             MapRasterizer_Metrics::Metric_rasterize* const metric = nullptr,
             const IQueryController* const controller = nullptr);
+
+        // Splits target bitmap into horizontal bands that are rasterized concurrently. Output is the same
+        // as of rasterization onto a single canvas. If bands count is 0, it's selected by number of CPU cores
+        void rasterizeInBands(
+            const AreaI area31,
+            const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+            SkBitmap& targetBitmap,
+            const bool fillBackground = true,
+            const unsigned int bandsCount = 0,
+            MapRasterizer_Metrics::Metric_rasterize* const metric = nullptr,
+            const IQueryController* const controller = nullptr);
     };
 }
 
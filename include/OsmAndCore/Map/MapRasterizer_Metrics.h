@@ -16,7 +16,19 @@ namespace OsmAnd
     {
 #define OsmAnd__MapRasterizer_Metrics__Metric_rasterize__FIELDS(FIELD_ACTION)       \
         /* Total elapsed time */                                                    \
-        FIELD_ACTION(float, elapsedTime, "s");
+        FIELD_ACTION(float, elapsedTime, "s");                                      \
+                                                                                    \
+        /* Elapsed time for clipping geometry to area */                            \
+        FIELD_ACTION(float, elapsedTimeForClipping, "s");                           \
+                                                                                    \
+        /* Number of primitives that were clipped */                                \
+        FIELD_ACTION(unsigned int, clippedPrimitives, "");                          \
+                                                                                    \
+        /* Number of vertices removed by clipping */                                \
+        FIELD_ACTION(unsigned int, verticesClippedAway, "");                        \
+                                                                                    \
+        /* Number of bands rasterized concurrently */                               \
+        FIELD_ACTION(unsigned int, rasterizedBands, "");
         struct OSMAND_CORE_API Metric_rasterize : public Metric
         {
             Metric_rasterize();
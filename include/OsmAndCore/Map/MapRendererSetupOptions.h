@@ -25,6 +25,12 @@ namespace OsmAnd
         GpuWorkerThreadPrologue gpuWorkerThreadPrologue;
         GpuWorkerThreadEpilogue gpuWorkerThreadEpilogue;
 
+        // When GPU worker is not used, resources are uploaded from render thread. To avoid missing frames, amount
+        // of data (in bytes) and time (in microseconds) spent on uploads per frame are limited, and resources that do
+        // not fit are uploaded during following frames. At least one resource is uploaded per frame. 0 means "no limit"
+        size_t maxGpuUploadBytesPerFrame;
+        unsigned int maxGpuUploadTimePerFrame;
+
         // This callback is called when frame needs update
         OSMAND_CALLABLE(FrameUpdateRequestCallback, void, const IMapRenderer* const mapRenderer);
         FrameUpdateRequestCallback frameUpdateRequestCallback;
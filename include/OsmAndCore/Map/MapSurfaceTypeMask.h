@@ -0,0 +1,78 @@
+#ifndef _OSMAND_CORE_MAP_SURFACE_TYPE_MASK_H_
+#define _OSMAND_CORE_MAP_SURFACE_TYPE_MASK_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QString>
+#include <QVector>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/Map/MapCommonTypes.h>
+
+namespace OsmAnd
+{
+    class ObfReader;
+    class IObfsCollection;
+    class IQueryController;
+
+    // Quadtree of land/water/mixed surface types of tiles, precomputed from basemap. Fully land or fully water
+    // tiles are leaves, so surface type of any tile is resolved in at most maxZoom steps without reading OBF data.
+    // Leaves also know if basemap has no objects in them at any zoom, so such tiles don't need basemap read-out
+    class OSMAND_CORE_API MapSurfaceTypeMask
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapSurfaceTypeMask);
+    public:
+        enum {
+            DefaultMaxZoom = ZoomLevel12,
+        };
+
+    private:
+    protected:
+        // Each entry holds surface type in lower 2 bits and 'no basemap objects' flag in 3rd bit. Mixed entry may
+        // also hold (index + 1) of node with 4 entries of its children (in order: top-left, top-right, bottom-left,
+        // bottom-right) in upper bits
+        typedef uint32_t Entry;
+        enum {
+            EntrySurfaceTypeMask = 0x3u,
+            EntryNoObjectsFlag = 0x4u,
+            EntryChildrenShift = 3,
+        };
+
+        MapSurfaceTypeMask(const ZoomLevel maxZoom, const Entry root, const QVector<Entry>& nodes);
+
+        const Entry _root;
+        const QVector<Entry> _nodes;
+
+        static Entry encodeSurfaceType(const MapSurfaceType surfaceType);
+        static MapSurfaceType decodeSurfaceType(const Entry entry);
+    public:
+        virtual ~MapSurfaceTypeMask();
+
+        const ZoomLevel maxZoom;
+
+        MapSurfaceType getSurfaceType(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            bool* const outHasNoBasemapObjects = nullptr) const;
+
+        bool saveTo(const QString& fileName) const;
+        static std::shared_ptr<const MapSurfaceTypeMask> loadFrom(const QString& fileName);
+
+        static std::shared_ptr<const MapSurfaceTypeMask> buildFromBasemap(
+            const std::shared_ptr<const ObfReader>& basemapReader,
+            const ZoomLevel maxZoom = static_cast<ZoomLevel>(DefaultMaxZoom),
+            const IQueryController* const controller = nullptr);
+
+        // Loads mask from file, or builds it from basemap of given collection and saves it to that file (if
+        // file name is specified)
+        static std::shared_ptr<const MapSurfaceTypeMask> obtain(
+            const std::shared_ptr<const IObfsCollection>& obfsCollection,
+            const QString& fileName = QString::null,
+            const ZoomLevel maxZoom = static_cast<ZoomLevel>(DefaultMaxZoom),
+            const IQueryController* const controller = nullptr);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_SURFACE_TYPE_MASK_H_)
@@ -18,6 +18,7 @@
 namespace OsmAnd
 {
     class IObfsCollection;
+    class MapSurfaceTypeMask;
 
     class ObfMapObjectsProvider_P;
     class OSMAND_CORE_API ObfMapObjectsProvider : public IMapObjectsProvider
@@ -37,11 +38,13 @@ namespace OsmAnd
     public:
         ObfMapObjectsProvider(
             const std::shared_ptr<const IObfsCollection>& obfsCollection,
-            const Mode mode = Mode::BinaryMapObjectsAndRoads);
+            const Mode mode = Mode::BinaryMapObjectsAndRoads,
+            const std::shared_ptr<const MapSurfaceTypeMask>& surfaceTypeMask = nullptr);
         virtual ~ObfMapObjectsProvider();
 
         const std::shared_ptr<const IObfsCollection> obfsCollection;
         const Mode mode;
+        const std::shared_ptr<const MapSurfaceTypeMask> surfaceTypeMask;
 
         virtual ZoomLevel getMinZoom() const;
         virtual ZoomLevel getMaxZoom() const;
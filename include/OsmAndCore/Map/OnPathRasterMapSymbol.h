@@ -30,6 +30,9 @@ namespace OsmAnd
 
         QVector<float> glyphsWidth;
         std::shared_ptr< const QVector<PointI> > shareablePath31;
+        // Lengths of segments of path in 31-coordinates, computed in advance since they don't depend on view.
+        // Valid only if computed for current path, reset on setPath31()
+        std::shared_ptr< const QVector<float> > shareablePathSegmentsLengths31;
         PinPoint pinPointOnPath;
 
         virtual QVector<PointI> getPath31() const;
@@ -37,6 +40,9 @@ namespace OsmAnd
         virtual void setPath31(const QVector<PointI>& path31);
         virtual void setPath31(const std::shared_ptr< const QVector<PointI> >& sharedPath31);
 
+        bool hasPathSegmentsLengths31() const;
+        static QVector<float> computePathSegmentsLengths31(const QVector<PointI>& path31);
+
         virtual PinPoint getPinPointOnPath() const;
         virtual void setPinPointOnPath(const PinPoint& pinPoint);
     };
@@ -0,0 +1,49 @@
+#ifndef _OSMAND_CORE_RASTER_TILES_DISK_CACHE_H_
+#define _OSMAND_CORE_RASTER_TILES_DISK_CACHE_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QString>
+#include <QByteArray>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/PrivateImplementation.h>
+
+namespace OsmAnd
+{
+    // Directory of encoded tiles (rasterized tiles or primitives), limited by total size. Least recently used entries
+    // are removed once the limit is exceeded. Key of entry is a relative path that is unique for tile and its content
+    class RasterTilesDiskCache_P;
+    class OSMAND_CORE_API RasterTilesDiskCache
+    {
+        Q_DISABLE_COPY_AND_MOVE(RasterTilesDiskCache);
+    public:
+        enum {
+            DefaultMaxSizeInMegabytes = 256,
+        };
+
+    private:
+        PrivateImplementation<RasterTilesDiskCache_P> _p;
+    protected:
+    public:
+        RasterTilesDiskCache(
+            const QString& path,
+            const uint64_t maxSize = static_cast<uint64_t>(DefaultMaxSizeInMegabytes) * 1024 * 1024);
+        virtual ~RasterTilesDiskCache();
+
+        const QString path;
+        const uint64_t maxSize;
+
+        bool containsEntry(const QString& key) const;
+        bool obtainEntry(const QString& key, QByteArray& outData);
+        bool storeEntry(const QString& key, const QByteArray& data);
+        void clear();
+
+        uint64_t getTotalSize() const;
+        unsigned int getEntriesCount() const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_RASTER_TILES_DISK_CACHE_H_)
@@ -0,0 +1,303 @@
+#ifndef _OSMAND_CORE_UNIFORM_GRID_H_
+#define _OSMAND_CORE_UNIFORM_GRID_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <algorithm>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QList>
+#include <QVector>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/QuadTree.h>
+
+namespace OsmAnd
+{
+    // Spatial index that splits root area into cells of same size. Suits well for many small elements of similar
+    // size that are spread over bounded area (like symbols on screen), where it has to visit only few cells per
+    // test. Has same interface as QuadTree (and uses same bounding boxes), but acceptors are taken by template
+    // parameter, so that they are inlined instead of being called through std::function
+    template<typename ELEMENT_TYPE, typename COORD_TYPE>
+    class UniformGrid
+    {
+    public:
+        typedef UniformGrid<ELEMENT_TYPE, COORD_TYPE> UniformGridT;
+        typedef Area<COORD_TYPE> AreaT;
+        typedef OOBB<COORD_TYPE> OOBBT;
+        typedef Point<COORD_TYPE> PointT;
+        typedef typename QuadTree<ELEMENT_TYPE, COORD_TYPE>::BBoxType BBoxType;
+        typedef typename QuadTree<ELEMENT_TYPE, COORD_TYPE>::BBox BBox;
+
+    private:
+    protected:
+        struct Entry
+        {
+            BBox bbox;
+            AreaT aabb;
+            ELEMENT_TYPE element;
+        };
+
+        AreaT _rootArea;
+        COORD_TYPE _cellSize;
+        int _columnsCount;
+        int _rowsCount;
+
+        // Removed entries are left in place (only unreferenced from cells), since cells reference entries by index
+        QVector< Entry > _entries;
+        QVector< QVector<int> > _cells;
+
+        static inline AreaT getAABB(const BBox& bbox)
+        {
+            if (bbox.type == BBoxType::AABB)
+                return bbox.asAABB;
+            else /* if (bbox.type == BBoxType::OOBB) */
+                return bbox.asOOBB.aabb();
+        }
+
+        static inline bool contains(const BBox& which, const BBox& what)
+        {
+            if (what.type == BBoxType::AABB)
+                return which.contains(what.asAABB);
+            else /* if (what.type == BBoxType::OOBB) */
+                return which.contains(what.asOOBB);
+        }
+
+        static inline bool intersects(const BBox& which, const BBox& what)
+        {
+            if (what.type == BBoxType::AABB)
+                return which.intersects(what.asAABB);
+            else /* if (what.type == BBoxType::OOBB) */
+                return which.intersects(what.asOOBB);
+        }
+
+        static inline bool contains(const BBox& which, const PointT& what)
+        {
+            if (which.type == BBoxType::AABB)
+                return which.asAABB.contains(what);
+            else /* if (which.type == BBoxType::OOBB) */
+                return which.asOOBB.contains(what);
+        }
+
+        inline int getColumn(const COORD_TYPE x) const
+        {
+            return qBound(0, static_cast<int>((x - _rootArea.left()) / _cellSize), _columnsCount - 1);
+        }
+
+        inline int getRow(const COORD_TYPE y) const
+        {
+            return qBound(0, static_cast<int>((y - _rootArea.top()) / _cellSize), _rowsCount - 1);
+        }
+
+        // Visits every entry that may match given bbox exactly once. Entry that spans several cells is visited
+        // only in the first cell shared by both entry and bbox, so no per-query state is needed
+        template<typename VISITOR>
+        bool visit(const AreaT& aabb, const VISITOR& visitor) const
+        {
+            if (_cells.isEmpty() || !_rootArea.intersects(aabb))
+                return false;
+
+            const auto minColumn = getColumn(aabb.left());
+            const auto maxColumn = getColumn(aabb.right());
+            const auto minRow = getRow(aabb.top());
+            const auto maxRow = getRow(aabb.bottom());
+
+            for (auto row = minRow; row <= maxRow; row++)
+            {
+                for (auto column = minColumn; column <= maxColumn; column++)
+                {
+                    const auto& cell = _cells[row * _columnsCount + column];
+                    for (const auto entryIndex : constOf(cell))
+                    {
+                        const auto& entry = _entries[entryIndex];
+                        if (column != std::max(minColumn, getColumn(entry.aabb.left())) ||
+                            row != std::max(minRow, getRow(entry.aabb.top())))
+                        {
+                            continue;
+                        }
+
+                        if (visitor(entry))
+                            return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+    public:
+        inline UniformGrid()
+            : _cellSize(1)
+            , _columnsCount(0)
+            , _rowsCount(0)
+        {
+        }
+
+        inline UniformGrid(const AreaT& rootArea_, const COORD_TYPE cellSize_)
+            : _rootArea(rootArea_)
+            , _cellSize(std::max(cellSize_, static_cast<COORD_TYPE>(1)))
+            , _columnsCount(std::max(static_cast<int>(rootArea_.width() / _cellSize) + 1, 1))
+            , _rowsCount(std::max(static_cast<int>(rootArea_.height() / _cellSize) + 1, 1))
+        {
+            _cells.resize(_columnsCount * _rowsCount);
+        }
+
+        ~UniformGrid()
+        {
+        }
+
+        inline const AreaT& rootArea() const
+        {
+            return _rootArea;
+        }
+
+        inline AreaT getRootArea() const
+        {
+            return _rootArea;
+        }
+
+        inline COORD_TYPE cellSize() const
+        {
+            return _cellSize;
+        }
+
+        inline bool insert(const ELEMENT_TYPE& element, const BBox& bbox, const bool strict = false)
+        {
+            const auto aabb = getAABB(bbox);
+            if (_cells.isEmpty() || !_rootArea.intersects(aabb))
+                return false;
+            if (strict && !bbox.isContainedBy(_rootArea))
+                return false;
+
+            const auto entryIndex = _entries.size();
+            _entries.push_back({ bbox, aabb, element });
+
+            const auto minColumn = getColumn(aabb.left());
+            const auto maxColumn = getColumn(aabb.right());
+            const auto minRow = getRow(aabb.top());
+            const auto maxRow = getRow(aabb.bottom());
+            for (auto row = minRow; row <= maxRow; row++)
+            {
+                for (auto column = minColumn; column <= maxColumn; column++)
+                    _cells[row * _columnsCount + column].push_back(entryIndex);
+            }
+
+            return true;
+        }
+
+        template<typename ACCEPTOR>
+        inline bool test(const BBox& bbox, const bool strict, const ACCEPTOR& acceptor) const
+        {
+            return visit(getAABB(bbox),
+                [&bbox, strict, &acceptor]
+                (const Entry& entry) -> bool
+                {
+                    if (!contains(bbox, entry.bbox) && (strict || !intersects(bbox, entry.bbox)))
+                        return false;
+
+                    return acceptor(entry.element, entry.bbox);
+                });
+        }
+
+        inline bool test(const BBox& bbox, const bool strict = false) const
+        {
+            return visit(getAABB(bbox),
+                [&bbox, strict]
+                (const Entry& entry) -> bool
+                {
+                    return contains(bbox, entry.bbox) || (!strict && intersects(bbox, entry.bbox));
+                });
+        }
+
+        template<typename ACCEPTOR>
+        inline void query(const BBox& bbox, QList<ELEMENT_TYPE>& outResults, const bool strict, const ACCEPTOR& acceptor) const
+        {
+            visit(getAABB(bbox),
+                [&bbox, &outResults, strict, &acceptor]
+                (const Entry& entry) -> bool
+                {
+                    if (!contains(bbox, entry.bbox) && (strict || !intersects(bbox, entry.bbox)))
+                        return false;
+
+                    if (acceptor(entry.element, entry.bbox))
+                        outResults.push_back(entry.element);
+                    return false;
+                });
+        }
+
+        inline void query(const BBox& bbox, QList<ELEMENT_TYPE>& outResults, const bool strict = false) const
+        {
+            query(bbox, outResults, strict,
+                []
+                (const ELEMENT_TYPE&, const BBox&) -> bool
+                {
+                    return true;
+                });
+        }
+
+        template<typename ACCEPTOR>
+        inline void select(const PointT& point, QList<ELEMENT_TYPE>& outResults, const ACCEPTOR& acceptor) const
+        {
+            visit(AreaT(point, point),
+                [&point, &outResults, &acceptor]
+                (const Entry& entry) -> bool
+                {
+                    if (contains(entry.bbox, point) && acceptor(entry.element, entry.bbox))
+                        outResults.push_back(entry.element);
+                    return false;
+                });
+        }
+
+        inline void select(const PointT& point, QList<ELEMENT_TYPE>& outResults) const
+        {
+            select(point, outResults,
+                []
+                (const ELEMENT_TYPE&, const BBox&) -> bool
+                {
+                    return true;
+                });
+        }
+
+        inline bool removeOne(const ELEMENT_TYPE& element, const BBox& bbox)
+        {
+            const auto aabb = getAABB(bbox);
+            if (_cells.isEmpty() || !_rootArea.intersects(aabb))
+                return false;
+
+            // Entry is expected to be removed using same bbox it was inserted with, so it's referenced from first
+            // cell of that bbox
+            auto& cell = _cells[getRow(aabb.top()) * _columnsCount + getColumn(aabb.left())];
+            int entryIndex = -1;
+            for (const auto cellEntryIndex : constOf(cell))
+            {
+                if (_entries[cellEntryIndex].element != element)
+                    continue;
+
+                entryIndex = cellEntryIndex;
+                break;
+            }
+            if (entryIndex < 0)
+                return false;
+
+            const auto& entryAABB = _entries[entryIndex].aabb;
+            const auto minColumn = getColumn(entryAABB.left());
+            const auto maxColumn = getColumn(entryAABB.right());
+            const auto minRow = getRow(entryAABB.top());
+            const auto maxRow = getRow(entryAABB.bottom());
+            for (auto row = minRow; row <= maxRow; row++)
+            {
+                for (auto column = minColumn; column <= maxColumn; column++)
+                    _cells[row * _columnsCount + column].removeOne(entryIndex);
+            }
+
+            _entries[entryIndex].element = ELEMENT_TYPE();
+
+            return true;
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_UNIFORM_GRID_H_)
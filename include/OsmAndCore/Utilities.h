@@ -747,6 +747,7 @@ namespace OsmAnd
         static void findDirectories(const QDir& origin, const QStringList& masks, QFileInfoList& directories, const bool recursively = true);
 
         static void scanlineFillPolygon(const unsigned int verticesCount, const PointF* const vertices, std::function<void(const PointI&)> fillPoint);
+        static bool simplifyPolyline(const QVector<PointI>& points, const double tolerance, QVector<PointI>& outSimplifiedPoints);
 
         inline static QSet<ZoomLevel> enumerateZoomLevels(const ZoomLevel from, const ZoomLevel to)
         {
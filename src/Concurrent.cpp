@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "Common.h"
+#include "Stopwatch.h"
 
 OsmAnd::Concurrent::Task::Task(ExecuteSignature executeMethod, PreExecuteSignature preExecuteMethod /*= nullptr*/, PostExecuteSignature postExecuteMethod /*= nullptr*/)
     : _cancellationRequestedByTask(false)
@@ -261,3 +262,294 @@ void OsmAnd::Concurrent::Dispatcher::shutdownAsync()
 
     _shutdownRequested = true;
 }
+
+OsmAnd::Concurrent::WorkStealingPool::WorkStealingPool(const unsigned int workersCount /*= 0*/)
+    : _nextWorkerIndex(0)
+    , _shutdownRequested(false)
+    , _queuedTasksCount(0)
+    , _runningTasksCount(0)
+{
+    const auto actualWorkersCount = workersCount > 0
+        ? workersCount
+        : static_cast<unsigned int>(qMax(QThread::idealThreadCount(), 1));
+    for (auto workerIndex = 0u; workerIndex < actualWorkersCount; workerIndex++)
+    {
+        const auto worker = new Worker(workerIndex);
+        worker->thread.reset(new Thread(std::bind(&WorkStealingPool::workerProcedure, this, worker)));
+        _workers.push_back(worker);
+    }
+
+    // Start workers only after all of them were created, since they steal from each other
+    for (const auto& worker : constOf(_workers))
+        worker->thread->start();
+}
+
+OsmAnd::Concurrent::WorkStealingPool::~WorkStealingPool()
+{
+    waitForDone();
+
+    // Stop workers
+    {
+        QMutexLocker scopedLocker(&_wakeupMutex);
+
+        _shutdownRequested = true;
+        _wakeup.wakeAll();
+    }
+    for (const auto& worker : constOf(_workers))
+    {
+        REPEAT_UNTIL(worker->thread->wait());
+        delete worker;
+    }
+    _workers.clear();
+}
+
+unsigned int OsmAnd::Concurrent::WorkStealingPool::getWorkersCount() const
+{
+    return _workers.size();
+}
+
+OsmAnd::Concurrent::WorkStealingPool::Worker* OsmAnd::Concurrent::WorkStealingPool::getCurrentWorker() const
+{
+    const auto currentThread = QThread::currentThread();
+    for (const auto& worker : constOf(_workers))
+    {
+        if (worker->thread.get() == currentThread)
+            return worker;
+    }
+
+    return nullptr;
+}
+
+bool OsmAnd::Concurrent::WorkStealingPool::takeTask(Worker* const worker, QueuedTask& outQueuedTask)
+{
+    bool taken = false;
+
+    // Newest task from own deque is preferred, since it's data is most likely still in cache
+    if (worker)
+    {
+        QMutexLocker scopedLocker(&worker->dequeMutex);
+
+        if (!worker->deque.empty())
+        {
+            outQueuedTask = worker->deque.back();
+            worker->deque.pop_back();
+            taken = true;
+        }
+    }
+
+    // Otherwise steal oldest task from other worker
+    if (!taken)
+    {
+        const auto workersCount = _workers.size();
+        const auto firstVictimIndex = worker
+            ? worker->index + 1
+            : static_cast<unsigned int>(_nextWorkerIndex.loadAcquire());
+        for (auto offset = 0; offset < workersCount && !taken; offset++)
+        {
+            const auto victim = _workers[(firstVictimIndex + offset) % workersCount];
+            if (victim == worker)
+                continue;
+
+            QMutexLocker scopedLocker(&victim->dequeMutex);
+
+            if (!victim->deque.empty())
+            {
+                outQueuedTask = victim->deque.front();
+                victim->deque.pop_front();
+                taken = true;
+            }
+        }
+
+        if (worker)
+        {
+            if (taken)
+                worker->stolenTasks.fetchAndAddOrdered(1);
+            else
+                worker->failedStealAttempts.fetchAndAddOrdered(1);
+        }
+    }
+
+    if (!taken)
+        return false;
+
+    // Task is counted as running before it stops being counted as queued, so that pool never looks done
+    // while there's still a task
+    _runningTasksCount.fetchAndAddOrdered(1);
+    _queuedTasksCount.fetchAndSubOrdered(1);
+
+    return true;
+}
+
+void OsmAnd::Concurrent::WorkStealingPool::executeTask(Worker* const worker, const QueuedTask& queuedTask)
+{
+    const auto task = queuedTask.task;
+    const auto group = queuedTask.group;
+
+    task->run();
+    if (task->autoDelete())
+        delete task;
+
+    if (worker)
+        worker->executedTasks.fetchAndAddOrdered(1);
+
+    // After group is reported as finished, it may be destroyed immediately
+    if (group)
+    {
+        QMutexLocker scopedLocker(&group->_mutex);
+
+        group->_pendingTasksCount--;
+        if (group->_pendingTasksCount == 0)
+            group->_finishedCondition.wakeAll();
+    }
+
+    if (_runningTasksCount.fetchAndSubOrdered(1) == 1 && _queuedTasksCount.loadAcquire() == 0)
+    {
+        QMutexLocker scopedLocker(&_wakeupMutex);
+        _allTasksDone.wakeAll();
+    }
+}
+
+void OsmAnd::Concurrent::WorkStealingPool::workerProcedure(Worker* const worker)
+{
+    while (!_shutdownRequested)
+    {
+        QueuedTask queuedTask;
+        if (takeTask(worker, queuedTask))
+        {
+            executeTask(worker, queuedTask);
+            continue;
+        }
+
+        // Sleep until there's a task to take
+        const Stopwatch idleStopwatch(true);
+        {
+            QMutexLocker scopedLocker(&_wakeupMutex);
+
+            if (!_shutdownRequested && _queuedTasksCount.loadAcquire() == 0)
+                REPEAT_UNTIL(_wakeup.wait(&_wakeupMutex));
+        }
+        {
+            QMutexLocker scopedLocker(&worker->idleTimeMutex);
+            worker->idleTime += idleStopwatch.elapsed();
+        }
+    }
+}
+
+void OsmAnd::Concurrent::WorkStealingPool::start(Task* const task, TaskGroup* const group /*= nullptr*/)
+{
+    assert(task != nullptr);
+
+    if (group)
+    {
+        QMutexLocker scopedLocker(&group->_mutex);
+        group->_pendingTasksCount++;
+    }
+
+    // Task started from a worker goes to it's own deque, otherwise workers are used in round-robin manner
+    auto worker = getCurrentWorker();
+    if (!worker)
+    {
+        const auto workerIndex = static_cast<unsigned int>(_nextWorkerIndex.fetchAndAddOrdered(1));
+        worker = _workers[workerIndex % _workers.size()];
+    }
+    {
+        QMutexLocker scopedLocker(&worker->dequeMutex);
+
+        QueuedTask queuedTask;
+        queuedTask.task = task;
+        queuedTask.group = group;
+        worker->deque.push_back(queuedTask);
+    }
+    _queuedTasksCount.fetchAndAddOrdered(1);
+
+    {
+        QMutexLocker scopedLocker(&_wakeupMutex);
+        _wakeup.wakeOne();
+    }
+}
+
+void OsmAnd::Concurrent::WorkStealingPool::waitFor(TaskGroup& group)
+{
+    const auto worker = getCurrentWorker();
+    while (!group.isFinished())
+    {
+        QueuedTask queuedTask;
+        if (takeTask(worker, queuedTask))
+        {
+            executeTask(worker, queuedTask);
+            continue;
+        }
+
+        // Nothing to execute, so remaining tasks of group are being executed by others
+        QMutexLocker scopedLocker(&group._mutex);
+        while (group._pendingTasksCount > 0)
+            REPEAT_UNTIL(group._finishedCondition.wait(&group._mutex));
+    }
+}
+
+void OsmAnd::Concurrent::WorkStealingPool::waitForDone()
+{
+    QMutexLocker scopedLocker(&_wakeupMutex);
+
+    while (_queuedTasksCount.loadAcquire() != 0 || _runningTasksCount.loadAcquire() != 0)
+        REPEAT_UNTIL(_allTasksDone.wait(&_wakeupMutex));
+}
+
+OsmAnd::Concurrent::WorkStealingPool::Statistics OsmAnd::Concurrent::WorkStealingPool::getStatistics() const
+{
+    Statistics statistics;
+
+    statistics.workersCount = _workers.size();
+    for (const auto& worker : constOf(_workers))
+    {
+        statistics.executedTasks += worker->executedTasks.loadAcquire();
+        statistics.stolenTasks += worker->stolenTasks.loadAcquire();
+        statistics.failedStealAttempts += worker->failedStealAttempts.loadAcquire();
+
+        QMutexLocker scopedLocker(&worker->idleTimeMutex);
+        statistics.idleTime += worker->idleTime;
+    }
+
+    return statistics;
+}
+
+OsmAnd::Concurrent::WorkStealingPool& OsmAnd::Concurrent::WorkStealingPool::shared()
+{
+    static WorkStealingPool sharedPool;
+    return sharedPool;
+}
+
+OsmAnd::Concurrent::WorkStealingPool::TaskGroup::TaskGroup()
+    : _pendingTasksCount(0)
+{
+}
+
+OsmAnd::Concurrent::WorkStealingPool::TaskGroup::~TaskGroup()
+{
+    assert(_pendingTasksCount == 0);
+}
+
+bool OsmAnd::Concurrent::WorkStealingPool::TaskGroup::isFinished() const
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    return _pendingTasksCount == 0;
+}
+
+OsmAnd::Concurrent::WorkStealingPool::Statistics::Statistics()
+    : workersCount(0)
+    , executedTasks(0)
+    , stolenTasks(0)
+    , failedStealAttempts(0)
+    , idleTime(0.0f)
+{
+}
+
+OsmAnd::Concurrent::WorkStealingPool::Worker::Worker(const unsigned int index_)
+    : index(index_)
+    , executedTasks(0)
+    , stolenTasks(0)
+    , failedStealAttempts(0)
+    , idleTime(0.0f)
+{
+}
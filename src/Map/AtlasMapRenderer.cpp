@@ -84,7 +84,26 @@ bool OsmAnd::AtlasMapRenderer::postPrepareFrame()
         return false;
 
     // Notify resources manager about new active zone
-    getResources().updateActiveZone(_uniqueTiles, currentState.zoomBase);
+    const auto internalState = static_cast<const AtlasMapRendererInternalState*>(getInternalStateRef());
+    getResources().updateActiveZone(
+        _uniqueTiles,
+        currentState.zoomBase,
+        Utilities::normalizeTileId(internalState->targetTileId, currentState.zoomBase));
+
+    // Resources for predicted states are requested in advance
+    QList<MapRendererState> predictedStates;
+    if (obtainUpdatedPredictedStates(predictedStates))
+    {
+        MapRendererResourcesManager::TilesByZoom predictedTiles;
+        for (const auto& predictedState : constOf(predictedStates))
+        {
+            QSet<TileId> tiles;
+            if (!obtainVisibleTiles(predictedState, *currentConfiguration, tiles))
+                continue;
+            predictedTiles[predictedState.zoomBase].unite(tiles);
+        }
+        getResources().updatePrefetchZone(MapRendererResourcesManager::PrefetchZone::AnimationPath, predictedTiles);
+    }
 
     return true;
 }
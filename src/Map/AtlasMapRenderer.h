@@ -91,6 +91,13 @@ namespace OsmAnd
         virtual QList<TileId> getVisibleTiles() const;
         virtual unsigned int getVisibleTilesCount() const;
 
+        // Computes unique tiles visible in given state. Uses only given state and configuration, so may be
+        // called from any thread, e.g. to check whether predicted state would need other tiles
+        virtual bool obtainVisibleTiles(
+            const MapRendererState& state,
+            const MapRendererConfiguration& configuration,
+            QSet<TileId>& outUniqueTiles) const = 0;
+
         // Symbols-related
         virtual QList< std::shared_ptr<const MapSymbol> > getSymbolsAt(const PointI& screenPoint) const;
     };
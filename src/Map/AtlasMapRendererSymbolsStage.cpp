@@ -36,6 +36,12 @@
 
 OsmAnd::AtlasMapRendererSymbolsStage::AtlasMapRendererSymbolsStage(AtlasMapRenderer* const renderer_)
     : AtlasMapRendererStage(renderer_)
+    , _lastPreparedSymbolsValid(false)
+    , _lastPreparedStateRevision(0)
+    , _lastPreparedPublishedMapSymbolsRevision(0)
+    , _lastPreparedMapSymbolsUpdatesRevision(0)
+    , _lastPreparedWithSymbolsUpdateSuspended(false)
+    , _keepObtainedRenderables(false)
 {
 }
 
@@ -47,7 +53,36 @@ void OsmAnd::AtlasMapRendererSymbolsStage::prepare(AtlasMapRenderer_Metrics::Met
 {
     Stopwatch stopwatch(metric != nullptr);
 
-    IntersectionsQuadTree intersections;
+    // Debug stage is cleared each frame, so with debug stage enabled state is treated as changed each frame
+    const auto publishedMapSymbolsRevision = getPublishedMapSymbolsRevision();
+    const auto symbolsUpdateSuspended = renderer->isSymbolsUpdateSuspended();
+    const auto stateChanged =
+        !_lastPreparedSymbolsValid ||
+        _lastPreparedStateRevision != currentStateRevision ||
+        _lastPreparedMapSymbolsUpdatesRevision != mapSymbolsUpdatesRevision ||
+        debugSettings->debugStageEnabled;
+
+    // In case neither state nor symbols have changed, last prepared symbols are still valid
+    if (!stateChanged &&
+        _lastPreparedPublishedMapSymbolsRevision == publishedMapSymbolsRevision &&
+        _lastPreparedWithSymbolsUpdateSuspended == symbolsUpdateSuspended)
+    {
+        if (metric)
+        {
+            metric->preparedSymbolsReused = 1;
+            metric->elapsedTimeForPreparingSymbols = stopwatch.elapsed();
+        }
+
+        return;
+    }
+
+    // Otherwise, in case state has not changed, renderables that were obtained from symbols still can be reused.
+    // If state has changed, it's likely to be changed again, so there's no point in keeping obtained renderables
+    if (stateChanged)
+        _obtainedRenderablesCache.clear();
+    _keepObtainedRenderables = !stateChanged;
+
+    IntersectionsIndex intersections;
     if (!obtainRenderableSymbols(renderableSymbols, intersections, metric))
     {
         // In case obtain failed due to lock, schedule another frame
@@ -59,6 +94,12 @@ void OsmAnd::AtlasMapRendererSymbolsStage::prepare(AtlasMapRenderer_Metrics::Met
         return;
     }
 
+    _lastPreparedSymbolsValid = true;
+    _lastPreparedStateRevision = currentStateRevision;
+    _lastPreparedPublishedMapSymbolsRevision = publishedMapSymbolsRevision;
+    _lastPreparedMapSymbolsUpdatesRevision = mapSymbolsUpdatesRevision;
+    _lastPreparedWithSymbolsUpdateSuspended = symbolsUpdateSuspended;
+
     Stopwatch preparedSymbolsPublishingStopwatch(metric != nullptr);
     {
         QWriteLocker scopedLocker(&_lastPreparedIntersectionsLock);
@@ -95,7 +136,7 @@ void OsmAnd::AtlasMapRendererSymbolsStage::queryLastPreparedSymbolsAt(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
     QList< std::shared_ptr<const RenderableSymbol> >& outRenderableSymbols,
-    IntersectionsQuadTree& outIntersections,
+    IntersectionsIndex& outIntersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     Stopwatch stopwatch(metric != nullptr);
@@ -139,7 +180,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
 bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
     const MapRenderer::PublishedMapSymbolsByOrder& mapSymbolsByOrder,
     QList< std::shared_ptr<const RenderableSymbol> >& outRenderableSymbols,
-    IntersectionsQuadTree& outIntersections,
+    IntersectionsIndex& outIntersections,
     MapRenderer::PublishedMapSymbolsByOrder* pOutAcceptedMapSymbolsByOrder,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
@@ -160,7 +201,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
         void discard(
             const AtlasMapRendererSymbolsStage* const stage,
             PlottedSymbols& plottedSymbols,
-            IntersectionsQuadTree& intersections)
+            IntersectionsIndex& intersections)
         {
             // Discard entire group
             for (auto& symbolRef : symbolsRefs)
@@ -180,7 +221,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
         void discardSpecific(
             const AtlasMapRendererSymbolsStage* const stage,
             PlottedSymbols& plottedSymbols,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             const std::function<bool(const std::shared_ptr<const RenderableSymbol>&)> acceptor)
         {
             auto itSymbolRef = mutableIteratorOf(symbolsRefs);
@@ -206,7 +247,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
         void discardAllOf(
             const AtlasMapRendererSymbolsStage* const stage,
             PlottedSymbols& plottedSymbols,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             const MapSymbol::ContentClass contentClass)
         {
             auto itSymbolRef = mutableIteratorOf(symbolsRefs);
@@ -233,7 +274,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
     {
         QHash< std::shared_ptr<const MapSymbolsGroup::AdditionalInstance>, PlottedSymbolsRefGroupInstance > instancesRefs;
 
-        void discard(const AtlasMapRendererSymbolsStage* const stage, PlottedSymbols& plottedSymbols, IntersectionsQuadTree& intersections)
+        void discard(const AtlasMapRendererSymbolsStage* const stage, PlottedSymbols& plottedSymbols, IntersectionsIndex& intersections)
         {
             // Discard all instances
             for (auto& instanceRef : instancesRefs)
@@ -246,12 +287,18 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
     // Iterate over map symbols layer sorted by "order" in ascending direction.
     // This means that map symbols with smaller order value are more important than map symbols with
     // larger order value.
+#if OSMAND_USE_QUAD_TREE_FOR_SYMBOLS_INTERSECTIONS
     // Tree depth should satisfy following condition:
     // (max(width, height) / 2^depth) >= 64
     const auto viewportMaxDimension = qMax(currentState.viewport.height(), currentState.viewport.width());
     const auto treeDepth = 32u - SkCLZ(viewportMaxDimension >> 6);
-    outIntersections = qMove(IntersectionsQuadTree(currentState.viewport, qMax(treeDepth, 1u)));
+    outIntersections = qMove(IntersectionsIndex(currentState.viewport, qMax(treeDepth, 1u)));
+#else
+    outIntersections = qMove(IntersectionsIndex(currentState.viewport, IntersectionsGridCellSize));
+#endif // OSMAND_USE_QUAD_TREE_FOR_SYMBOLS_INTERSECTIONS
     ComputedPathsDataCache computedPathsDataCache;
+    ObtainedRenderablesCache obtainedRenderables;
+    const auto pObtainedRenderables = _keepObtainedRenderables ? &obtainedRenderables : nullptr;
     for (const auto& mapSymbolsByOrderEntry : rangeOf(constOf(mapSymbolsByOrder)))
     {
         const auto order = mapSymbolsByOrderEntry.key();
@@ -310,12 +357,14 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
                     const auto& referencesOrigins = *citReferencesOrigins;
 
                     QList< std::shared_ptr<RenderableSymbol> > renderableSymbols;
-                    obtainRenderablesFromSymbol(
+                    obtainOrReuseRenderablesFromSymbol(
                         mapSymbolsGroup,
                         mapSymbol,
                         nullptr,
                         referencesOrigins,
                         computedPathsDataCache,
+                        _obtainedRenderablesCache,
+                        pObtainedRenderables,
                         renderableSymbols,
                         metric);
 
@@ -371,12 +420,14 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
                     const auto& additionalSymbolInstance = *citAdditionalSymbolInstance;
 
                     QList< std::shared_ptr<RenderableSymbol> > renderableSymbols;
-                    obtainRenderablesFromSymbol(
+                    obtainOrReuseRenderablesFromSymbol(
                         mapSymbolsGroup,
                         mapSymbol,
                         additionalSymbolInstance,
                         referencesOrigins,
                         computedPathsDataCache,
+                        _obtainedRenderablesCache,
+                        pObtainedRenderables,
                         renderableSymbols,
                         metric);
 
@@ -412,6 +463,10 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
         }
     }
 
+    _obtainedRenderablesCache = qMove(obtainedRenderables);
+    _spareComputedPathsData.append(computedPathsDataCache.values());
+    computedPathsDataCache.clear();
+
     if (Q_LIKELY(!debugSettings->skipSymbolsPresentationModeCheck))
     {
         Stopwatch symbolsPresentationModeCheckStopwatch(metric != nullptr);
@@ -674,9 +729,62 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromSymbol(
     }
 }
 
+void OsmAnd::AtlasMapRendererSymbolsStage::obtainOrReuseRenderablesFromSymbol(
+    const std::shared_ptr<const MapSymbolsGroup>& mapSymbolGroup,
+    const std::shared_ptr<const MapSymbol>& mapSymbol,
+    const std::shared_ptr<const MapSymbolsGroup::AdditionalSymbolInstanceParameters>& instanceParameters,
+    const MapRenderer::MapSymbolReferenceOrigins& referenceOrigins,
+    ComputedPathsDataCache& computedPathsDataCache,
+    const ObtainedRenderablesCache& reusableRenderables,
+    ObtainedRenderablesCache* const pOutObtainedRenderables,
+    QList< std::shared_ptr<RenderableSymbol> >& outRenderableSymbols,
+    AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
+{
+    const ObtainedRenderablesKey key(mapSymbol, instanceParameters);
+
+    // Renderables can be reused only if symbol is still referenced from same resources that still provide same
+    // GPU resource for it
+    const auto citReusable = reusableRenderables.constFind(key);
+    if (citReusable != reusableRenderables.cend())
+    {
+        const auto& reusable = *citReusable;
+
+        if (reusable.referenceOrigins == referenceOrigins &&
+            reusable.renderables.first()->gpuResource == captureGpuResource(referenceOrigins, mapSymbol))
+        {
+            outRenderableSymbols.append(reusable.renderables);
+            if (pOutObtainedRenderables)
+                pOutObtainedRenderables->insert(key, reusable);
+
+            if (metric)
+                metric->renderableSymbolsReused += reusable.renderables.size();
+
+            return;
+        }
+    }
+
+    obtainRenderablesFromSymbol(
+        mapSymbolGroup,
+        mapSymbol,
+        instanceParameters,
+        referenceOrigins,
+        computedPathsDataCache,
+        outRenderableSymbols,
+        metric);
+
+    // Symbol that yielded no renderables is not kept, since it may yield them once it gets GPU resource
+    if (pOutObtainedRenderables && !outRenderableSymbols.isEmpty())
+    {
+        ObtainedRenderables obtainedRenderables;
+        obtainedRenderables.referenceOrigins = referenceOrigins;
+        obtainedRenderables.renderables = outRenderableSymbols;
+        pOutObtainedRenderables->insert(key, qMove(obtainedRenderables));
+    }
+}
+
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotSymbol(
     const std::shared_ptr<RenderableSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     Stopwatch stopwatch(metric != nullptr);
@@ -780,7 +888,7 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromBillboardSymbol(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotBillboardSymbol(
     const std::shared_ptr<RenderableBillboardSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     bool plotted = false;
@@ -803,7 +911,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::plotBillboardSymbol(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotBillboardRasterSymbol(
     const std::shared_ptr<RenderableBillboardSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     const auto& internalState = getInternalState();
@@ -847,7 +955,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::plotBillboardRasterSymbol(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotBillboardVectorSymbol(
     const std::shared_ptr<RenderableBillboardSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     assert(false);
@@ -915,7 +1023,7 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromOnSurfaceSymbol(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotOnSurfaceSymbol(
     const std::shared_ptr<RenderableOnSurfaceSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     if (std::dynamic_pointer_cast<const RasterMapSymbol>(renderable->mapSymbol))
@@ -939,7 +1047,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::plotOnSurfaceSymbol(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotOnSurfaceRasterSymbol(
     const std::shared_ptr<RenderableOnSurfaceSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     const auto& internalState = getInternalState();
@@ -952,7 +1060,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::plotOnSurfaceRasterSymbol(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotOnSurfaceVectorSymbol(
     const std::shared_ptr<RenderableOnSurfaceSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     const auto& internalState = getInternalState();
@@ -1017,15 +1125,28 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromOnPathSymbol(
     {
         const auto& path31 = *onPathMapSymbol->shareablePath31;
 
+        // Storage of path data of previous frame is reused, so that whole path is converted and projected
+        // into already allocated buffers
         ComputedPathData computedPathData;
+        if (!_spareComputedPathsData.isEmpty())
+            computedPathData = _spareComputedPathsData.takeLast();
 
         //TODO: optimize by using lazy computation
-        computedPathData.pathInWorld = convertPoints31ToWorld(path31);
-        computedPathData.pathSegmentsLengthsInWorld = computePathSegmentsLengths(computedPathData.pathInWorld);
-        computedPathData.pathOnScreen = projectFromWorldToScreen(computedPathData.pathInWorld);
-        computedPathData.pathSegmentsLengthsOnScreen = computePathSegmentsLengths(computedPathData.pathOnScreen);
+        convertPoints31ToWorld(path31, computedPathData.pathInWorld);
+        if (onPathMapSymbol->hasPathSegmentsLengths31())
+        {
+            // Lengths in world are lengths in 31-coordinates scaled to current zoom, so no need to compute them again
+            scalePathSegmentsLengths(
+                *onPathMapSymbol->shareablePathSegmentsLengths31,
+                static_cast<float>(AtlasMapRenderer::TileSize3D) / (1u << (ZoomLevel::MaxZoomLevel - currentState.zoomBase)),
+                computedPathData.pathSegmentsLengthsInWorld);
+        }
+        else
+            computePathSegmentsLengths(computedPathData.pathInWorld, computedPathData.pathSegmentsLengthsInWorld);
+        projectFromWorldToScreen(computedPathData.pathInWorld, computedPathData.pathOnScreen);
+        computePathSegmentsLengths(computedPathData.pathOnScreen, computedPathData.pathSegmentsLengthsOnScreen);
 
-        itComputedPathData = computedPathsDataCache.insert(onPathMapSymbol->shareablePath31, computedPathData);
+        itComputedPathData = computedPathsDataCache.insert(onPathMapSymbol->shareablePath31, qMove(computedPathData));
     }
     const auto& computedPathData = *itComputedPathData;
      
@@ -1271,7 +1392,7 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromOnPathSymbol(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotOnPathSymbol(
     const std::shared_ptr<RenderableOnPathSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     const auto& internalState = getInternalState();
@@ -1375,8 +1496,8 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::plotOnPathSymbol(
 }
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::applyVisibilityFiltering(
-    const IntersectionsQuadTree::BBox& visibleBBox,
-    const IntersectionsQuadTree& intersections,
+    const IntersectionsIndex::BBox& visibleBBox,
+    const IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     Stopwatch stopwatch(metric != nullptr);
@@ -1401,7 +1522,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyVisibilityFiltering(
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::applyIntersectionWithOtherSymbolsFiltering(
     const std::shared_ptr<const RenderableSymbol>& renderable,
-    const IntersectionsQuadTree& intersections,
+    const IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     if (Q_UNLIKELY(debugSettings->skipSymbolsIntersectionCheck))
@@ -1425,8 +1546,8 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyIntersectionWithOtherSymbolsFilt
         ? renderable->genericInstanceParameters->groupInstancePtr
         : nullptr;
     const auto intersects = intersections.test(renderable->intersectionBBox, false,
-        [symbolGroupPtr, symbolIntersectsWithClasses, symbolIntersectsWithAnyClass, anyIntersectionClass, symbolGroupInstancePtr, checkIntersectionsWithinGroup]
-        (const std::shared_ptr<const RenderableSymbol>& otherRenderable, const IntersectionsQuadTree::BBox& otherBBox) -> bool
+        [symbolGroupPtr, &symbolIntersectsWithClasses, symbolIntersectsWithAnyClass, anyIntersectionClass, symbolGroupInstancePtr, checkIntersectionsWithinGroup]
+        (const std::shared_ptr<const RenderableSymbol>& otherRenderable, const IntersectionsIndex::BBox& otherBBox) -> bool
         {
             const auto& otherSymbol = otherRenderable->mapSymbol;
 
@@ -1448,10 +1569,13 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyIntersectionWithOtherSymbolsFilt
             if (otherSymbol->intersectsWithClasses.contains(anyIntersectionClass))
                 return true;
 
-            // General case:
-            const auto commonIntersectionClasses = symbolIntersectsWithClasses & otherSymbol->intersectsWithClasses;
-            const auto hasCommonIntersectionClasses = !commonIntersectionClasses.isEmpty();
-            return hasCommonIntersectionClasses;
+            // General case (without building intersection of sets, since only presence of common class matters):
+            for (const auto& intersectionClass : constOf(symbolIntersectsWithClasses))
+            {
+                if (otherSymbol->intersectsWithClasses.contains(intersectionClass))
+                    return true;
+            }
+            return false;
         });
 
     if (metric)
@@ -1475,7 +1599,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyIntersectionWithOtherSymbolsFilt
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::applyMinDistanceToSameContentFromOtherSymbolFiltering(
     const std::shared_ptr<const RenderableSymbol>& renderable,
-    const IntersectionsQuadTree& intersections,
+    const IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     if (Q_UNLIKELY(debugSettings->skipSymbolsMinDistanceToSameContentFromOtherSymbolCheck))
@@ -1495,10 +1619,10 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyMinDistanceToSameContentFromOthe
         : nullptr;
     const auto& symbolContent = symbol->content;
     const auto hasSimilarContent = intersections.test(renderable->intersectionBBox.getEnlargedBy(symbol->minDistance), false,
-        [symbolContent, symbolGroupPtr, symbolGroupInstancePtr]
-        (const std::shared_ptr<const RenderableSymbol>& otherRenderable, const IntersectionsQuadTree::BBox& otherBBox) -> bool
+        [&symbolContent, symbolGroupPtr, symbolGroupInstancePtr]
+        (const std::shared_ptr<const RenderableSymbol>& otherRenderable, const IntersectionsIndex::BBox& otherBBox) -> bool
         {
-            const auto otherSymbol = std::dynamic_pointer_cast<const RasterMapSymbol>(otherRenderable->mapSymbol);
+            const auto otherSymbol = dynamic_cast<const RasterMapSymbol*>(otherRenderable->mapSymbol.get());
             if (!otherSymbol)
                 return false;
 
@@ -1541,7 +1665,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyMinDistanceToSameContentFromOthe
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::addToIntersections(
     const std::shared_ptr<const RenderableSymbol>& renderable,
-    IntersectionsQuadTree& intersections,
+    IntersectionsIndex& intersections,
     AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const
 {
     if (Q_UNLIKELY(debugSettings->allSymbolsTransparentForIntersectionLookup))
@@ -1602,35 +1726,68 @@ QVector<glm::vec2> OsmAnd::AtlasMapRendererSymbolsStage::convertPoints31ToWorld(
     return result;
 }
 
-QVector<glm::vec2> OsmAnd::AtlasMapRendererSymbolsStage::projectFromWorldToScreen(
-    const QVector<glm::vec2>& pointsInWorld) const
+void OsmAnd::AtlasMapRendererSymbolsStage::convertPoints31ToWorld(
+    const QVector<PointI>& points31,
+    QVector<glm::vec2>& outPointsInWorld) const
 {
-    return projectFromWorldToScreen(pointsInWorld, 0, pointsInWorld.size() - 1);
+    // Resizing keeps already allocated storage, so vectors of previous frame are reused as-is
+    const auto count = points31.size();
+    outPointsInWorld.resize(count);
+    auto pPointInWorld = outPointsInWorld.data();
+    auto pPoint31 = points31.constData();
+
+    for (auto idx = 0; idx < count; idx++)
+    {
+        *(pPointInWorld++) =
+            Utilities::convert31toFloat(*(pPoint31++) - currentState.target31, currentState.zoomBase) *
+            static_cast<float>(AtlasMapRenderer::TileSize3D);
+    }
 }
 
-QVector<glm::vec2> OsmAnd::AtlasMapRendererSymbolsStage::projectFromWorldToScreen(
+void OsmAnd::AtlasMapRendererSymbolsStage::projectFromWorldToScreen(
     const QVector<glm::vec2>& pointsInWorld,
-    const unsigned int startIndex,
-    const unsigned int endIndex) const
+    QVector<glm::vec2>& outPointsOnScreen) const
 {
-    const auto& internalState = getInternalState();
+    outPointsOnScreen.resize(pointsInWorld.size());
+    projectFromWorldToScreen(pointsInWorld.constData(), pointsInWorld.size(), outPointsOnScreen.data());
+}
 
-    assert(endIndex >= startIndex);
-    const auto count = endIndex - startIndex + 1;
-    QVector<glm::vec2> result(count);
-    auto pPointOnScreen = result.data();
-    auto pPointInWorld = pointsInWorld.constData() + startIndex;
+void OsmAnd::AtlasMapRendererSymbolsStage::projectFromWorldToScreen(
+    const glm::vec2* const __restrict pointsInWorld,
+    const unsigned int count,
+    glm::vec2* const __restrict outPointsOnScreen) const
+{
+    const auto& internalState = getInternalState();
+    const auto& mPerspectiveProjectionView = internalState.mPerspectiveProjectionView;
+    const auto& viewport = internalState.glmViewport;
+
+    // Points in world lay on ground plane (y = 0), so only 1st, 3rd and 4th columns of matrix and only x, y and w
+    // components of projected point are needed. This is same as glm_extensions::fastProject(), but without
+    // unused computations and with invariants hoisted out of the loop. Iterations have no dependencies on
+    // each other and input never aliases output, so compiler is free to vectorize the loop for target architecture
+    const auto m00 = mPerspectiveProjectionView[0][0];
+    const auto m01 = mPerspectiveProjectionView[0][1];
+    const auto m03 = mPerspectiveProjectionView[0][3];
+    const auto m20 = mPerspectiveProjectionView[2][0];
+    const auto m21 = mPerspectiveProjectionView[2][1];
+    const auto m23 = mPerspectiveProjectionView[2][3];
+    const auto m30 = mPerspectiveProjectionView[3][0];
+    const auto m31 = mPerspectiveProjectionView[3][1];
+    const auto m33 = mPerspectiveProjectionView[3][3];
+    const auto halfViewportWidth = viewport[2] * 0.5f;
+    const auto halfViewportHeight = viewport[3] * 0.5f;
+    const auto viewportCenterX = viewport[0] + halfViewportWidth;
+    const auto viewportCenterY = viewport[1] + halfViewportHeight;
 
     for (auto idx = 0u; idx < count; idx++)
     {
-        *(pPointOnScreen++) = glm_extensions::fastProject(
-            glm::vec3(pPointInWorld->x, 0.0f, pPointInWorld->y),
-            internalState.mPerspectiveProjectionView,
-            internalState.glmViewport).xy;
-        pPointInWorld++;
-    }
+        const auto x = pointsInWorld[idx].x;
+        const auto z = pointsInWorld[idx].y;
 
-    return result;
+        const auto invW = 1.0f / (m03 * x + m23 * z + m33);
+        outPointsOnScreen[idx].x = (m00 * x + m20 * z + m30) * invW * halfViewportWidth + viewportCenterX;
+        outPointsOnScreen[idx].y = (m01 * x + m21 * z + m31) * invW * halfViewportHeight + viewportCenterY;
+    }
 }
 
 std::shared_ptr<const OsmAnd::GPUAPI::ResourceInGPU> OsmAnd::AtlasMapRendererSymbolsStage::captureGpuResource(
@@ -1657,18 +1814,32 @@ std::shared_ptr<const OsmAnd::GPUAPI::ResourceInGPU> OsmAnd::AtlasMapRendererSym
     return nullptr;
 }
 
-QVector<float> OsmAnd::AtlasMapRendererSymbolsStage::computePathSegmentsLengths(const QVector<glm::vec2>& path)
+void OsmAnd::AtlasMapRendererSymbolsStage::computePathSegmentsLengths(
+    const QVector<glm::vec2>& path,
+    QVector<float>& outLengths)
 {
     const auto segmentsCount = path.size() - 1;
-    QVector<float> lengths(segmentsCount);
+    outLengths.resize(segmentsCount);
 
     auto pPathPoint = path.constData();
     auto pPrevPathPoint = pPathPoint++;
-    auto pLength = lengths.data();
+    auto pLength = outLengths.data();
     for (auto segmentIdx = 0; segmentIdx < segmentsCount; segmentIdx++)
         *(pLength++) = glm::distance(*(pPathPoint++), *(pPrevPathPoint++));
+}
 
-    return lengths;
+void OsmAnd::AtlasMapRendererSymbolsStage::scalePathSegmentsLengths(
+    const QVector<float>& pathSegmentsLengths,
+    const float scale,
+    QVector<float>& outLengths)
+{
+    const auto segmentsCount = pathSegmentsLengths.size();
+    outLengths.resize(segmentsCount);
+
+    auto pSourceLength = pathSegmentsLengths.constData();
+    auto pLength = outLengths.data();
+    for (auto segmentIdx = 0; segmentIdx < segmentsCount; segmentIdx++)
+        *(pLength++) = *(pSourceLength++) * scale;
 }
 
 bool OsmAnd::AtlasMapRendererSymbolsStage::computePointIndexAndOffsetFromOriginAndOffset(
@@ -2278,11 +2449,11 @@ void OsmAnd::AtlasMapRendererSymbolsStage::addIntersectionDebugBox(
 }
 
 void OsmAnd::AtlasMapRendererSymbolsStage::addIntersectionDebugBox(
-    const IntersectionsQuadTree::BBox intersectionBBox,
+    const IntersectionsIndex::BBox intersectionBBox,
     const ColorARGB color,
     const bool drawBorder /*= true*/) const
 {
-    if (intersectionBBox.type == IntersectionsQuadTree::BBoxType::AABB)
+    if (intersectionBBox.type == IntersectionsIndex::BBoxType::AABB)
     {
         const auto& boundsInWindow = intersectionBBox.asAABB;
 
@@ -2298,7 +2469,7 @@ void OsmAnd::AtlasMapRendererSymbolsStage::addIntersectionDebugBox(
             }, color.withAlpha(255).argb);
         }
     }
-    else /* if (intersectionBBox.type == IntersectionsQuadTree::BBoxType::OOBB) */
+    else /* if (intersectionBBox.type == IntersectionsIndex::BBoxType::OOBB) */
     {
         const auto& oobb = intersectionBBox.asOOBB;
 
@@ -15,9 +15,16 @@
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
 #include "QuadTree.h"
+#include "UniformGrid.h"
 #include "AtlasMapRendererStage.h"
 #include "GPUAPI.h"
 
+// Screen-space bboxes of symbols are small and of similar size, so uniform grid is used to index them by default
+//#define OSMAND_USE_QUAD_TREE_FOR_SYMBOLS_INTERSECTIONS 1
+#ifndef OSMAND_USE_QUAD_TREE_FOR_SYMBOLS_INTERSECTIONS
+#   define OSMAND_USE_QUAD_TREE_FOR_SYMBOLS_INTERSECTIONS 0
+#endif // !defined(OSMAND_USE_QUAD_TREE_FOR_SYMBOLS_INTERSECTIONS)
+
 namespace OsmAnd
 {
     class MapSymbol;
@@ -30,7 +37,11 @@ namespace OsmAnd
     {
     public:
         struct RenderableSymbol;
-        typedef QuadTree< std::shared_ptr<const RenderableSymbol>, AreaI::CoordType > IntersectionsQuadTree;
+#if OSMAND_USE_QUAD_TREE_FOR_SYMBOLS_INTERSECTIONS
+        typedef QuadTree< std::shared_ptr<const RenderableSymbol>, AreaI::CoordType > IntersectionsIndex;
+#else
+        typedef UniformGrid< std::shared_ptr<const RenderableSymbol>, AreaI::CoordType > IntersectionsIndex;
+#endif // OSMAND_USE_QUAD_TREE_FOR_SYMBOLS_INTERSECTIONS
 
         struct RenderableSymbol
         {
@@ -42,7 +53,7 @@ namespace OsmAnd
 
             std::shared_ptr<const GPUAPI::ResourceInGPU> gpuResource;
             double distanceToCamera;
-            IntersectionsQuadTree::BBox intersectionBBox;
+            IntersectionsIndex::BBox intersectionBBox;
         };
 
         struct RenderableBillboardSymbol : RenderableSymbol
@@ -107,20 +118,46 @@ namespace OsmAnd
             QVector< GlyphPlacement > glyphsPlacement;
         };
     private:
+        enum {
+            // Size of cell of intersections grid, in pixels
+            IntersectionsGridCellSize = 64,
+        };
+
         bool obtainRenderableSymbols(
             QList< std::shared_ptr<const RenderableSymbol> >& outRenderableSymbols,
-            IntersectionsQuadTree& outIntersections,
+            IntersectionsIndex& outIntersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool obtainRenderableSymbols(
             const MapRenderer::PublishedMapSymbolsByOrder& mapSymbolsByOrder,
             QList< std::shared_ptr<const RenderableSymbol> >& outRenderableSymbols,
-            IntersectionsQuadTree& outIntersections,
+            IntersectionsIndex& outIntersections,
             MapRenderer::PublishedMapSymbolsByOrder* pOutAcceptedMapSymbolsByOrder,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         mutable MapRenderer::PublishedMapSymbolsByOrder _lastAcceptedMapSymbolsByOrder;
 
         mutable QReadWriteLock _lastPreparedIntersectionsLock;
-        IntersectionsQuadTree _lastPreparedIntersections;
+        IntersectionsIndex _lastPreparedIntersections;
+
+        // Prepared symbols are reused as-is while nothing they were prepared from has changed
+        bool _lastPreparedSymbolsValid;
+        unsigned int _lastPreparedStateRevision;
+        unsigned int _lastPreparedPublishedMapSymbolsRevision;
+        unsigned int _lastPreparedMapSymbolsUpdatesRevision;
+        bool _lastPreparedWithSymbolsUpdateSuspended;
+
+        // Renderables obtained from symbols are reused while state remains the same, so that only symbols that
+        // were published since last prepare have to be obtained
+        struct ObtainedRenderables
+        {
+            MapRenderer::MapSymbolReferenceOrigins referenceOrigins;
+            QList< std::shared_ptr<RenderableSymbol> > renderables;
+        };
+        typedef QPair<
+            std::shared_ptr<const MapSymbol>,
+            std::shared_ptr<const MapSymbolsGroup::AdditionalSymbolInstanceParameters> > ObtainedRenderablesKey;
+        typedef QHash< ObtainedRenderablesKey, ObtainedRenderables > ObtainedRenderablesCache;
+        mutable ObtainedRenderablesCache _obtainedRenderablesCache;
+        bool _keepObtainedRenderables;
 
         // Path calculations cache
         struct ComputedPathData
@@ -131,6 +168,8 @@ namespace OsmAnd
             QVector<float> pathSegmentsLengthsOnScreen;
         };
         typedef QHash< std::shared_ptr< const QVector<PointI> >, ComputedPathData > ComputedPathsDataCache;
+        // Path data of previous frame, which storage is reused to avoid allocations on each frame
+        mutable QList<ComputedPathData> _spareComputedPathsData;
 
         void obtainRenderablesFromSymbol(
             const std::shared_ptr<const MapSymbolsGroup>& mapSymbolGroup,
@@ -141,9 +180,20 @@ namespace OsmAnd
             QList< std::shared_ptr<RenderableSymbol> >& outRenderableSymbols,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
 
+        void obtainOrReuseRenderablesFromSymbol(
+            const std::shared_ptr<const MapSymbolsGroup>& mapSymbolGroup,
+            const std::shared_ptr<const MapSymbol>& mapSymbol,
+            const std::shared_ptr<const MapSymbolsGroup::AdditionalSymbolInstanceParameters>& instanceParameters,
+            const MapRenderer::MapSymbolReferenceOrigins& referenceOrigins,
+            ComputedPathsDataCache& computedPathsDataCache,
+            const ObtainedRenderablesCache& reusableRenderables,
+            ObtainedRenderablesCache* const pOutObtainedRenderables,
+            QList< std::shared_ptr<RenderableSymbol> >& outRenderableSymbols,
+            AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
+
         bool plotSymbol(
             const std::shared_ptr<RenderableSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
 
         // Billboard symbols:
@@ -156,15 +206,15 @@ namespace OsmAnd
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool plotBillboardSymbol(
             const std::shared_ptr<RenderableBillboardSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool plotBillboardRasterSymbol(
             const std::shared_ptr<RenderableBillboardSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool plotBillboardVectorSymbol(
             const std::shared_ptr<RenderableBillboardSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
 
         // On-surface symbols:
@@ -177,15 +227,15 @@ namespace OsmAnd
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool plotOnSurfaceSymbol(
             const std::shared_ptr<RenderableOnSurfaceSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool plotOnSurfaceRasterSymbol(
             const std::shared_ptr<RenderableOnSurfaceSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool plotOnSurfaceVectorSymbol(
             const std::shared_ptr<RenderableOnSurfaceSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
 
         // On-path symbols:
@@ -199,25 +249,25 @@ namespace OsmAnd
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool plotOnPathSymbol(
             const std::shared_ptr<RenderableOnPathSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
 
         // Intersection-related:
         bool applyVisibilityFiltering(
-            const IntersectionsQuadTree::BBox& visibleBBox,
-            const IntersectionsQuadTree& intersections,
+            const IntersectionsIndex::BBox& visibleBBox,
+            const IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool applyIntersectionWithOtherSymbolsFiltering(
             const std::shared_ptr<const RenderableSymbol>& renderable,
-            const IntersectionsQuadTree& intersections,
+            const IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool applyMinDistanceToSameContentFromOtherSymbolFiltering(
             const std::shared_ptr<const RenderableSymbol>& renderable,
-            const IntersectionsQuadTree& intersections,
+            const IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         bool addToIntersections(
             const std::shared_ptr<const RenderableSymbol>& renderable,
-            IntersectionsQuadTree& intersections,
+            IntersectionsIndex& intersections,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
 
         // Utilities:
@@ -227,19 +277,27 @@ namespace OsmAnd
             const QVector<PointI>& points31,
             const unsigned int startIndex,
             const unsigned int endIndex) const;
+        void convertPoints31ToWorld(
+            const QVector<PointI>& points31,
+            QVector<glm::vec2>& outPointsInWorld) const;
 
-        QVector<glm::vec2> projectFromWorldToScreen(
-            const QVector<glm::vec2>& pointsInWorld) const;
-        QVector<glm::vec2> projectFromWorldToScreen(
+        void projectFromWorldToScreen(
             const QVector<glm::vec2>& pointsInWorld,
-            const unsigned int startIndex,
-            const unsigned int endIndex) const;
+            QVector<glm::vec2>& outPointsOnScreen) const;
+        void projectFromWorldToScreen(
+            const glm::vec2* const __restrict pointsInWorld,
+            const unsigned int count,
+            glm::vec2* const __restrict outPointsOnScreen) const;
 
         static std::shared_ptr<const GPUAPI::ResourceInGPU> captureGpuResource(
             const MapRenderer::MapSymbolReferenceOrigins& resources,
             const std::shared_ptr<const MapSymbol>& mapSymbol);
 
-        static QVector<float> computePathSegmentsLengths(const QVector<glm::vec2>& path);
+        static void computePathSegmentsLengths(const QVector<glm::vec2>& path, QVector<float>& outLengths);
+        static void scalePathSegmentsLengths(
+            const QVector<float>& pathSegmentsLengths,
+            const float scale,
+            QVector<float>& outLengths);
 
         static bool computePointIndexAndOffsetFromOriginAndOffset(
             const QVector<float>& pathSegmentsLengths,
@@ -307,7 +365,7 @@ namespace OsmAnd
             const bool drawBorder = true) const;
 
         void addIntersectionDebugBox(
-            const IntersectionsQuadTree::BBox intersectionBBox,
+            const IntersectionsIndex::BBox intersectionBBox,
             const ColorARGB color,
             const bool drawBorder = true) const;
     protected:
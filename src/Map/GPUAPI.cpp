@@ -35,6 +35,8 @@ bool OsmAnd::GPUAPI::release()
 
 std::shared_ptr<OsmAnd::GPUAPI::AtlasTexturesPool> OsmAnd::GPUAPI::obtainAtlasTexturesPool(const AtlasTypeId& atlasTypeId)
 {
+    QMutexLocker scopedLocker(&_atlasTexturesPoolsMutex);
+
     auto itPool = _atlasTexturesPools.constFind(atlasTypeId);
     if (itPool == _atlasTexturesPools.cend())
     {
@@ -50,6 +52,42 @@ std::shared_ptr<OsmAnd::GPUAPI::SlotOnAtlasTextureInGPU> OsmAnd::GPUAPI::allocat
     return pool->allocateTile(atlasTextureAllocator);
 }
 
+QHash< OsmAnd::GPUAPI::AtlasTypeId, OsmAnd::GPUAPI::AtlasTexturesPool::Statistics > OsmAnd::GPUAPI::getAtlasTexturesPoolsStatistics(
+    const float sparseOccupancy /*= 0.25f*/) const
+{
+    QHash< AtlasTypeId, AtlasTexturesPool::Statistics > statistics;
+
+    QMutexLocker scopedLocker(&_atlasTexturesPoolsMutex);
+    for (const auto& pool : constOf(_atlasTexturesPools))
+        statistics.insert(pool->typeId, pool->getStatistics(sparseOccupancy));
+
+    return statistics;
+}
+
+unsigned int OsmAnd::GPUAPI::compactAtlasTextures(
+    const unsigned int maxSlotsToMigrate,
+    const float sparseOccupancy /*= 0.25f*/)
+{
+    QList< std::shared_ptr<AtlasTexturesPool> > pools;
+    {
+        QMutexLocker scopedLocker(&_atlasTexturesPoolsMutex);
+        pools = _atlasTexturesPools.values();
+    }
+
+    unsigned int migratedSlotsCount = 0;
+    for (const auto& pool : constOf(pools))
+    {
+        if (maxSlotsToMigrate > 0 && migratedSlotsCount >= maxSlotsToMigrate)
+            break;
+
+        migratedSlotsCount += pool->compact(
+            sparseOccupancy,
+            maxSlotsToMigrate > 0 ? maxSlotsToMigrate - migratedSlotsCount : 0);
+    }
+
+    return migratedSlotsCount;
+}
+
 OsmAnd::GPUAPI::ResourceInGPU::ResourceInGPU(const Type type_, GPUAPI* api_, const RefInGPU& refInGPU_)
     : _refInGPU(refInGPU_)
     , api(api_)
@@ -142,12 +180,7 @@ OsmAnd::GPUAPI::AtlasTextureInGPU::AtlasTextureInGPU(GPUAPI* api_, const RefInGP
 
 OsmAnd::GPUAPI::AtlasTextureInGPU::~AtlasTextureInGPU()
 {
-    const int tilesRemaining =
-#if OSMAND_DEBUG
-        _tiles.size();
-#else
-        _tilesCounter.load();
-#endif
+    const int tilesRemaining = _tiles.size();
     if (tilesRemaining > 0)
         LogPrintf(LogSeverityLevel::Error, "By the time of atlas texture destruction, it still contained %d allocated slots", tilesRemaining);
     assert(tilesRemaining == 0);
@@ -167,21 +200,31 @@ OsmAnd::GPUAPI::AtlasTextureInGPU::~AtlasTextureInGPU()
             pool->_lastNonFullAtlasTextureWeak.reset();
         }
     }
+    {
+        QMutexLocker scopedLocker(&pool->_atlasTexturesMutex);
+
+        pool->_atlasTextures.remove(this);
+    }
+}
+
+unsigned int OsmAnd::GPUAPI::AtlasTextureInGPU::getUsedSlotsCount() const
+{
+    QMutexLocker scopedLocker(&_tilesMutex);
+
+    return _tiles.size();
 }
 
 OsmAnd::GPUAPI::SlotOnAtlasTextureInGPU::SlotOnAtlasTextureInGPU(const std::shared_ptr<AtlasTextureInGPU>& atlas_, const unsigned int slotIndex_)
     : ResourceInGPU(Type::SlotOnAtlasTexture, atlas_->api, atlas_->refInGPU)
-    , atlasTexture(atlas_)
-    , slotIndex(slotIndex_)
+    , _atlasTexture(atlas_)
+    , _slotIndex(slotIndex_)
+    , atlasTexture(_atlasTexture)
+    , slotIndex(_slotIndex)
 {
     // Add reference of this tile to atlas texture
     {
-#if OSMAND_DEBUG
         QMutexLocker scopedLocker(&atlasTexture->_tilesMutex);
         atlasTexture->_tiles.insert(this);
-#else
-        atlasTexture->_tilesCounter.ref();
-#endif
     }
 }
 
@@ -189,12 +232,8 @@ OsmAnd::GPUAPI::SlotOnAtlasTextureInGPU::~SlotOnAtlasTextureInGPU()
 {
     // Remove reference of this tile to atlas texture
     {
-#if OSMAND_DEBUG
         QMutexLocker scopedLocker(&atlasTexture->_tilesMutex);
         atlasTexture->_tiles.remove(this);
-#else
-        atlasTexture->_tilesCounter.deref();
-#endif
     }
 
     // Publish slot that was occupied by this tile as freed
@@ -208,9 +247,28 @@ OsmAnd::GPUAPI::SlotOnAtlasTextureInGPU::~SlotOnAtlasTextureInGPU()
     _refInGPU = nullptr;
 }
 
+void OsmAnd::GPUAPI::SlotOnAtlasTextureInGPU::relocate(const std::shared_ptr<AtlasTextureInGPU>& atlas, const uint32_t slotIndex_)
+{
+    {
+        QMutexLocker scopedLocker(&_atlasTexture->_tilesMutex);
+        _atlasTexture->_tiles.remove(this);
+    }
+    {
+        QMutexLocker scopedLocker(&atlas->_tilesMutex);
+        atlas->_tiles.insert(this);
+    }
+
+    _atlasTexture = atlas;
+    _slotIndex = slotIndex_;
+    _refInGPU = _atlasTexture->refInGPU;
+}
+
 OsmAnd::GPUAPI::AtlasTexturesPool::AtlasTexturesPool(GPUAPI* api_, const AtlasTypeId& typeId_)
     : _lastNonFullAtlasTexture(nullptr)
     , _firstUnusedSlotIndex(0)
+    , _migratedSlotsCount(0)
+    , _releasedAtlasTexturesCount(0)
+    , _isCompactionDisabled(false)
     , api(api_)
     , typeId(typeId_)
 {
@@ -254,6 +312,12 @@ std::shared_ptr<OsmAnd::GPUAPI::SlotOnAtlasTextureInGPU> OsmAnd::GPUAPI::AtlasTe
             _lastNonFullAtlasTexture = atlasTexture.get();
             _lastNonFullAtlasTextureWeak = atlasTexture;
             _firstUnusedSlotIndex = 0;
+
+            {
+                QMutexLocker scopedLocker(&_atlasTexturesMutex);
+
+                _atlasTextures.insert(atlasTexture.get(), atlasTexture);
+            }
         }
         else
         {
@@ -265,6 +329,258 @@ std::shared_ptr<OsmAnd::GPUAPI::SlotOnAtlasTextureInGPU> OsmAnd::GPUAPI::AtlasTe
     }
 }
 
+QList< std::shared_ptr<OsmAnd::GPUAPI::AtlasTextureInGPU> > OsmAnd::GPUAPI::AtlasTexturesPool::getAtlasTextures() const
+{
+    QList< std::shared_ptr<AtlasTextureInGPU> > atlasTextures;
+
+    QMutexLocker scopedLocker(&_atlasTexturesMutex);
+    for (const auto& atlasTextureWeak : constOf(_atlasTextures))
+    {
+        if (const auto atlasTexture = atlasTextureWeak.lock())
+            atlasTextures.push_back(atlasTexture);
+    }
+
+    return atlasTextures;
+}
+
+bool OsmAnd::GPUAPI::AtlasTexturesPool::obtainSlotForMigration(
+    const AtlasTextureInGPU* const sourceAtlasTexture,
+    std::shared_ptr<AtlasTextureInGPU>& outAtlasTexture,
+    uint32_t& outSlotIndex)
+{
+    // Prefer freed slot on the most occupied atlas texture, so that sparse atlas textures get even more sparse
+    {
+        QMutexLocker scopedLocker(&_freedSlotsMutex);
+
+        while (!_freedSlots.isEmpty())
+        {
+            auto itBestFreedSlotEntry = _freedSlots.end();
+            unsigned int bestUsedSlotsCount = 0;
+            for (auto itFreedSlotEntry = _freedSlots.begin(); itFreedSlotEntry != _freedSlots.end(); ++itFreedSlotEntry)
+            {
+                if (itFreedSlotEntry.key() == sourceAtlasTexture)
+                    continue;
+
+                const auto usedSlotsCount = itFreedSlotEntry.key()->getUsedSlotsCount();
+                if (itBestFreedSlotEntry == _freedSlots.end() || usedSlotsCount > bestUsedSlotsCount)
+                {
+                    itBestFreedSlotEntry = itFreedSlotEntry;
+                    bestUsedSlotsCount = usedSlotsCount;
+                }
+            }
+            if (itBestFreedSlotEntry == _freedSlots.end())
+                break;
+
+            // Mark slot as occupied
+            const auto freedSlotEntry = itBestFreedSlotEntry.value();
+            _freedSlots.erase(itBestFreedSlotEntry);
+
+            outAtlasTexture = std::get<0>(freedSlotEntry).lock();
+            outSlotIndex = std::get<1>(freedSlotEntry);
+            if (outAtlasTexture)
+                return true;
+        }
+    }
+
+    // Otherwise use unused slot of atlas texture that is being filled
+    {
+        QMutexLocker scopedLocker(&_unusedSlotsMutex);
+
+        if (!_lastNonFullAtlasTexture || _lastNonFullAtlasTexture == sourceAtlasTexture)
+            return false;
+        if (_firstUnusedSlotIndex == _lastNonFullAtlasTexture->slotsPerSide*_lastNonFullAtlasTexture->slotsPerSide)
+            return false;
+
+        outAtlasTexture = _lastNonFullAtlasTextureWeak.lock();
+        if (!outAtlasTexture)
+            return false;
+        outSlotIndex = _firstUnusedSlotIndex++;
+        return true;
+    }
+}
+
+unsigned int OsmAnd::GPUAPI::AtlasTexturesPool::compact(const float sparseOccupancy, const unsigned int maxSlotsToMigrate)
+{
+    if (_isCompactionDisabled)
+        return 0;
+
+    std::shared_ptr<AtlasTextureInGPU> sparseAtlasTexture;
+    unsigned int sparseAtlasTextureUsedSlotsCount = 0;
+    unsigned int unusedSlotsCount = 0;
+    {
+        const auto atlasTextures = getAtlasTextures();
+        if (atlasTextures.size() < 2)
+            return 0;
+
+        // Atlas texture that is being filled is never compacted
+        const AtlasTextureInGPU* lastNonFullAtlasTexture = nullptr;
+        {
+            QMutexLocker scopedLocker(&_unusedSlotsMutex);
+
+            lastNonFullAtlasTexture = _lastNonFullAtlasTexture;
+            if (_lastNonFullAtlasTexture)
+            {
+                unusedSlotsCount =
+                    _lastNonFullAtlasTexture->slotsPerSide*_lastNonFullAtlasTexture->slotsPerSide - _firstUnusedSlotIndex;
+            }
+        }
+
+        // Find the most sparse atlas texture
+        for (const auto& atlasTexture : constOf(atlasTextures))
+        {
+            if (atlasTexture.get() == lastNonFullAtlasTexture)
+                continue;
+
+            const auto slotsCount = atlasTexture->slotsPerSide*atlasTexture->slotsPerSide;
+            const auto usedSlotsCount = atlasTexture->getUsedSlotsCount();
+            if (usedSlotsCount > sparseOccupancy * slotsCount)
+                continue;
+
+            if (!sparseAtlasTexture || usedSlotsCount < sparseAtlasTextureUsedSlotsCount)
+            {
+                sparseAtlasTexture = atlasTexture;
+                sparseAtlasTextureUsedSlotsCount = usedSlotsCount;
+            }
+        }
+    }
+    if (!sparseAtlasTexture)
+        return 0;
+
+    // Migrate only if all live slots fit into other atlas textures, since otherwise sparse atlas texture can not be
+    // released anyway. Also, stop allocating new slots on sparse atlas texture
+    QList<FreedSlotsEntry> sparseAtlasTextureFreedSlots;
+    {
+        QMutexLocker scopedLocker(&_freedSlotsMutex);
+
+        const auto otherFreedSlotsCount = _freedSlots.size() - _freedSlots.count(sparseAtlasTexture.get());
+        if (otherFreedSlotsCount + unusedSlotsCount < sparseAtlasTextureUsedSlotsCount)
+            return 0;
+
+        sparseAtlasTextureFreedSlots = _freedSlots.values(sparseAtlasTexture.get());
+        _freedSlots.remove(sparseAtlasTexture.get());
+    }
+
+    // Slots can be destroyed only by thread that uploads resources, and compaction is called from same thread,
+    // so it's safe to operate on pointers
+    QList<SlotOnAtlasTextureInGPU*> slots;
+    {
+        QMutexLocker scopedLocker(&sparseAtlasTexture->_tilesMutex);
+
+        slots = sparseAtlasTexture->_tiles.toList();
+    }
+
+    // Mipmaps of each target atlas texture are regenerated once, after all slots were copied into it
+    unsigned int migratedSlotsCount = 0;
+    QList< std::shared_ptr<AtlasTextureInGPU> > targetAtlasTextures;
+    for (const auto slot : constOf(slots))
+    {
+        if (maxSlotsToMigrate > 0 && migratedSlotsCount >= maxSlotsToMigrate)
+            break;
+
+        std::shared_ptr<AtlasTextureInGPU> targetAtlasTexture;
+        uint32_t targetSlotIndex = 0;
+        if (!obtainSlotForMigration(sparseAtlasTexture.get(), targetAtlasTexture, targetSlotIndex))
+            break;
+
+        const auto sourceSlotIndex = slot->slotIndex;
+        if (!api->copyAtlasTextureSlot(sparseAtlasTexture, sourceSlotIndex, targetAtlasTexture, targetSlotIndex))
+        {
+            LogPrintf(LogSeverityLevel::Warning,
+                "Failed to copy slot between atlas textures, compaction of atlas textures pool %p is disabled",
+                this);
+            _isCompactionDisabled = true;
+
+            QMutexLocker scopedLocker(&_freedSlotsMutex);
+            _freedSlots.insert(targetAtlasTexture.get(), qMove(FreedSlotsEntry(targetAtlasTexture, targetSlotIndex)));
+            break;
+        }
+
+        if (!targetAtlasTextures.contains(targetAtlasTexture))
+            targetAtlasTextures.push_back(targetAtlasTexture);
+        slot->relocate(targetAtlasTexture, targetSlotIndex);
+        sparseAtlasTextureFreedSlots.push_back(qMove(FreedSlotsEntry(sparseAtlasTexture, sourceSlotIndex)));
+        migratedSlotsCount++;
+    }
+    for (const auto& targetAtlasTexture : constOf(targetAtlasTextures))
+        api->updateAtlasTextureMipmaps(targetAtlasTexture);
+    targetAtlasTextures.clear();
+
+    // If sparse atlas texture still has live slots, publish its free slots back
+    const std::weak_ptr<AtlasTextureInGPU> sparseAtlasTextureWeak(sparseAtlasTexture);
+    if (sparseAtlasTexture->getUsedSlotsCount() > 0)
+    {
+        QMutexLocker scopedLocker(&_freedSlotsMutex);
+
+        for (const auto& freedSlotEntry : constOf(sparseAtlasTextureFreedSlots))
+            _freedSlots.insert(sparseAtlasTexture.get(), freedSlotEntry);
+    }
+    sparseAtlasTextureFreedSlots.clear();
+
+    // Release sparse atlas texture if this was the last reference to it
+    sparseAtlasTexture.reset();
+    {
+        QMutexLocker scopedLocker(&_atlasTexturesMutex);
+
+        _migratedSlotsCount += migratedSlotsCount;
+        if (sparseAtlasTextureWeak.expired())
+            _releasedAtlasTexturesCount++;
+    }
+
+    return migratedSlotsCount;
+}
+
+OsmAnd::GPUAPI::AtlasTexturesPool::Statistics OsmAnd::GPUAPI::AtlasTexturesPool::getStatistics(const float sparseOccupancy) const
+{
+    Statistics statistics;
+
+    // Atlas texture removes itself from the list on destruction, so while lock is held it's safe to use pointers
+    {
+        QMutexLocker scopedLocker(&_atlasTexturesMutex);
+
+        const auto atlasTextures = _atlasTextures.keys();
+        for (const auto atlasTexture : constOf(atlasTextures))
+        {
+            const auto slotsCount = atlasTexture->slotsPerSide*atlasTexture->slotsPerSide;
+            const auto usedSlotsCount = atlasTexture->getUsedSlotsCount();
+
+            statistics.atlasTexturesCount++;
+            statistics.slotsCount += slotsCount;
+            statistics.usedSlotsCount += usedSlotsCount;
+            if (usedSlotsCount <= sparseOccupancy * slotsCount)
+                statistics.sparseAtlasTexturesCount++;
+        }
+
+        statistics.migratedSlotsCount = _migratedSlotsCount;
+        statistics.releasedAtlasTexturesCount = _releasedAtlasTexturesCount;
+    }
+    {
+        QMutexLocker scopedLocker(&_freedSlotsMutex);
+
+        statistics.freedSlotsCount = _freedSlots.size();
+    }
+
+    return statistics;
+}
+
+OsmAnd::GPUAPI::AtlasTexturesPool::Statistics::Statistics()
+    : atlasTexturesCount(0)
+    , slotsCount(0)
+    , usedSlotsCount(0)
+    , freedSlotsCount(0)
+    , sparseAtlasTexturesCount(0)
+    , migratedSlotsCount(0)
+    , releasedAtlasTexturesCount(0)
+{
+}
+
+float OsmAnd::GPUAPI::AtlasTexturesPool::Statistics::getOccupancy() const
+{
+    if (slotsCount == 0)
+        return 0.0f;
+
+    return static_cast<float>(usedSlotsCount) / static_cast<float>(slotsCount);
+}
+
 OsmAnd::GPUAPI::MeshInGPU::MeshInGPU(
     GPUAPI* api_,
     const std::shared_ptr<ArrayBufferInGPU>& vertexBuffer_,
@@ -168,6 +168,21 @@ namespace OsmAnd
         public:
             typedef std::function< AtlasTextureInGPU*() > AtlasTextureAllocatorSignature;
             typedef std::tuple< std::weak_ptr<AtlasTextureInGPU>, unsigned int > FreedSlotsEntry;
+
+            struct Statistics
+            {
+                Statistics();
+
+                unsigned int atlasTexturesCount;
+                unsigned int slotsCount;
+                unsigned int usedSlotsCount;
+                unsigned int freedSlotsCount;
+                unsigned int sparseAtlasTexturesCount;
+                unsigned int migratedSlotsCount;
+                unsigned int releasedAtlasTexturesCount;
+
+                float getOccupancy() const;
+            };
         private:
             mutable QMutex _freedSlotsMutex;
             QMultiHash< AtlasTextureInGPU*, FreedSlotsEntry> _freedSlots;
@@ -176,16 +191,34 @@ namespace OsmAnd
             AtlasTextureInGPU* _lastNonFullAtlasTexture;
             std::weak_ptr<AtlasTextureInGPU> _lastNonFullAtlasTextureWeak;
             uint32_t _firstUnusedSlotIndex;
+
+            mutable QMutex _atlasTexturesMutex;
+            QHash< AtlasTextureInGPU*, std::weak_ptr<AtlasTextureInGPU> > _atlasTextures;
+            unsigned int _migratedSlotsCount;
+            unsigned int _releasedAtlasTexturesCount;
+            volatile bool _isCompactionDisabled;
+
+            QList< std::shared_ptr<AtlasTextureInGPU> > getAtlasTextures() const;
+            bool obtainSlotForMigration(
+                const AtlasTextureInGPU* const sourceAtlasTexture,
+                std::shared_ptr<AtlasTextureInGPU>& outAtlasTexture,
+                uint32_t& outSlotIndex);
         protected:
             AtlasTexturesPool(GPUAPI* api, const AtlasTypeId& typeId);
 
             std::shared_ptr<SlotOnAtlasTextureInGPU> allocateTile(AtlasTextureAllocatorSignature atlasTextureAllocator);
+
+            // Moves live slots out of the most sparsely used atlas texture into free slots of other atlas textures,
+            // so that sparse atlas texture gets released once empty. Returns number of migrated slots
+            unsigned int compact(const float sparseOccupancy, const unsigned int maxSlotsToMigrate);
         public:
             virtual ~AtlasTexturesPool();
 
             GPUAPI* const api;
             const AtlasTypeId typeId;
 
+            Statistics getStatistics(const float sparseOccupancy) const;
+
         friend OsmAnd::GPUAPI;
         };
 
@@ -194,12 +227,9 @@ namespace OsmAnd
             Q_DISABLE_COPY_AND_MOVE(AtlasTextureInGPU);
         private:
         protected:
-#if OSMAND_DEBUG
+            // Slots are tracked (not only counted) to allow migrating them during compaction
             mutable QMutex _tilesMutex;
             QSet< SlotOnAtlasTextureInGPU* > _tiles;
-#else
-            QAtomicInt _tilesCounter;
-#endif
         public:
             AtlasTextureInGPU(GPUAPI* api, const RefInGPU& refInGPU, const unsigned int textureSize, const unsigned int mipmapLevels, const std::shared_ptr<AtlasTexturesPool>& pool);
             virtual ~AtlasTextureInGPU();
@@ -212,20 +242,30 @@ namespace OsmAnd
 
             const std::shared_ptr<AtlasTexturesPool> pool;
 
+            unsigned int getUsedSlotsCount() const;
+
         friend OsmAnd::GPUAPI::SlotOnAtlasTextureInGPU;
+        friend OsmAnd::GPUAPI::AtlasTexturesPool;
         };
 
         class SlotOnAtlasTextureInGPU : public ResourceInGPU
         {
             Q_DISABLE_COPY_AND_MOVE(SlotOnAtlasTextureInGPU);
         private:
+            std::shared_ptr<AtlasTextureInGPU> _atlasTexture;
+            uint32_t _slotIndex;
+
+            // Changes location of this slot. Content has to be copied to new location beforehand
+            void relocate(const std::shared_ptr<AtlasTextureInGPU>& atlas, const uint32_t slotIndex);
         protected:
         public:
             SlotOnAtlasTextureInGPU(const std::shared_ptr<AtlasTextureInGPU>& atlas, const uint32_t slotIndex);
             virtual ~SlotOnAtlasTextureInGPU();
 
-            const std::shared_ptr<AtlasTextureInGPU> atlasTexture;
-            const uint32_t slotIndex;
+            const std::shared_ptr<AtlasTextureInGPU>& atlasTexture;
+            const uint32_t& slotIndex;
+
+        friend OsmAnd::GPUAPI::AtlasTexturesPool;
         };
 
         class MeshInGPU : public MetaResourceInGPU
@@ -252,6 +292,7 @@ namespace OsmAnd
         QAtomicInt _allocatedResourcesCounter;
 #endif
 
+        mutable QMutex _atlasTexturesPoolsMutex;
         QHash< AtlasTypeId, std::shared_ptr<AtlasTexturesPool> > _atlasTexturesPools;
     protected:
         GPUAPI();
@@ -260,6 +301,13 @@ namespace OsmAnd
         std::shared_ptr<SlotOnAtlasTextureInGPU> allocateTile(const std::shared_ptr<AtlasTexturesPool>& pool, AtlasTexturesPool::AtlasTextureAllocatorSignature atlasTextureAllocator );
 
         virtual bool releaseResourceInGPU(const ResourceInGPU::Type type, const RefInGPU& refInGPU) = 0;
+        virtual bool copyAtlasTextureSlot(
+            const std::shared_ptr<const AtlasTextureInGPU>& sourceAtlasTexture,
+            const uint32_t sourceSlotIndex,
+            const std::shared_ptr<const AtlasTextureInGPU>& targetAtlasTexture,
+            const uint32_t targetSlotIndex) = 0;
+        // Regenerates mipmaps of atlas texture after slots were copied into it
+        virtual void updateAtlasTextureMipmaps(const std::shared_ptr<const AtlasTextureInGPU>& atlasTexture) = 0;
 
         bool _isSupported_8bitPaletteRGBA8;
     public:
@@ -275,6 +323,16 @@ namespace OsmAnd
 
         virtual void waitUntilUploadIsComplete() = 0;
 
+        // Atlas textures that have not more than given fraction of slots used are considered sparse
+        QHash< AtlasTypeId, AtlasTexturesPool::Statistics > getAtlasTexturesPoolsStatistics(
+            const float sparseOccupancy = 0.25f) const;
+
+        // Should be called from thread that uploads resources, since content of slots is copied between atlas
+        // textures and slots change their location. Returns number of migrated slots
+        unsigned int compactAtlasTextures(
+            const unsigned int maxSlotsToMigrate,
+            const float sparseOccupancy = 0.25f);
+
     friend OsmAnd::GPUAPI::ResourceInGPU;
     };
 }
@@ -4,6 +4,8 @@
 #include "QtCommon.h"
 
 #include "IMapRenderer.h"
+#include "AtlasMapRenderer.h"
+#include "MapRendererConfiguration.h"
 #include "Utilities.h"
 
 OsmAnd::MapAnimator_P::MapAnimator_P( MapAnimator* const owner_ )
@@ -281,6 +283,131 @@ void OsmAnd::MapAnimator_P::update(const float timePassed)
         if (animations.isEmpty())
             itAnimations.remove();
     }
+
+    updatePredictedStates();
+}
+
+void OsmAnd::MapAnimator_P::updatePredictedStates()
+{
+    QList<MapRendererState> predictedStates;
+    if (!_animationsByKey.isEmpty())
+    {
+        auto timeLeft = 0.0f;
+        for (const auto& animations : constOf(_animationsByKey))
+        {
+            for (const auto& animation : constOf(animations))
+            {
+                if (animation->isPaused())
+                    continue;
+                timeLeft = qMax(timeLeft, animation->delay + animation->duration - animation->getTimePassed());
+            }
+        }
+
+        if (timeLeft > 0.0f)
+        {
+            const auto currentState = _renderer->getState();
+            for (auto predictedStateIndex = 1; predictedStateIndex <= PredictedStatesCount; predictedStateIndex++)
+            {
+                const auto timeOffset = (timeLeft * predictedStateIndex) / PredictedStatesCount;
+
+                auto predictedState = currentState;
+                predictedState.azimuth = predictValue(AnimatedValue::Azimuth, timeOffset, currentState.azimuth);
+                predictedState.elevationAngle = predictValue(AnimatedValue::ElevationAngle, timeOffset, currentState.elevationAngle);
+                predictedState.target31 = Utilities::normalizeCoordinates(
+                    predictValue(AnimatedValue::Target, timeOffset, PointI64(currentState.target31)),
+                    ZoomLevel31);
+                predictedState.requestedZoom = qBound(
+                    _renderer->getMinZoom(),
+                    predictValue(AnimatedValue::Zoom, timeOffset, currentState.requestedZoom),
+                    _renderer->getMaxZoom());
+                predictedState.zoomBase = static_cast<ZoomLevel>(qRound(predictedState.requestedZoom));
+                predictedState.zoomFraction = predictedState.requestedZoom - predictedState.zoomBase;
+
+                predictedStates.push_back(qMove(predictedState));
+            }
+        }
+    }
+
+    // Renderer is notified only when predicted states need other tiles than previously predicted ones. If renderer
+    // can not tell which tiles are visible, it's notified whenever prediction changes
+    if (const auto atlasRenderer = std::dynamic_pointer_cast<const AtlasMapRenderer>(_renderer))
+    {
+        QMap< ZoomLevel, QSet<TileId> > predictedTiles;
+        if (!predictedStates.isEmpty())
+        {
+            const auto configuration = atlasRenderer->getConfiguration();
+            for (const auto& predictedState : constOf(predictedStates))
+            {
+                QSet<TileId> tiles;
+                if (!atlasRenderer->obtainVisibleTiles(predictedState, *configuration, tiles))
+                    continue;
+                predictedTiles[predictedState.zoomBase].unite(tiles);
+            }
+        }
+
+        if (predictedTiles == _predictedTiles && predictedStates.isEmpty() == _predictedStates.isEmpty())
+            return;
+        _predictedTiles = predictedTiles;
+    }
+    else if (isSamePrediction(predictedStates, _predictedStates))
+        return;
+    _predictedStates = predictedStates;
+    _renderer->setPredictedStates(predictedStates);
+}
+
+bool OsmAnd::MapAnimator_P::isSamePrediction(const QList<MapRendererState>& l, const QList<MapRendererState>& r)
+{
+    if (l.size() != r.size())
+        return false;
+
+    for (auto index = 0; index < l.size(); index++)
+    {
+        const auto& lState = l[index];
+        const auto& rState = r[index];
+
+        if (lState.target31 != rState.target31 ||
+            lState.zoomBase != rState.zoomBase ||
+            !qFuzzyCompare(lState.requestedZoom, rState.requestedZoom) ||
+            !qFuzzyCompare(lState.azimuth, rState.azimuth) ||
+            !qFuzzyCompare(lState.elevationAngle, rState.elevationAngle))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool OsmAnd::MapAnimator_P::obtainInitialValue(const GenericAnimation& animation, float& outValue)
+{
+    return animation.obtainInitialValueAsFloat(outValue);
+}
+
+bool OsmAnd::MapAnimator_P::obtainInitialValue(const GenericAnimation& animation, PointI64& outValue)
+{
+    return animation.obtainInitialValueAsPointI64(outValue);
+}
+
+bool OsmAnd::MapAnimator_P::obtainDeltaValue(const GenericAnimation& animation, float& outValue)
+{
+    return animation.obtainDeltaValueAsFloat(outValue);
+}
+
+bool OsmAnd::MapAnimator_P::obtainDeltaValue(const GenericAnimation& animation, PointI64& outValue)
+{
+    return animation.obtainDeltaValueAsPointI64(outValue);
+}
+
+float OsmAnd::MapAnimator_P::interpolateValue(const float initialValue, const float deltaValue, const float progress)
+{
+    return initialValue + deltaValue * progress;
+}
+
+OsmAnd::PointI64 OsmAnd::MapAnimator_P::interpolateValue(const PointI64& initialValue, const PointI64& deltaValue, const float progress)
+{
+    return PointI64(
+        initialValue.x + static_cast<int64_t>(deltaValue.x * static_cast<double>(progress)),
+        initialValue.y + static_cast<int64_t>(deltaValue.y * static_cast<double>(progress)));
 }
 
 void OsmAnd::MapAnimator_P::animateZoomBy(
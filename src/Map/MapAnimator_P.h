@@ -10,15 +10,18 @@
 #include <QHash>
 #include <QMap>
 #include <QList>
+#include <QSet>
 #include <QReadWriteLock>
 #include <QMutex>
 #include <QVariant>
 #include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
+#include "Common.h"
 #include "PrivateImplementation.h"
 #include "MapAnimator.h"
 #include "MapCommonTypes.h"
+#include "MapRendererState.h"
 
 namespace OsmAnd
 {
@@ -587,6 +590,53 @@ namespace OsmAnd
         void targetSetter(const PointI64 newValue, AnimationContext& context, const std::shared_ptr<AnimationContext>& sharedContext);
 
         static std::shared_ptr<GenericAnimation> findCurrentAnimation(const AnimatedValue animatedValue, const AnimationsCollection& collection);
+
+        // Renderer is asked to prefetch resources for states at evenly spaced moments till all animations finish.
+        // Timing functions are not taken into account, since only covered tiles matter.
+        enum {
+            PredictedStatesCount = 3,
+        };
+        QList<MapRendererState> _predictedStates;
+        QMap< ZoomLevel, QSet<TileId> > _predictedTiles;
+        void updatePredictedStates();
+        static bool isSamePrediction(const QList<MapRendererState>& l, const QList<MapRendererState>& r);
+
+        static bool obtainInitialValue(const GenericAnimation& animation, float& outValue);
+        static bool obtainInitialValue(const GenericAnimation& animation, PointI64& outValue);
+        static bool obtainDeltaValue(const GenericAnimation& animation, float& outValue);
+        static bool obtainDeltaValue(const GenericAnimation& animation, PointI64& outValue);
+        static float interpolateValue(const float initialValue, const float deltaValue, const float progress);
+        static PointI64 interpolateValue(const PointI64& initialValue, const PointI64& deltaValue, const float progress);
+        template<typename T>
+        T predictValue(const AnimatedValue animatedValue, const float timeOffset, const T currentValue) const
+        {
+            // Animations that have not started yet continue from value predicted so far
+            auto value = currentValue;
+            for (const auto& animations : constOf(_animationsByKey))
+            {
+                for (const auto& animation : constOf(animations))
+                {
+                    if (animation->animatedValue != animatedValue || animation->isPaused())
+                        continue;
+
+                    const auto animationTime = animation->getTimePassed() + timeOffset - animation->delay;
+                    if (animationTime <= 0.0f)
+                        continue;
+
+                    // Delta of some animations is known only after they start
+                    T deltaValue;
+                    if (!obtainDeltaValue(*animation, deltaValue))
+                        continue;
+                    T initialValue = value;
+                    obtainInitialValue(*animation, initialValue);
+
+                    const auto progress = qMin(animationTime / animation->duration, 1.0f);
+                    value = interpolateValue(initialValue, deltaValue, progress);
+                }
+            }
+
+            return value;
+        }
     public:
         ~MapAnimator_P();
 
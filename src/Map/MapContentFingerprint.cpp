@@ -0,0 +1,212 @@
+#include "MapContentFingerprint.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QStringList>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include "restore_internal_warnings.h"
+
+#include "IObfsCollection.h"
+#include "ObfFile.h"
+#include "MapPresentationEnvironment.h"
+#include "UnresolvedMapStyle.h"
+#include "MapStyleValueDefinition.h"
+#include "QKeyValueIterator.h"
+#include "Utilities.h"
+
+namespace OsmAnd
+{
+    // Hash iteration order differs between processes, so everything is fed in order of sorted keys
+    static void addToHash(QCryptographicHash& hash, const QString& value)
+    {
+        hash.addData(value.toUtf8());
+        hash.addData("\n", 1);
+    }
+
+    static void addToHash(QCryptographicHash& hash, const QHash<QString, QString>& values)
+    {
+        auto keys = values.keys();
+        keys.sort();
+        for (const auto& key : constOf(keys))
+            addToHash(hash, key + QLatin1Char('=') + values[key]);
+    }
+
+    static void addToHash(QCryptographicHash& hash, const std::shared_ptr<const UnresolvedMapStyle::RuleNode>& ruleNode)
+    {
+        if (!ruleNode)
+        {
+            addToHash(hash, QLatin1String("null"));
+            return;
+        }
+
+        addToHash(hash, ruleNode->isSwitch ? QLatin1String("switch") : QLatin1String("case"));
+        addToHash(hash, ruleNode->values);
+        addToHash(hash, QString(QLatin1String("oneOf:%1")).arg(ruleNode->oneOfConditionalSubnodes.size()));
+        for (const auto& subnode : constOf(ruleNode->oneOfConditionalSubnodes))
+            addToHash(hash, subnode);
+        addToHash(hash, QString(QLatin1String("apply:%1")).arg(ruleNode->applySubnodes.size()));
+        for (const auto& subnode : constOf(ruleNode->applySubnodes))
+            addToHash(hash, subnode);
+    }
+}
+
+OsmAnd::MapContentFingerprint::MapContentFingerprint()
+{
+}
+
+OsmAnd::MapContentFingerprint::~MapContentFingerprint()
+{
+}
+
+QByteArray OsmAnd::MapContentFingerprint::computeStyleFingerprint(
+    const std::shared_ptr<const MapPresentationEnvironment>& environment)
+{
+    // Style is identified by its content rather than by name, since style file may be edited
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const auto& unresolvedMapStyle : constOf(environment->resolvedStyle->unresolvedMapStylesChain))
+    {
+        addToHash(hash, QLatin1String("style:") + unresolvedMapStyle->name);
+        addToHash(hash, QLatin1String("parent:") + unresolvedMapStyle->parentName);
+        addToHash(hash, unresolvedMapStyle->constants);
+
+        for (const auto& parameter : constOf(unresolvedMapStyle->parameters))
+        {
+            addToHash(hash, QString(QLatin1String("parameter:%1:%2:%3"))
+                .arg(parameter->name)
+                .arg(static_cast<int>(parameter->dataType))
+                .arg(parameter->possibleValues.join(QLatin1Char(','))));
+        }
+
+        for (const auto& attribute : constOf(unresolvedMapStyle->attributes))
+        {
+            addToHash(hash, QLatin1String("attribute:") + attribute->name);
+            addToHash(hash, attribute->rootNode);
+        }
+
+        for (auto rulesetTypeIdx = 0u; rulesetTypeIdx < unresolvedMapStyle->rulesets.size(); rulesetTypeIdx++)
+        {
+            const auto& ruleset = unresolvedMapStyle->rulesets[rulesetTypeIdx];
+
+            auto tags = ruleset.keys();
+            tags.sort();
+            for (const auto& tag : constOf(tags))
+            {
+                const auto& rulesByValue = ruleset[tag];
+
+                auto values = rulesByValue.keys();
+                values.sort();
+                for (const auto& value : constOf(values))
+                {
+                    addToHash(hash, QString(QLatin1String("rule:%1:%2=%3")).arg(rulesetTypeIdx).arg(tag).arg(value));
+                    addToHash(hash, rulesByValue[value]->rootNode);
+                }
+            }
+        }
+    }
+
+    return hash.result();
+}
+
+QString OsmAnd::MapContentFingerprint::computeFingerprint(
+    const QByteArray& styleFingerprint,
+    const std::shared_ptr<const MapPresentationEnvironment>& environment,
+    const QHash< ResolvedMapStyle::ValueDefinitionId, MapStyleConstantValue >& settings,
+    const QList< std::shared_ptr<const ObfFile> >& obfFiles,
+    const QString& providerParameters)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(styleFingerprint);
+
+    QStringList settingsParts;
+    for (const auto& setting : rangeOf(constOf(settings)))
+    {
+        const auto& valueDefinition = environment->resolvedStyle->getValueDefinitionById(setting.key());
+        if (!valueDefinition)
+            continue;
+        settingsParts.append(QLatin1String("setting:") + valueDefinition->name +
+            QLatin1Char('=') + setting.value().toString(valueDefinition->dataType));
+    }
+    settingsParts.sort();
+    for (const auto& settingPart : constOf(settingsParts))
+        addToHash(hash, settingPart);
+
+    addToHash(hash, QString(QLatin1String("env:%1:%2:%3"))
+        .arg(environment->displayDensityFactor)
+        .arg(environment->localeLanguageId)
+        .arg(static_cast<int>(environment->languagePreference)));
+    addToHash(hash, providerParameters);
+
+    // OBF info is not touched here, since it's guarded by lock of OBF reader. Modification time of file is checked,
+    // since OBF may be replaced by one of same size
+    QStringList obfsParts;
+    for (const auto& obfFile : constOf(obfFiles))
+    {
+        obfsParts.append(QString(QLatin1String("obf:%1:%2:%3"))
+            .arg(obfFile->filePath)
+            .arg(obfFile->fileSize)
+            .arg(QFileInfo(obfFile->filePath).lastModified().toMSecsSinceEpoch()));
+    }
+    obfsParts.sort();
+    for (const auto& obfsPart : constOf(obfsParts))
+        addToHash(hash, obfsPart);
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString OsmAnd::MapContentFingerprint::getFingerprint(
+    const std::shared_ptr<const MapPresentationEnvironment>& environment,
+    const std::shared_ptr<const IObfsCollection>& obfsCollection,
+    const QString& providerParameters) const
+{
+    // Both are implicitly shared, so unchanged collection and settings are detected without deep comparison
+    const auto obfFiles = obfsCollection
+        ? obfsCollection->getObfFiles()
+        : QList< std::shared_ptr<const ObfFile> >();
+    const auto settings = environment->getSettings();
+
+    QMutexLocker scopedLocker(&_mutex);
+
+    bool changed = false;
+    if (_environment != environment)
+    {
+        _environment = environment;
+        _styleFingerprint = computeStyleFingerprint(environment);
+        changed = true;
+    }
+    if (!_settings.isSharedWith(settings))
+    {
+        _settings = settings;
+        changed = true;
+    }
+    if (_obfFiles != obfFiles)
+    {
+        _obfFiles = obfFiles;
+        changed = true;
+    }
+    if (_providerParameters != providerParameters)
+    {
+        _providerParameters = providerParameters;
+        changed = true;
+    }
+
+    if (changed || _fingerprint.isEmpty())
+        _fingerprint = computeFingerprint(_styleFingerprint, _environment, _settings, _obfFiles, _providerParameters);
+
+    return _fingerprint;
+}
+
+QString OsmAnd::MapContentFingerprint::getTileKey(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    const std::shared_ptr<const MapPresentationEnvironment>& environment,
+    const std::shared_ptr<const IObfsCollection>& obfsCollection,
+    const QString& providerParameters) const
+{
+    return QString(QLatin1String("%1/%2/%3/%4"))
+        .arg(getFingerprint(environment, obfsCollection, providerParameters))
+        .arg(zoom)
+        .arg(tileId.x)
+        .arg(tileId.y);
+}
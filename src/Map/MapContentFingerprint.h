@@ -0,0 +1,67 @@
+#ifndef _OSMAND_CORE_MAP_CONTENT_FINGERPRINT_H_
+#define _OSMAND_CORE_MAP_CONTENT_FINGERPRINT_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QString>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "ResolvedMapStyle.h"
+#include "MapStyleConstantValue.h"
+
+namespace OsmAnd
+{
+    class ObfFile;
+    class IObfsCollection;
+    class MapPresentationEnvironment;
+
+    // Identifies content that map tiles are produced from: OBF files, resolved style content, its settings and
+    // presentation settings. Fingerprint is recomputed only when set of OBF files, style settings or provider
+    // parameters change, so it's cheap enough to be queried for each tile
+    class MapContentFingerprint Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapContentFingerprint);
+
+    private:
+        mutable QMutex _mutex;
+        mutable std::shared_ptr<const MapPresentationEnvironment> _environment;
+        mutable QByteArray _styleFingerprint;
+        mutable QHash< ResolvedMapStyle::ValueDefinitionId, MapStyleConstantValue > _settings;
+        mutable QList< std::shared_ptr<const ObfFile> > _obfFiles;
+        mutable QString _providerParameters;
+        mutable QString _fingerprint;
+
+        static QByteArray computeStyleFingerprint(const std::shared_ptr<const MapPresentationEnvironment>& environment);
+        static QString computeFingerprint(
+            const QByteArray& styleFingerprint,
+            const std::shared_ptr<const MapPresentationEnvironment>& environment,
+            const QHash< ResolvedMapStyle::ValueDefinitionId, MapStyleConstantValue >& settings,
+            const QList< std::shared_ptr<const ObfFile> >& obfFiles,
+            const QString& providerParameters);
+    protected:
+    public:
+        MapContentFingerprint();
+        ~MapContentFingerprint();
+
+        // OBF collection may be null if map objects are not provided from OBF files
+        QString getFingerprint(
+            const std::shared_ptr<const MapPresentationEnvironment>& environment,
+            const std::shared_ptr<const IObfsCollection>& obfsCollection,
+            const QString& providerParameters) const;
+        QString getTileKey(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            const std::shared_ptr<const MapPresentationEnvironment>& environment,
+            const std::shared_ptr<const IObfsCollection>& obfsCollection,
+            const QString& providerParameters) const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_CONTENT_FINGERPRINT_H_)
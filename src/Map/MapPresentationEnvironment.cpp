@@ -64,6 +64,16 @@ bool OsmAnd::MapPresentationEnvironment::obtainIconShield(const QString& name, s
     return _p->obtainIconShield(name, outIconShield);
 }
 
+bool OsmAnd::MapPresentationEnvironment::obtainCachedPaint(const QByteArray& key, std::shared_ptr<const SkPaint>& outPaint) const
+{
+    return _p->obtainCachedPaint(key, outPaint);
+}
+
+void OsmAnd::MapPresentationEnvironment::cachePaint(const QByteArray& key, const std::shared_ptr<const SkPaint>& paint) const
+{
+    _p->cachePaint(key, paint);
+}
+
 OsmAnd::ColorARGB OsmAnd::MapPresentationEnvironment::getDefaultBackgroundColor(const ZoomLevel zoom) const
 {
     return _p->getDefaultBackgroundColor(zoom);
@@ -270,6 +270,27 @@ QByteArray OsmAnd::MapPresentationEnvironment_P::obtainResourceByName(const QStr
     return resource;
 }
 
+bool OsmAnd::MapPresentationEnvironment_P::obtainCachedPaint(const QByteArray& key, std::shared_ptr<const SkPaint>& outPaint) const
+{
+    QReadLocker scopedLocker(&_paintsCacheLock);
+
+    const auto citPaint = _paintsCache.constFind(key);
+    if (citPaint == _paintsCache.cend())
+        return false;
+
+    outPaint = *citPaint;
+    return true;
+}
+
+void OsmAnd::MapPresentationEnvironment_P::cachePaint(const QByteArray& key, const std::shared_ptr<const SkPaint>& paint) const
+{
+    QWriteLocker scopedLocker(&_paintsCacheLock);
+
+    if (_paintsCache.size() >= MaxCachedPaintsCount)
+        _paintsCache.clear();
+    _paintsCache.insert(key, paint);
+}
+
 OsmAnd::ColorARGB OsmAnd::MapPresentationEnvironment_P::getDefaultBackgroundColor(const ZoomLevel zoom) const
 {
     auto result = _defaultBackgroundColor;
@@ -8,6 +8,7 @@
 #include <QMap>
 #include <QHash>
 #include <QMutex>
+#include <QReadWriteLock>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -84,6 +85,13 @@ namespace OsmAnd
         mutable QMutex _iconShieldsMutex;
         mutable QHash< QString, std::shared_ptr<const SkBitmap> > _iconShields;
 
+        enum {
+            // Cache of paints is dropped entirely once it grows above this size
+            MaxCachedPaintsCount = 8192,
+        };
+        mutable QReadWriteLock _paintsCacheLock;
+        mutable QHash< QByteArray, std::shared_ptr<const SkPaint> > _paintsCache;
+
         QByteArray obtainResourceByName(const QString& name) const;
     public:
         virtual ~MapPresentationEnvironment_P();
@@ -101,6 +109,9 @@ namespace OsmAnd
         bool obtainTextShield(const QString& name, std::shared_ptr<const SkBitmap>& outTextShield) const;
         bool obtainIconShield(const QString& name, std::shared_ptr<const SkBitmap>& outTextShield) const;
 
+        bool obtainCachedPaint(const QByteArray& key, std::shared_ptr<const SkPaint>& outPaint) const;
+        void cachePaint(const QByteArray& key, const std::shared_ptr<const SkPaint>& paint) const;
+
         ColorARGB getDefaultBackgroundColor(const ZoomLevel zoom) const;
         void obtainShadowOptions(const ZoomLevel zoom, ShadowMode& mode, ColorARGB& color) const;
         double getPolygonAreaMinimalThreshold(const ZoomLevel zoom) const;
@@ -0,0 +1,853 @@
+#include "MapPrimitivesCodec.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QtEndian>
+#include <QVariant>
+#include "restore_internal_warnings.h"
+
+#include "QKeyValueIterator.h"
+#include "MapPresentationEnvironment.h"
+#include "ResolvedMapStyle.h"
+#include "MapStyleValueDefinition.h"
+#include "MapStyleEvaluationResult.h"
+#include "Logging.h"
+
+namespace OsmAnd
+{
+    // "OSPR" signature followed by format version and flags
+    static const quint32 MapPrimitivesCodecSignature = 0x4F535052u;
+    static const quint8 MapPrimitivesCodecFlagCompressed = 0x1u;
+
+    enum class MapPrimitivesCodecValueType : quint8
+    {
+        Boolean = 0,
+        Integer = 1,
+        UnsignedInteger = 2,
+        Float = 3,
+        String = 4,
+    };
+
+    enum class MapPrimitivesCodecSymbolType : quint8
+    {
+        Text = 1,
+        Icon = 2,
+    };
+
+    static void writeUInt32(QByteArray& buffer, const quint32 value)
+    {
+        const auto littleEndianValue = qToLittleEndian(value);
+        buffer.append(reinterpret_cast<const char*>(&littleEndianValue), sizeof(littleEndianValue));
+    }
+
+    static void writeVarUInt(QByteArray& buffer, uint64_t value)
+    {
+        while (value >= 0x80u)
+        {
+            buffer.append(static_cast<char>((value & 0x7Fu) | 0x80u));
+            value >>= 7;
+        }
+        buffer.append(static_cast<char>(value));
+    }
+
+    // Signed values are zig-zag encoded, so that small negative deltas are short as well
+    static void writeVarInt(QByteArray& buffer, const int64_t value)
+    {
+        writeVarUInt(buffer, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    static void writeFloat(QByteArray& buffer, const float value)
+    {
+        quint32 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        writeUInt32(buffer, bits);
+    }
+
+    static void writeDouble(QByteArray& buffer, const double value)
+    {
+        quint64 bits;
+        memcpy(&bits, &value, sizeof(bits));
+        const auto littleEndianBits = qToLittleEndian(bits);
+        buffer.append(reinterpret_cast<const char*>(&littleEndianBits), sizeof(littleEndianBits));
+    }
+
+    static void writeString(QByteArray& buffer, const QString& value)
+    {
+        const auto utf8 = value.toUtf8();
+        writeVarUInt(buffer, utf8.size());
+        buffer.append(utf8);
+    }
+
+    static void writePoints(QByteArray& buffer, const QVector<PointI>& points31, const PointI& origin31)
+    {
+        writeVarUInt(buffer, points31.size());
+        auto previousPoint31 = origin31;
+        for (const auto& point31 : constOf(points31))
+        {
+            writeVarInt(buffer, static_cast<int64_t>(point31.x) - previousPoint31.x);
+            writeVarInt(buffer, static_cast<int64_t>(point31.y) - previousPoint31.y);
+            previousPoint31 = point31;
+        }
+    }
+
+    static void writeGeometry(
+        QByteArray& buffer,
+        const QVector<PointI>& points31,
+        const QList< QVector<PointI> >& innerPolygonsPoints31,
+        const PointI& origin31)
+    {
+        writePoints(buffer, points31, origin31);
+        writeVarUInt(buffer, innerPolygonsPoints31.size());
+        for (const auto& innerPolygonPoints31 : constOf(innerPolygonsPoints31))
+            writePoints(buffer, innerPolygonPoints31, origin31);
+    }
+
+    // Source object restored from encoded data. Besides geometry it keeps identity of original object, so that
+    // symbols of object that spans several tiles are still shared between them
+    class MapPrimitivesCodecMapObject : public MapObject
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapPrimitivesCodecMapObject);
+    private:
+    protected:
+    public:
+        MapPrimitivesCodecMapObject()
+            : hasSharingKey(false)
+            , sharingKey(0)
+            , hasSortingKey(false)
+            , sortingKey(0)
+            , minZoom(MinZoomLevel)
+            , maxZoom(MaxZoomLevel)
+        {
+        }
+        virtual ~MapPrimitivesCodecMapObject()
+        {
+        }
+
+        bool hasSharingKey;
+        SharingKey sharingKey;
+        bool hasSortingKey;
+        SortingKey sortingKey;
+        ZoomLevel minZoom;
+        ZoomLevel maxZoom;
+
+        virtual bool obtainSharingKey(SharingKey& outKey) const
+        {
+            outKey = sharingKey;
+            return hasSharingKey;
+        }
+
+        virtual bool obtainSortingKey(SortingKey& outKey) const
+        {
+            outKey = sortingKey;
+            return hasSortingKey;
+        }
+
+        virtual ZoomLevel getMinZoomLevel() const
+        {
+            return minZoom;
+        }
+
+        virtual ZoomLevel getMaxZoomLevel() const
+        {
+            return maxZoom;
+        }
+    };
+
+    // Reader that stops at first malformed or truncated entry, which is checked once after reading
+    struct MapPrimitivesCodecReader
+    {
+        MapPrimitivesCodecReader(const QByteArray& data_)
+            : pData(data_.constData())
+            , pEnd(data_.constData() + data_.size())
+            , ok(true)
+        {
+        }
+
+        const char* pData;
+        const char* const pEnd;
+        bool ok;
+
+        bool readBytes(void* const pOut, const size_t size)
+        {
+            if (!ok || static_cast<size_t>(pEnd - pData) < size)
+            {
+                ok = false;
+                memset(pOut, 0, size);
+                return false;
+            }
+
+            memcpy(pOut, pData, size);
+            pData += size;
+            return true;
+        }
+
+        quint8 readUInt8()
+        {
+            quint8 value;
+            readBytes(&value, sizeof(value));
+            return value;
+        }
+
+        quint32 readUInt32()
+        {
+            quint32 value;
+            readBytes(&value, sizeof(value));
+            return qFromLittleEndian(value);
+        }
+
+        uint64_t readVarUInt()
+        {
+            uint64_t value = 0;
+            for (int shift = 0; ok && shift < 64; shift += 7)
+            {
+                const auto byte = readUInt8();
+                value |= static_cast<uint64_t>(byte & 0x7Fu) << shift;
+                if ((byte & 0x80u) == 0)
+                    return value;
+            }
+
+            ok = false;
+            return 0;
+        }
+
+        int64_t readVarInt()
+        {
+            const auto value = readVarUInt();
+            return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 0x1u);
+        }
+
+        // Count of entries that follow, each of at least given size
+        int readCount(const size_t minEntrySize = 1)
+        {
+            const auto count = readVarUInt();
+            if (!ok || count > static_cast<uint64_t>(pEnd - pData) / qMax<size_t>(minEntrySize, 1))
+            {
+                ok = false;
+                return 0;
+            }
+            return static_cast<int>(count);
+        }
+
+        float readFloat()
+        {
+            const auto bits = readUInt32();
+            float value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        double readDouble()
+        {
+            quint64 bits;
+            readBytes(&bits, sizeof(bits));
+            bits = qFromLittleEndian(bits);
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+
+        QString readString()
+        {
+            const auto size = readCount();
+            if (!ok)
+                return QString();
+
+            const auto value = QString::fromUtf8(pData, size);
+            pData += size;
+            return value;
+        }
+
+        void readPoints(QVector<PointI>& outPoints31, const PointI& origin31)
+        {
+            const auto pointsCount = readCount(2);
+            outPoints31.resize(pointsCount);
+            auto point31 = origin31;
+            for (auto& outPoint31 : outPoints31)
+            {
+                point31.x = static_cast<int32_t>(point31.x + readVarInt());
+                point31.y = static_cast<int32_t>(point31.y + readVarInt());
+                outPoint31 = point31;
+            }
+        }
+
+        void readGeometry(QVector<PointI>& outPoints31, QList< QVector<PointI> >& outInnerPolygonsPoints31, const PointI& origin31)
+        {
+            readPoints(outPoints31, origin31);
+            const auto innerPolygonsCount = readCount();
+            outInnerPolygonsPoints31.clear();
+            for (int innerPolygonIdx = 0; ok && innerPolygonIdx < innerPolygonsCount; innerPolygonIdx++)
+            {
+                QVector<PointI> innerPolygonPoints31;
+                readPoints(innerPolygonPoints31, origin31);
+                outInnerPolygonsPoints31.push_back(qMove(innerPolygonPoints31));
+            }
+        }
+    };
+}
+
+OsmAnd::MapPrimitivesCodec::MapPrimitivesCodec()
+{
+}
+
+OsmAnd::MapPrimitivesCodec::~MapPrimitivesCodec()
+{
+}
+
+bool OsmAnd::MapPrimitivesCodec::encode(
+    const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+    const AreaI area31,
+    QByteArray& outData,
+    const bool compress /*= true*/)
+{
+    const auto& resolvedStyle = primitivisedObjects->mapPresentationEnvironment->resolvedStyle;
+    const auto& origin31 = area31.topLeft;
+
+    // Value definitions and strings are referenced by their index in tables that precede the body
+    QHash<ResolvedMapStyle::ValueDefinitionId, int> valueDefinitionsIndices;
+    QStringList valueDefinitionsNames;
+    const auto obtainValueDefinitionIndex =
+        [&valueDefinitionsIndices, &valueDefinitionsNames, resolvedStyle]
+        (const ResolvedMapStyle::ValueDefinitionId valueDefId) -> int
+        {
+            const auto citIndex = valueDefinitionsIndices.constFind(valueDefId);
+            if (citIndex != valueDefinitionsIndices.cend())
+                return *citIndex;
+
+            const auto valueDef = resolvedStyle->getValueDefinitionById(valueDefId);
+            const auto index = valueDefinitionsNames.size();
+            valueDefinitionsNames.push_back(valueDef ? valueDef->name : QString());
+            valueDefinitionsIndices.insert(valueDefId, index);
+            return index;
+        };
+    QHash<QString, int> stringsIndices;
+    QStringList strings;
+    const auto writeStringIndex =
+        [&stringsIndices, &strings]
+        (QByteArray& buffer, const QString& value)
+        {
+            auto itIndex = stringsIndices.find(value);
+            if (itIndex == stringsIndices.end())
+            {
+                itIndex = stringsIndices.insert(value, strings.size());
+                strings.push_back(value);
+            }
+            writeVarUInt(buffer, *itIndex);
+        };
+    const auto writeStringsList =
+        [&writeStringIndex]
+        (QByteArray& buffer, const QList<QString>& values)
+        {
+            writeVarUInt(buffer, values.size());
+            for (const auto& value : constOf(values))
+                writeStringIndex(buffer, value);
+        };
+
+    QByteArray body;
+
+    // Primitives groups with their primitives. Geometry of primitive is stored only if it differs from geometry of
+    // source object (e.g. was simplified)
+    QHash<const MapObject*, int> groupsIndices;
+    QHash<const MapPrimitiviser::Primitive*, int> primitivesIndices;
+    writeVarUInt(body, primitivisedObjects->primitivesGroups.size());
+    for (const auto& group : constOf(primitivisedObjects->primitivesGroups))
+    {
+        const auto& sourceObject = group->sourceObject;
+        groupsIndices.insert(sourceObject.get(), groupsIndices.size());
+
+        MapObject::SharingKey sharingKey = 0;
+        MapObject::SortingKey sortingKey = 0;
+        const auto hasSharingKey = sourceObject->obtainSharingKey(sharingKey);
+        const auto hasSortingKey = sourceObject->obtainSortingKey(sortingKey);
+        body.append(static_cast<char>(
+            (sourceObject->isArea ? 0x1 : 0x0) |
+            (hasSharingKey ? 0x2 : 0x0) |
+            (hasSortingKey ? 0x4 : 0x0)));
+        if (hasSharingKey)
+            writeVarUInt(body, sharingKey);
+        if (hasSortingKey)
+            writeVarUInt(body, sortingKey);
+        body.append(static_cast<char>(sourceObject->getMinZoomLevel()));
+        body.append(static_cast<char>(sourceObject->getMaxZoomLevel()));
+        writeGeometry(body, sourceObject->points31, sourceObject->innerPolygonsPoints31, origin31);
+
+        for (const auto primitives : { &group->polygons, &group->polylines, &group->points })
+        {
+            writeVarUInt(body, primitives->size());
+            for (const auto& primitive : constOf(*primitives))
+            {
+                primitivesIndices.insert(primitive.get(), primitivesIndices.size());
+
+                body.append(static_cast<char>(primitive->type));
+                writeVarUInt(body, primitive->typeRuleIdIndex);
+                writeVarInt(body, primitive->zOrder);
+                writeVarInt(body, primitive->doubledArea);
+
+                QByteArray values;
+                auto valuesCount = 0;
+                for (const auto& valueEntry : rangeOf(constOf(primitive->evaluationResult.values)))
+                {
+                    const auto& value = valueEntry.value();
+                    MapPrimitivesCodecValueType valueType;
+                    switch (static_cast<QMetaType::Type>(value.type()))
+                    {
+                        case QMetaType::Bool:
+                            valueType = MapPrimitivesCodecValueType::Boolean;
+                            break;
+                        case QMetaType::Int:
+                            valueType = MapPrimitivesCodecValueType::Integer;
+                            break;
+                        case QMetaType::UInt:
+                            valueType = MapPrimitivesCodecValueType::UnsignedInteger;
+                            break;
+                        case QMetaType::Float:
+                        case QMetaType::Double:
+                            valueType = MapPrimitivesCodecValueType::Float;
+                            break;
+                        case QMetaType::QString:
+                            valueType = MapPrimitivesCodecValueType::String;
+                            break;
+                        default:
+                            continue;
+                    }
+
+                    writeVarUInt(values, obtainValueDefinitionIndex(valueEntry.key()));
+                    values.append(static_cast<char>(valueType));
+                    switch (valueType)
+                    {
+                        case MapPrimitivesCodecValueType::Boolean:
+                            values.append(static_cast<char>(value.toBool() ? 1 : 0));
+                            break;
+                        case MapPrimitivesCodecValueType::Integer:
+                            writeVarInt(values, value.toInt());
+                            break;
+                        case MapPrimitivesCodecValueType::UnsignedInteger:
+                            writeVarUInt(values, value.toUInt());
+                            break;
+                        case MapPrimitivesCodecValueType::Float:
+                            writeFloat(values, value.toFloat());
+                            break;
+                        case MapPrimitivesCodecValueType::String:
+                            writeStringIndex(values, value.toString());
+                            break;
+                    }
+                    valuesCount++;
+                }
+                writeVarUInt(body, valuesCount);
+                body.append(values);
+
+                const auto hasOwnGeometry =
+                    primitive->points31 != sourceObject->points31 ||
+                    primitive->innerPolygonsPoints31 != sourceObject->innerPolygonsPoints31;
+                body.append(static_cast<char>(hasOwnGeometry ? 1 : 0));
+                if (hasOwnGeometry)
+                    writeGeometry(body, primitive->points31, primitive->innerPolygonsPoints31, origin31);
+            }
+        }
+    }
+
+    // Draw order of primitives
+    for (const auto primitives : { &primitivisedObjects->polygons, &primitivisedObjects->polylines, &primitivisedObjects->points })
+    {
+        writeVarUInt(body, primitives->size());
+        for (const auto& primitive : constOf(*primitives))
+        {
+            const auto citIndex = primitivesIndices.constFind(primitive.get());
+            if (citIndex == primitivesIndices.cend())
+            {
+                LogPrintf(LogSeverityLevel::Error, "Primitive to encode does not belong to any primitives group");
+                return false;
+            }
+            writeVarUInt(body, *citIndex);
+        }
+    }
+
+    // Symbols groups. Groups of objects that have no primitives can not be referenced, so they are skipped
+    QByteArray symbolsGroups;
+    auto symbolsGroupsCount = 0;
+    for (const auto& symbolsGroup : constOf(primitivisedObjects->symbolsGroups))
+    {
+        const auto citGroupIndex = groupsIndices.constFind(symbolsGroup->sourceObject.get());
+        if (citGroupIndex == groupsIndices.cend())
+            continue;
+
+        QByteArray symbols;
+        auto symbolsCount = 0;
+        for (const auto& symbol : constOf(symbolsGroup->symbols))
+        {
+            const auto citPrimitiveIndex = primitivesIndices.constFind(symbol->primitive.get());
+            if (citPrimitiveIndex == primitivesIndices.cend())
+                continue;
+
+            const auto textSymbol = std::dynamic_pointer_cast<const MapPrimitiviser::TextSymbol>(symbol);
+            const auto iconSymbol = std::dynamic_pointer_cast<const MapPrimitiviser::IconSymbol>(symbol);
+            if (!textSymbol && !iconSymbol)
+                continue;
+
+            symbols.append(static_cast<char>(textSymbol ? MapPrimitivesCodecSymbolType::Text : MapPrimitivesCodecSymbolType::Icon));
+            writeVarUInt(symbols, *citPrimitiveIndex);
+            writeVarInt(symbols, static_cast<int64_t>(symbol->location31.x) - origin31.x);
+            writeVarInt(symbols, static_cast<int64_t>(symbol->location31.y) - origin31.y);
+            writeVarInt(symbols, symbol->order);
+            symbols.append(static_cast<char>(symbol->drawAlongPath ? 1 : 0));
+            writeStringsList(symbols, symbol->intersectsWith.toList());
+            writeFloat(symbols, symbol->intersectionSizeFactor);
+            writeFloat(symbols, symbol->intersectionSize);
+            writeFloat(symbols, symbol->intersectionMargin);
+            writeFloat(symbols, symbol->pathPaddingLeft);
+            writeFloat(symbols, symbol->pathPaddingRight);
+            writeFloat(symbols, symbol->minDistance);
+
+            if (textSymbol)
+            {
+                writeStringIndex(symbols, textSymbol->value);
+                writeVarInt(symbols, static_cast<int>(textSymbol->languageId));
+                symbols.append(static_cast<char>(textSymbol->drawOnPath ? 1 : 0));
+                writeVarInt(symbols, textSymbol->verticalOffset);
+                writeUInt32(symbols, textSymbol->color.argb);
+                writeVarInt(symbols, textSymbol->size);
+                writeVarInt(symbols, textSymbol->shadowRadius);
+                writeUInt32(symbols, textSymbol->shadowColor.argb);
+                writeVarInt(symbols, textSymbol->wrapWidth);
+                symbols.append(static_cast<char>((textSymbol->isBold ? 0x1 : 0x0) | (textSymbol->isItalic ? 0x2 : 0x0)));
+                writeStringIndex(symbols, textSymbol->shieldResourceName);
+            }
+            else
+            {
+                writeStringIndex(symbols, iconSymbol->resourceName);
+                writeStringsList(symbols, iconSymbol->underlayResourceNames);
+                writeStringsList(symbols, iconSymbol->overlayResourceNames);
+                writeStringIndex(symbols, iconSymbol->shieldResourceName);
+            }
+            symbolsCount++;
+        }
+
+        writeVarUInt(symbolsGroups, *citGroupIndex);
+        writeVarUInt(symbolsGroups, symbolsCount);
+        symbolsGroups.append(symbols);
+        symbolsGroupsCount++;
+    }
+    writeVarUInt(body, symbolsGroupsCount);
+    body.append(symbolsGroups);
+
+    // Compose payload: general information, tables and body
+    QByteArray payload;
+    payload.reserve(body.size() + strings.size() * 16 + 64);
+    writeVarUInt(payload, primitivisedObjects->zoom);
+    writeVarInt(payload, area31.top());
+    writeVarInt(payload, area31.left());
+    writeVarInt(payload, area31.bottom());
+    writeVarInt(payload, area31.right());
+    writeDouble(payload, primitivisedObjects->scaleDivisor31ToPixel.x);
+    writeDouble(payload, primitivisedObjects->scaleDivisor31ToPixel.y);
+    writeVarUInt(payload, valueDefinitionsNames.size());
+    for (const auto& valueDefinitionName : constOf(valueDefinitionsNames))
+        writeString(payload, valueDefinitionName);
+    writeVarUInt(payload, strings.size());
+    for (const auto& string : constOf(strings))
+        writeString(payload, string);
+    payload.append(body);
+
+    outData.clear();
+    writeUInt32(outData, MapPrimitivesCodecSignature);
+    writeUInt32(outData, FormatVersion);
+    outData.append(static_cast<char>(compress ? MapPrimitivesCodecFlagCompressed : 0));
+    outData.append(compress ? qCompress(payload) : payload);
+
+    return true;
+}
+
+std::shared_ptr<OsmAnd::MapPrimitiviser::PrimitivisedObjects> OsmAnd::MapPrimitivesCodec::decode(
+    const QByteArray& data,
+    const std::shared_ptr<const MapPresentationEnvironment>& environment,
+    AreaI* const outArea31 /*= nullptr*/,
+    const PointI* const areaSizeInPixels /*= nullptr*/)
+{
+    MapPrimitivesCodecReader headerReader(data);
+    const auto signature = headerReader.readUInt32();
+    const auto version = headerReader.readUInt32();
+    const auto flags = headerReader.readUInt8();
+    if (!headerReader.ok || signature != MapPrimitivesCodecSignature || version != FormatVersion)
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Data is not encoded primitives or has unsupported version %d",
+            version);
+        return nullptr;
+    }
+
+    const auto headerSize = static_cast<int>(headerReader.pData - data.constData());
+    const auto payload = (flags & MapPrimitivesCodecFlagCompressed)
+        ? qUncompress(reinterpret_cast<const uchar*>(data.constData() + headerSize), data.size() - headerSize)
+        : data.mid(headerSize);
+    MapPrimitivesCodecReader reader(payload);
+
+    const auto zoom = static_cast<ZoomLevel>(reader.readVarUInt());
+    AreaI area31;
+    area31.top() = static_cast<int32_t>(reader.readVarInt());
+    area31.left() = static_cast<int32_t>(reader.readVarInt());
+    area31.bottom() = static_cast<int32_t>(reader.readVarInt());
+    area31.right() = static_cast<int32_t>(reader.readVarInt());
+    PointD scaleDivisor31ToPixel;
+    scaleDivisor31ToPixel.x = reader.readDouble();
+    scaleDivisor31ToPixel.y = reader.readDouble();
+    if (!reader.ok || zoom > MaxZoomLevel)
+        return nullptr;
+    if (areaSizeInPixels != nullptr && areaSizeInPixels->x > 0 && areaSizeInPixels->y > 0)
+    {
+        scaleDivisor31ToPixel.x = static_cast<double>(area31.width()) / areaSizeInPixels->x;
+        scaleDivisor31ToPixel.y = static_cast<double>(area31.height()) / areaSizeInPixels->y;
+    }
+    const auto& origin31 = area31.topLeft;
+
+    // Resolve value definitions by name in style of given environment
+    const auto valueDefinitionsCount = reader.readCount();
+    QVector<ResolvedMapStyle::ValueDefinitionId> valueDefinitionsIds(valueDefinitionsCount);
+    for (auto& valueDefinitionId : valueDefinitionsIds)
+    {
+        const auto valueDefinitionName = reader.readString();
+        valueDefinitionId = environment->resolvedStyle->getValueDefinitionIdByName(valueDefinitionName);
+        if (reader.ok && valueDefinitionId < 0)
+        {
+            LogPrintf(LogSeverityLevel::Warning,
+                "Value '%s' of encoded primitives is not defined by style, ignoring it",
+                qPrintable(valueDefinitionName));
+        }
+    }
+    const auto stringsCount = reader.readCount();
+    QVector<QString> strings(stringsCount);
+    for (auto& string : strings)
+        string = reader.readString();
+    const auto readStringIndex =
+        [&reader, &strings]
+        () -> QString
+        {
+            const auto index = reader.readVarUInt();
+            if (!reader.ok || index >= static_cast<uint64_t>(strings.size()))
+            {
+                reader.ok = false;
+                return QString();
+            }
+            return strings[index];
+        };
+    const auto readStringsList =
+        [&reader, &readStringIndex]
+        () -> QList<QString>
+        {
+            QList<QString> values;
+            const auto count = reader.readCount();
+            for (int idx = 0; reader.ok && idx < count; idx++)
+                values.push_back(readStringIndex());
+            return values;
+        };
+    if (!reader.ok)
+        return nullptr;
+
+    const std::shared_ptr<MapPrimitiviser::PrimitivisedObjects> primitivisedObjects(new MapPrimitiviser::PrimitivisedObjects(
+        environment,
+        nullptr,
+        zoom,
+        scaleDivisor31ToPixel));
+
+    // Primitives groups with their primitives
+    QVector< std::shared_ptr<MapPrimitiviser::PrimitivesGroup> > groups;
+    QVector< std::shared_ptr<const MapPrimitiviser::Primitive> > primitives;
+    const auto groupsCount = reader.readCount();
+    groups.reserve(groupsCount);
+    for (int groupIdx = 0; reader.ok && groupIdx < groupsCount; groupIdx++)
+    {
+        const std::shared_ptr<MapPrimitivesCodecMapObject> sourceObject(new MapPrimitivesCodecMapObject());
+        const auto objectFlags = reader.readUInt8();
+        sourceObject->isArea = (objectFlags & 0x1) != 0;
+        sourceObject->hasSharingKey = (objectFlags & 0x2) != 0;
+        if (sourceObject->hasSharingKey)
+            sourceObject->sharingKey = reader.readVarUInt();
+        sourceObject->hasSortingKey = (objectFlags & 0x4) != 0;
+        if (sourceObject->hasSortingKey)
+            sourceObject->sortingKey = reader.readVarUInt();
+        sourceObject->minZoom = static_cast<ZoomLevel>(qMin<int>(reader.readUInt8(), MaxZoomLevel));
+        sourceObject->maxZoom = static_cast<ZoomLevel>(qMin<int>(reader.readUInt8(), MaxZoomLevel));
+        reader.readGeometry(sourceObject->points31, sourceObject->innerPolygonsPoints31, origin31);
+        sourceObject->computeBBox31();
+
+        const std::shared_ptr<MapPrimitiviser::PrimitivesGroup> group(new MapPrimitiviser::PrimitivesGroup(sourceObject));
+        for (const auto groupPrimitives : { &group->polygons, &group->polylines, &group->points })
+        {
+            const auto primitivesCount = reader.readCount();
+            groupPrimitives->reserve(primitivesCount);
+            for (int primitiveIdx = 0; reader.ok && primitiveIdx < primitivesCount; primitiveIdx++)
+            {
+                const auto type = static_cast<MapPrimitiviser::PrimitiveType>(reader.readUInt8());
+                const auto typeRuleIdIndex = static_cast<uint32_t>(reader.readVarUInt());
+                const auto zOrder = static_cast<int>(reader.readVarInt());
+                const auto doubledArea = reader.readVarInt();
+
+                MapStyleEvaluationResult evaluationResult;
+                const auto valuesCount = reader.readCount(2);
+                for (int valueIdx = 0; reader.ok && valueIdx < valuesCount; valueIdx++)
+                {
+                    const auto valueDefinitionIndex = reader.readVarUInt();
+                    if (valueDefinitionIndex >= static_cast<uint64_t>(valueDefinitionsIds.size()))
+                    {
+                        reader.ok = false;
+                        break;
+                    }
+
+                    QVariant value;
+                    switch (static_cast<MapPrimitivesCodecValueType>(reader.readUInt8()))
+                    {
+                        case MapPrimitivesCodecValueType::Boolean:
+                            value = (reader.readUInt8() != 0);
+                            break;
+                        case MapPrimitivesCodecValueType::Integer:
+                            value = static_cast<int>(reader.readVarInt());
+                            break;
+                        case MapPrimitivesCodecValueType::UnsignedInteger:
+                            value = static_cast<unsigned int>(reader.readVarUInt());
+                            break;
+                        case MapPrimitivesCodecValueType::Float:
+                            value = reader.readFloat();
+                            break;
+                        case MapPrimitivesCodecValueType::String:
+                            value = readStringIndex();
+                            break;
+                        default:
+                            reader.ok = false;
+                            break;
+                    }
+
+                    const auto valueDefinitionId = valueDefinitionsIds[valueDefinitionIndex];
+                    if (valueDefinitionId >= 0)
+                        evaluationResult.values.insert(valueDefinitionId, value);
+                }
+
+                const std::shared_ptr<MapPrimitiviser::Primitive> primitive(new MapPrimitiviser::Primitive(
+                    group,
+                    type,
+                    typeRuleIdIndex,
+                    qMove(evaluationResult)));
+                primitive->zOrder = zOrder;
+                primitive->doubledArea = doubledArea;
+                if (reader.readUInt8() != 0)
+                    reader.readGeometry(primitive->points31, primitive->innerPolygonsPoints31, origin31);
+
+                groupPrimitives->push_back(primitive);
+                primitives.push_back(primitive);
+            }
+        }
+
+        groups.push_back(group);
+        primitivisedObjects->primitivesGroups.push_back(group);
+    }
+
+    // Draw order of primitives
+    for (const auto orderedPrimitives : { &primitivisedObjects->polygons, &primitivisedObjects->polylines, &primitivisedObjects->points })
+    {
+        const auto primitivesCount = reader.readCount();
+        orderedPrimitives->reserve(primitivesCount);
+        for (int idx = 0; reader.ok && idx < primitivesCount; idx++)
+        {
+            const auto primitiveIndex = reader.readVarUInt();
+            if (primitiveIndex >= static_cast<uint64_t>(primitives.size()))
+            {
+                reader.ok = false;
+                break;
+            }
+            orderedPrimitives->push_back(primitives[primitiveIndex]);
+        }
+    }
+
+    // Symbols groups
+    const auto symbolsGroupsCount = reader.readCount(2);
+    for (int symbolsGroupIdx = 0; reader.ok && symbolsGroupIdx < symbolsGroupsCount; symbolsGroupIdx++)
+    {
+        const auto groupIndex = reader.readVarUInt();
+        if (groupIndex >= static_cast<uint64_t>(groups.size()))
+        {
+            reader.ok = false;
+            break;
+        }
+        const auto& sourceObject = groups[groupIndex]->sourceObject;
+        const std::shared_ptr<MapPrimitiviser::SymbolsGroup> symbolsGroup(new MapPrimitiviser::SymbolsGroup(sourceObject));
+
+        const auto symbolsCount = reader.readCount(2);
+        for (int symbolIdx = 0; reader.ok && symbolIdx < symbolsCount; symbolIdx++)
+        {
+            const auto symbolType = static_cast<MapPrimitivesCodecSymbolType>(reader.readUInt8());
+            const auto primitiveIndex = reader.readVarUInt();
+            if (primitiveIndex >= static_cast<uint64_t>(primitives.size()))
+            {
+                reader.ok = false;
+                break;
+            }
+            const auto& primitive = primitives[primitiveIndex];
+
+            std::shared_ptr<MapPrimitiviser::Symbol> symbol;
+            std::shared_ptr<MapPrimitiviser::TextSymbol> textSymbol;
+            std::shared_ptr<MapPrimitiviser::IconSymbol> iconSymbol;
+            if (symbolType == MapPrimitivesCodecSymbolType::Text)
+            {
+                textSymbol.reset(new MapPrimitiviser::TextSymbol(primitive));
+                symbol = textSymbol;
+            }
+            else if (symbolType == MapPrimitivesCodecSymbolType::Icon)
+            {
+                iconSymbol.reset(new MapPrimitiviser::IconSymbol(primitive));
+                symbol = iconSymbol;
+            }
+            else
+            {
+                reader.ok = false;
+                break;
+            }
+
+            symbol->location31.x = static_cast<int32_t>(origin31.x + reader.readVarInt());
+            symbol->location31.y = static_cast<int32_t>(origin31.y + reader.readVarInt());
+            symbol->order = static_cast<int>(reader.readVarInt());
+            symbol->drawAlongPath = (reader.readUInt8() != 0);
+            symbol->intersectsWith = readStringsList().toSet();
+            symbol->intersectionSizeFactor = reader.readFloat();
+            symbol->intersectionSize = reader.readFloat();
+            symbol->intersectionMargin = reader.readFloat();
+            symbol->pathPaddingLeft = reader.readFloat();
+            symbol->pathPaddingRight = reader.readFloat();
+            symbol->minDistance = reader.readFloat();
+
+            if (textSymbol)
+            {
+                textSymbol->value = readStringIndex();
+                textSymbol->languageId = static_cast<LanguageId>(reader.readVarInt());
+                textSymbol->drawOnPath = (reader.readUInt8() != 0);
+                textSymbol->verticalOffset = static_cast<int>(reader.readVarInt());
+                textSymbol->color.argb = reader.readUInt32();
+                textSymbol->size = static_cast<int>(reader.readVarInt());
+                textSymbol->shadowRadius = static_cast<int>(reader.readVarInt());
+                textSymbol->shadowColor.argb = reader.readUInt32();
+                textSymbol->wrapWidth = static_cast<int>(reader.readVarInt());
+                const auto styleFlags = reader.readUInt8();
+                textSymbol->isBold = (styleFlags & 0x1) != 0;
+                textSymbol->isItalic = (styleFlags & 0x2) != 0;
+                textSymbol->shieldResourceName = readStringIndex();
+            }
+            else
+            {
+                iconSymbol->resourceName = readStringIndex();
+                iconSymbol->underlayResourceNames = readStringsList();
+                iconSymbol->overlayResourceNames = readStringsList();
+                iconSymbol->shieldResourceName = readStringIndex();
+            }
+
+            symbolsGroup->symbols.push_back(symbol);
+        }
+
+        primitivisedObjects->symbolsGroups.insert(sourceObject, symbolsGroup);
+    }
+
+    if (!reader.ok)
+    {
+        LogPrintf(LogSeverityLevel::Warning, "Encoded primitives are malformed or truncated");
+        return nullptr;
+    }
+
+    if (outArea31)
+        *outArea31 = area31;
+    return primitivisedObjects;
+}
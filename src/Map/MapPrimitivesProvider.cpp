@@ -1,16 +1,22 @@
 #include "MapPrimitivesProvider.h"
 #include "MapPrimitivesProvider_P.h"
 
+#include "RasterTilesDiskCache.h"
+
 OsmAnd::MapPrimitivesProvider::MapPrimitivesProvider(
     const std::shared_ptr<IMapObjectsProvider>& mapObjectsProvider_,
     const std::shared_ptr<MapPrimitiviser>& primitiviser_,
     const unsigned int tileSize_ /*= 256*/,
-    const Mode mode_ /*= Mode::WithSurface*/)
+    const Mode mode_ /*= Mode::WithSurface*/,
+    const std::shared_ptr<RasterTilesDiskCache>& diskCache_ /*= nullptr*/,
+    const std::shared_ptr<MapPrimitiviser::Cache>& primitiviserCache_ /*= nullptr*/)
     : _p(new MapPrimitivesProvider_P(this))
     , mapObjectsProvider(mapObjectsProvider_)
     , primitiviser(primitiviser_)
     , tileSize(tileSize_)
     , mode(mode_)
+    , diskCache(diskCache_)
+    , primitiviserCache(primitiviserCache_)
 {
 }
 
@@ -49,7 +55,8 @@ bool OsmAnd::MapPrimitivesProvider::obtainData(
         zoom,
         tiledData,
         pOutMetric ? static_cast<MapPrimitivesProvider_Metrics::Metric_obtainData*>(pOutMetric->get()) : nullptr,
-        queryController);
+        queryController,
+        true);
     outTiledData = tiledData;
     return result;
 }
@@ -59,9 +66,18 @@ bool OsmAnd::MapPrimitivesProvider::obtainData(
     const ZoomLevel zoom,
     std::shared_ptr<Data>& outTiledData,
     MapPrimitivesProvider_Metrics::Metric_obtainData* const metric,
-    const IQueryController* const queryController)
+    const IQueryController* const queryController,
+    const bool retainAsRecent /*= true*/)
+{
+    return _p->obtainData(tileId, zoom, outTiledData, metric, queryController, retainAsRecent);
+}
+
+bool OsmAnd::MapPrimitivesProvider::obtainDerivedData(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    std::shared_ptr<Data>& outTiledData)
 {
-    return _p->obtainData(tileId, zoom, outTiledData, metric, queryController);
+    return _p->obtainDerivedData(tileId, zoom, outTiledData);
 }
 
 OsmAnd::MapPrimitivesProvider::Data::Data(
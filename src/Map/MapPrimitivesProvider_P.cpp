@@ -6,7 +6,17 @@
 #   define OSMAND_PERFORMANCE_METRICS 0
 #endif // !defined(OSMAND_PERFORMANCE_METRICS)
 
+#include "QtExtensions.h"
+#include <QSet>
+#include <QPair>
+#include <QtAlgorithms>
+
 #include "IMapObjectsProvider.h"
+#include "ObfMapObjectsProvider.h"
+#include "IObfsCollection.h"
+#include "MapPresentationEnvironment.h"
+#include "MapPrimitivesCodec.h"
+#include "RasterTilesDiskCache.h"
 #include "Stopwatch.h"
 #include "Utilities.h"
 #include "Logging.h"
@@ -26,7 +36,8 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
     const ZoomLevel zoom,
     std::shared_ptr<MapPrimitivesProvider::Data>& outTiledData,
     MapPrimitivesProvider_Metrics::Metric_obtainData* const metric_,
-    const IQueryController* const queryController)
+    const IQueryController* const queryController,
+    const bool retainAsRecent)
 {
 #if OSMAND_PERFORMANCE_METRICS
     MapPrimitivesProvider_Metrics::Metric_obtainData localMetric;
@@ -93,6 +104,54 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
 #endif // OSMAND_PERFORMANCE_METRICS
         );
 
+    // Check if this tile was already primitivised earlier (possibly in other session) from exactly same data
+    const auto& diskCache = owner->diskCache;
+    QString diskCacheKey;
+    if (diskCache)
+    {
+        diskCacheKey = getDiskCacheKey(tileId, zoom);
+
+        std::shared_ptr<MapPrimitiviser::PrimitivisedObjects> cachedPrimitivisedObjects;
+        if (obtainPrimitivisedObjectsFromDiskCache(tileId, zoom, diskCacheKey, cachedPrimitivisedObjects))
+        {
+            if (metric)
+                metric->diskCacheHits++;
+
+            std::shared_ptr<MapPrimitivesProvider::Data> newTiledData;
+            if (cachedPrimitivisedObjects)
+            {
+                newTiledData.reset(new MapPrimitivesProvider::Data(
+                    tileId,
+                    zoom,
+                    nullptr,
+                    cachedPrimitivisedObjects,
+                    new RetainableCacheMetadata(tileEntry, nullptr)));
+            }
+
+            // Publish tile (if any) and mark tile entry as 'Loaded'
+            if (newTiledData && retainAsRecent)
+                retainRecentTile(newTiledData);
+            outTiledData = newTiledData;
+            tileEntry->dataIsPresent = (newTiledData != nullptr);
+            tileEntry->dataWeakRef = newTiledData;
+            tileEntry->setState(TileState::Loaded);
+
+            // Notify that tile has been loaded
+            {
+                QWriteLocker scopedLcoker(&tileEntry->loadedConditionLock);
+                tileEntry->loadedCondition.wakeAll();
+            }
+
+            if (metric)
+                metric->elapsedTime = totalStopwatch.elapsed();
+
+            return true;
+        }
+
+        if (metric)
+            metric->diskCacheMisses++;
+    }
+
     // Obtain map objects data tile
     std::shared_ptr<IMapObjectsProvider::Data> dataTile;
     std::shared_ptr<Metric> submetric;
@@ -106,6 +165,9 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
         metric->addOrReplaceSubmetric(submetric);
     if (!dataTile)
     {
+        if (diskCache)
+            storePrimitivisedObjectsToDiskCache(tileId, zoom, diskCacheKey, nullptr);
+
         // Store flag that there was no data and mark tile entry as 'Loaded'
         tileEntry->dataIsPresent = false;
         tileEntry->setState(TileState::Loaded);
@@ -120,16 +182,15 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
         return true;
     }
 
-    // Get primitivised objects
+    // Get primitivised objects. Sharing primitives between tiles via cache is opt-in through constructor: cache
+    // is null by default, since locking it on each tile costs more than sharing gives during regular rendering
     std::shared_ptr<MapPrimitiviser::PrimitivisedObjects> primitivisedObjects;
     if (owner->mode == MapPrimitivesProvider::Mode::AllObjectsWithoutPolygonFiltering)
     {
         primitivisedObjects = owner->primitiviser->primitiviseAllMapObjects(
             zoom,
             dataTile->mapObjects,
-            //NOTE: So far it's safe to turn off this cache. But it has to be rewritten. Since lock/unlock occurs too often, this kills entire performance
-            //NOTE: Maybe a QuadTree-based cache with leaf-only locking will save up much. Or use supernodes, like DataBlock
-            nullptr, //_primitiviserCache,
+            owner->primitiviserCache,
             nullptr,
             metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseAllMapObjects>().get() : nullptr);
     }
@@ -139,9 +200,7 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
             Utilities::getScaleDivisor31ToPixel(PointI(owner->tileSize, owner->tileSize), zoom),
             zoom,
             dataTile->mapObjects,
-            //NOTE: So far it's safe to turn off this cache. But it has to be rewritten. Since lock/unlock occurs too often, this kills entire performance
-            //NOTE: Maybe a QuadTree-based cache with leaf-only locking will save up much. Or use supernodes, like DataBlock
-            nullptr, //_primitiviserCache,
+            owner->primitiviserCache,
             nullptr,
             metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseAllMapObjects>().get() : nullptr);
     }
@@ -151,9 +210,7 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
             Utilities::getScaleDivisor31ToPixel(PointI(owner->tileSize, owner->tileSize), zoom),
             zoom,
             dataTile->mapObjects,
-            //NOTE: So far it's safe to turn off this cache. But it has to be rewritten. Since lock/unlock occurs too often, this kills entire performance
-            //NOTE: Maybe a QuadTree-based cache with leaf-only locking will save up much. Or use supernodes, like DataBlock
-            nullptr, //_primitiviserCache,
+            owner->primitiviserCache,
             nullptr,
             metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseWithoutSurface>().get() : nullptr);
     }
@@ -166,13 +223,15 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
             zoom,
             dataTile->tileSurfaceType,
             dataTile->mapObjects,
-            //NOTE: So far it's safe to turn off this cache. But it has to be rewritten. Since lock/unlock occurs too often, this kills entire performance
-            //NOTE: Maybe a QuadTree-based cache with leaf-only locking will save up much. Or use supernodes, like DataBlock
-            nullptr, //_primitiviserCache,
+            owner->primitiviserCache,
             nullptr,
             metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseWithSurface>().get() : nullptr);
     }
 
+    // Primitives of aborted query may be incomplete, so they are not stored
+    if (diskCache && primitivisedObjects && !(queryController && queryController->isAborted()))
+        storePrimitivisedObjectsToDiskCache(tileId, zoom, diskCacheKey, primitivisedObjects);
+
     // Create tile
     const std::shared_ptr<MapPrimitivesProvider::Data> newTiledData(new MapPrimitivesProvider::Data(
         tileId,
@@ -182,6 +241,8 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
         new RetainableCacheMetadata(tileEntry, dataTile->retainableCacheMetadata)));
 
     // Publish new tile
+    if (retainAsRecent)
+        retainRecentTile(newTiledData);
     outTiledData = newTiledData;
 
     // Store weak reference to new tile and mark it as 'Loaded'
@@ -226,6 +287,221 @@ bool OsmAnd::MapPrimitivesProvider_P::obtainData(
     return true;
 }
 
+void OsmAnd::MapPrimitivesProvider_P::retainRecentTile(const std::shared_ptr<const MapPrimitivesProvider::Data>& tiledData)
+{
+    QMutexLocker scopedLocker(&_recentTilesMutex);
+
+    _recentTiles.removeOne(tiledData);
+    _recentTiles.append(tiledData);
+    while (_recentTiles.size() > RecentTilesLimit)
+        _recentTiles.removeFirst();
+}
+
+std::shared_ptr<const OsmAnd::MapPrimitivesProvider::Data> OsmAnd::MapPrimitivesProvider_P::findRecentTile(
+    const TileId tileId,
+    const ZoomLevel zoom) const
+{
+    QMutexLocker scopedLocker(&_recentTilesMutex);
+
+    for (const auto& recentTile : constOf(_recentTiles))
+    {
+        if (recentTile->tileId == tileId && recentTile->zoom == zoom)
+            return recentTile;
+    }
+    return nullptr;
+}
+
+bool OsmAnd::MapPrimitivesProvider_P::obtainDerivedData(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    std::shared_ptr<MapPrimitivesProvider::Data>& outTiledData)
+{
+    // Prefer nearest parent tile, since single source needs no merging
+    QList< std::shared_ptr<const MapPrimitivesProvider::Data> > sourceTiles;
+    for (int zoomDelta = 1; zoomDelta <= MaxOverscaleZoomDifference && zoom - zoomDelta >= MinZoomLevel; zoomDelta++)
+    {
+        const auto parentTileId = TileId::fromXY(tileId.x >> zoomDelta, tileId.y >> zoomDelta);
+        if (const auto parentTile = findRecentTile(parentTileId, static_cast<ZoomLevel>(zoom - zoomDelta)))
+        {
+            sourceTiles.push_back(parentTile);
+            break;
+        }
+    }
+
+    // Otherwise all child tiles are needed, since partially covered tile is not better than none
+    if (sourceTiles.isEmpty() && zoom < MaxZoomLevel)
+    {
+        const auto childZoom = static_cast<ZoomLevel>(zoom + 1);
+        for (int childIdx = 0; childIdx < 4; childIdx++)
+        {
+            const auto childTileId = TileId::fromXY((tileId.x << 1) + (childIdx & 0x1), (tileId.y << 1) + (childIdx >> 1));
+            const auto childTile = findRecentTile(childTileId, childZoom);
+            if (!childTile)
+            {
+                sourceTiles.clear();
+                break;
+            }
+            sourceTiles.push_back(childTile);
+        }
+    }
+    if (sourceTiles.isEmpty())
+        return false;
+
+    const auto tileBBox31 = Utilities::tileBoundingBox31(tileId, zoom);
+    const auto& sourcePrimitivisedObjects = sourceTiles.first()->primitivisedObjects;
+    const std::shared_ptr<MapPrimitiviser::PrimitivisedObjects> primitivisedObjects(new MapPrimitiviser::PrimitivisedObjects(
+        sourcePrimitivisedObjects->mapPresentationEnvironment,
+        nullptr,
+        sourcePrimitivisedObjects->zoom,
+        Utilities::getScaleDivisor31ToPixel(PointI(owner->tileSize, owner->tileSize), zoom)));
+
+    // Take primitives that touch the tile. Same object may be present in several child tiles, so it's taken once
+    const auto isInsideTile =
+        [tileBBox31]
+        (const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive) -> bool
+        {
+            if (primitive->points31.isEmpty())
+                return false;
+
+            AreaI bbox31(primitive->points31.first(), primitive->points31.first());
+            for (const auto& point31 : constOf(primitive->points31))
+                bbox31.enlargeToInclude(point31);
+            return tileBBox31.intersects(bbox31);
+        };
+    QSet< std::shared_ptr<const MapPrimitiviser::PrimitivesGroup> > takenGroups;
+    QSet< QPair<const MapObject*, uint64_t> > takenPrimitives;
+    const auto takePrimitives =
+        [&isInsideTile, &takenGroups, &takenPrimitives, primitivisedObjects]
+        (const MapPrimitiviser::PrimitivesCollection& primitives, MapPrimitiviser::PrimitivesCollection& outPrimitives)
+        {
+            for (const auto& primitive : constOf(primitives))
+            {
+                if (!isInsideTile(primitive))
+                    continue;
+
+                const auto primitiveKey = qMakePair(
+                    primitive->sourceObject.get(),
+                    (static_cast<uint64_t>(primitive->type) << 32) | primitive->typeRuleIdIndex);
+                if (takenPrimitives.contains(primitiveKey))
+                    continue;
+                takenPrimitives.insert(primitiveKey);
+                outPrimitives.push_back(primitive);
+
+                const auto group = primitive->group.lock();
+                if (group && !takenGroups.contains(group))
+                {
+                    takenGroups.insert(group);
+                    primitivisedObjects->primitivesGroups.push_back(group);
+                }
+            }
+        };
+    for (const auto& sourceTile : constOf(sourceTiles))
+    {
+        const auto& sourceObjects = sourceTile->primitivisedObjects;
+        takePrimitives(sourceObjects->polygons, primitivisedObjects->polygons);
+        takePrimitives(sourceObjects->polylines, primitivisedObjects->polylines);
+        takePrimitives(sourceObjects->points, primitivisedObjects->points);
+    }
+
+    // Primitives of each source tile are already ordered, so merged ones just need to be reordered by same keys
+    if (sourceTiles.size() > 1)
+    {
+        const auto primitivesSort =
+            []
+            (const std::shared_ptr<const MapPrimitiviser::Primitive>& l, const std::shared_ptr<const MapPrimitiviser::Primitive>& r) -> bool
+            {
+                if (l->zOrder != r->zOrder)
+                    return l->zOrder < r->zOrder;
+                return l->doubledArea > r->doubledArea;
+            };
+        qStableSort(primitivisedObjects->polygons.begin(), primitivisedObjects->polygons.end(), primitivesSort);
+        qStableSort(primitivisedObjects->polylines.begin(), primitivisedObjects->polylines.end(), primitivesSort);
+        qStableSort(primitivisedObjects->points.begin(), primitivisedObjects->points.end(), primitivesSort);
+    }
+
+    outTiledData.reset(new MapPrimitivesProvider::Data(
+        tileId,
+        zoom,
+        sourceTiles.first()->mapObjectsData,
+        primitivisedObjects));
+    return true;
+}
+
+QString OsmAnd::MapPrimitivesProvider_P::getDiskCacheKey(const TileId tileId, const ZoomLevel zoom) const
+{
+    // Primitives depend on style and its settings, presentation settings, encoding format and map data
+    std::shared_ptr<const IObfsCollection> obfsCollection;
+    if (const auto obfMapObjectsProvider =
+        std::dynamic_pointer_cast<const ObfMapObjectsProvider>(owner->mapObjectsProvider))
+    {
+        obfsCollection = obfMapObjectsProvider->obfsCollection;
+    }
+
+    return _diskCacheFingerprint.getTileKey(
+        tileId,
+        zoom,
+        owner->primitiviser->environment,
+        obfsCollection,
+        QString(QLatin1String("primitives:%1:%2:%3"))
+            .arg(owner->tileSize)
+            .arg(static_cast<int>(owner->mode))
+            .arg(MapPrimitivesCodec::FormatVersion));
+}
+
+bool OsmAnd::MapPrimitivesProvider_P::obtainPrimitivisedObjectsFromDiskCache(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    const QString& diskCacheKey,
+    std::shared_ptr<MapPrimitiviser::PrimitivisedObjects>& outPrimitivisedObjects) const
+{
+    QByteArray encodedPrimitives;
+    if (!owner->diskCache->obtainEntry(diskCacheKey, encodedPrimitives))
+        return false;
+
+    // Empty entry means that tile has no data
+    if (encodedPrimitives.isEmpty())
+    {
+        outPrimitivisedObjects.reset();
+        return true;
+    }
+
+    AreaI area31;
+    const auto primitivisedObjects = MapPrimitivesCodec::decode(
+        encodedPrimitives,
+        owner->primitiviser->environment,
+        &area31);
+    if (!primitivisedObjects || area31 != Utilities::tileBoundingBox31(tileId, zoom))
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to decode cached primitives of %dx%d@%d",
+            tileId.x,
+            tileId.y,
+            zoom);
+        return false;
+    }
+
+    outPrimitivisedObjects = primitivisedObjects;
+    return true;
+}
+
+void OsmAnd::MapPrimitivesProvider_P::storePrimitivisedObjectsToDiskCache(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    const QString& diskCacheKey,
+    const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects) const
+{
+    if (!primitivisedObjects)
+    {
+        owner->diskCache->storeEntry(diskCacheKey, QByteArray());
+        return;
+    }
+
+    QByteArray encodedPrimitives;
+    if (!MapPrimitivesCodec::encode(primitivisedObjects, Utilities::tileBoundingBox31(tileId, zoom), encodedPrimitives))
+        return;
+    owner->diskCache->storeEntry(diskCacheKey, encodedPrimitives);
+}
+
 OsmAnd::MapPrimitivesProvider_P::RetainableCacheMetadata::RetainableCacheMetadata(
     const std::shared_ptr<TileEntry>& tileEntry,
     const std::shared_ptr<const IMapDataProvider::RetainableCacheMetadata>& binaryMapRetainableCacheMetadata_)
@@ -9,6 +9,8 @@
 #include "QtExtensions.h"
 #include "ignore_warnings_on_external_includes.h"
 #include <QHash>
+#include <QList>
+#include <QString>
 #include <QAtomicInt>
 #include <QMutex>
 #include <QReadWriteLock>
@@ -25,6 +27,7 @@
 #include "MapPrimitiviser.h"
 #include "MapPrimitivesProvider.h"
 #include "MapPrimitivesProvider_Metrics.h"
+#include "MapContentFingerprint.h"
 
 namespace OsmAnd
 {
@@ -64,6 +67,18 @@ namespace OsmAnd
 
         const std::shared_ptr<MapPrimitiviser::Cache> _primitiviserCache;
 
+        enum {
+            // Recently obtained tiles are kept alive to derive tiles of nearby zooms from them
+            RecentTilesLimit = 24,
+
+            // Farthest parent tile to derive overscaled tile from
+            MaxOverscaleZoomDifference = 3,
+        };
+        mutable QMutex _recentTilesMutex;
+        QList< std::shared_ptr<const MapPrimitivesProvider::Data> > _recentTiles;
+        void retainRecentTile(const std::shared_ptr<const MapPrimitivesProvider::Data>& tiledData);
+        std::shared_ptr<const MapPrimitivesProvider::Data> findRecentTile(const TileId tileId, const ZoomLevel zoom) const;
+
         struct RetainableCacheMetadata : public IMapDataProvider::RetainableCacheMetadata
         {
             RetainableCacheMetadata(
@@ -74,6 +89,19 @@ namespace OsmAnd
             std::weak_ptr<TileEntry> tileEntryWeakRef;
             std::shared_ptr<const IMapDataProvider::RetainableCacheMetadata> binaryMapRetainableCacheMetadata;
         };
+
+        const MapContentFingerprint _diskCacheFingerprint;
+        QString getDiskCacheKey(const TileId tileId, const ZoomLevel zoom) const;
+        bool obtainPrimitivisedObjectsFromDiskCache(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            const QString& diskCacheKey,
+            std::shared_ptr<MapPrimitiviser::PrimitivisedObjects>& outPrimitivisedObjects) const;
+        void storePrimitivisedObjectsToDiskCache(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            const QString& diskCacheKey,
+            const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects) const;
     public:
         ~MapPrimitivesProvider_P();
 
@@ -84,7 +112,13 @@ namespace OsmAnd
             const ZoomLevel zoom,
             std::shared_ptr<MapPrimitivesProvider::Data>& outTiledData,
             MapPrimitivesProvider_Metrics::Metric_obtainData* const metric,
-            const IQueryController* const queryController);
+            const IQueryController* const queryController,
+            const bool retainAsRecent);
+
+        bool obtainDerivedData(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            std::shared_ptr<MapPrimitivesProvider::Data>& outTiledData);
 
     friend class OsmAnd::MapPrimitivesProvider;
     };
@@ -94,6 +94,8 @@ OsmAnd::MapPrimitiviser::Primitive::Primitive(
     , typeRuleIdIndex(typeRuleIdIndex_)
     , zOrder(0)
     , doubledArea(-1)
+    , points31(group_->sourceObject->points31)
+    , innerPolygonsPoints31(group_->sourceObject->innerPolygonsPoints31)
 {
 }
 
@@ -109,6 +111,8 @@ OsmAnd::MapPrimitiviser::Primitive::Primitive(
     , evaluationResult(evaluationResult_)
     , zOrder(0)
     , doubledArea(-1)
+    , points31(group_->sourceObject->points31)
+    , innerPolygonsPoints31(group_->sourceObject->innerPolygonsPoints31)
 {
 }
 
@@ -125,6 +129,8 @@ OsmAnd::MapPrimitiviser::Primitive::Primitive(
     , evaluationResult(qMove(evaluationResult_))
     , zOrder(0)
     , doubledArea(-1)
+    , points31(group_->sourceObject->points31)
+    , innerPolygonsPoints31(group_->sourceObject->innerPolygonsPoints31)
 {
 }
 #endif // Q_COMPILER_RVALUE_REFS
@@ -344,6 +350,8 @@ bool OsmAnd::MapPrimitiviser::IconSymbol::hasDifferentContentAs(const IconSymbol
 }
 
 OsmAnd::MapPrimitiviser::Cache::Cache()
+    : _coastlinesPartsStoredSincePurge(0)
+    , _coastlinesPartsPointsCount(0)
 {
 }
 
@@ -351,14 +359,39 @@ OsmAnd::MapPrimitiviser::Cache::~Cache()
 {
 }
 
-OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer& OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroups(const ZoomLevel zoom)
+OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer& OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroups(
+    const ZoomLevel zoom,
+    const PointD scaleDivisor31ToPixel)
 {
-    return _sharedPrimitivesGroups[zoom];
+    const ScaleKey scaleKey(scaleDivisor31ToPixel.x, scaleDivisor31ToPixel.y);
+
+    {
+        QReadLocker scopedLocker(&_sharedPrimitivesGroupsLock);
+
+        const auto citContainer = _sharedPrimitivesGroups[zoom].constFind(scaleKey);
+        if (citContainer != _sharedPrimitivesGroups[zoom].cend())
+            return **citContainer;
+    }
+
+    QWriteLocker scopedLocker(&_sharedPrimitivesGroupsLock);
+
+    auto& container = _sharedPrimitivesGroups[zoom][scaleKey];
+    if (!container)
+        container.reset(new SharedPrimitivesGroupsContainer());
+    return *container;
 }
 
-const OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer& OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroups(const ZoomLevel zoom) const
+const OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer* OsmAnd::MapPrimitiviser::Cache::findPrimitivesGroups(
+    const ZoomLevel zoom,
+    const PointD scaleDivisor31ToPixel) const
 {
-    return _sharedPrimitivesGroups[zoom];
+    QReadLocker scopedLocker(&_sharedPrimitivesGroupsLock);
+
+    const auto citContainer = _sharedPrimitivesGroups[zoom].constFind(
+        ScaleKey(scaleDivisor31ToPixel.x, scaleDivisor31ToPixel.y));
+    if (citContainer == _sharedPrimitivesGroups[zoom].cend())
+        return nullptr;
+    return citContainer->get();
 }
 
 OsmAnd::MapPrimitiviser::Cache::SharedSymbolsGroupsContainer& OsmAnd::MapPrimitiviser::Cache::getSymbolsGroups(const ZoomLevel zoom)
@@ -371,14 +404,11 @@ const OsmAnd::MapPrimitiviser::Cache::SharedSymbolsGroupsContainer& OsmAnd::MapP
     return _sharedSymbolsGroups[zoom];
 }
 
-OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer* OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroupsPtr(const ZoomLevel zoom)
-{
-    return &getPrimitivesGroups(zoom);
-}
-
-const OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer* OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroupsPtr(const ZoomLevel zoom) const
+OsmAnd::MapPrimitiviser::Cache::SharedPrimitivesGroupsContainer* OsmAnd::MapPrimitiviser::Cache::getPrimitivesGroupsPtr(
+    const ZoomLevel zoom,
+    const PointD scaleDivisor31ToPixel)
 {
-    return &getPrimitivesGroups(zoom);
+    return &getPrimitivesGroups(zoom, scaleDivisor31ToPixel);
 }
 
 OsmAnd::MapPrimitiviser::Cache::SharedSymbolsGroupsContainer* OsmAnd::MapPrimitiviser::Cache::getSymbolsGroupsPtr(const ZoomLevel zoom)
@@ -391,6 +421,135 @@ const OsmAnd::MapPrimitiviser::Cache::SharedSymbolsGroupsContainer* OsmAnd::MapP
     return &getSymbolsGroups(zoom);
 }
 
+bool OsmAnd::MapPrimitiviser::Cache::obtainCoastlineParts(
+    const std::shared_ptr<const MapObject>& coastline,
+    const TileId blockId,
+    const ZoomLevel blockZoom,
+    CoastlineParts& outParts) const
+{
+    QReadLocker scopedLocker(&_coastlinesPartsLock);
+
+    const auto& coastlinesParts = _coastlinesParts[blockZoom];
+    const auto citCachedCoastline = coastlinesParts.constFind(coastline.get());
+    if (citCachedCoastline == coastlinesParts.cend())
+        return false;
+    const auto& cachedCoastline = *citCachedCoastline;
+
+    // Address of coastline may have been reused by another object, if cached one was already destroyed
+    if (cachedCoastline.coastline.lock() != coastline)
+        return false;
+
+    const auto citParts = cachedCoastline.partsInBlocks.constFind(blockId);
+    if (citParts == cachedCoastline.partsInBlocks.cend())
+        return false;
+
+    outParts = *citParts;
+    return true;
+}
+
+void OsmAnd::MapPrimitiviser::Cache::storeCoastlineParts(
+    const std::shared_ptr<const MapObject>& coastline,
+    const TileId blockId,
+    const ZoomLevel blockZoom,
+    const CoastlineParts& parts)
+{
+    QWriteLocker scopedLocker(&_coastlinesPartsLock);
+
+    auto& cachedCoastline = _coastlinesParts[blockZoom][coastline.get()];
+    if (cachedCoastline.coastline.lock() != coastline)
+    {
+        for (const auto& cachedParts : constOf(cachedCoastline.partsInBlocks))
+            _coastlinesPartsPointsCount -= getPointsCount(cachedParts);
+        cachedCoastline.coastline = coastline;
+        cachedCoastline.partsInBlocks.clear();
+    }
+    const auto itParts = cachedCoastline.partsInBlocks.find(blockId);
+    if (itParts != cachedCoastline.partsInBlocks.end())
+    {
+        _coastlinesPartsPointsCount -= getPointsCount(*itParts);
+        *itParts = parts;
+    }
+    else
+    {
+        cachedCoastline.partsInBlocks.insert(blockId, parts);
+
+        CoastlinePartsKey key;
+        key.blockZoom = blockZoom;
+        key.coastline = coastline.get();
+        key.blockId = blockId;
+        _coastlinesPartsStoreOrder.push_back(key);
+    }
+    _coastlinesPartsPointsCount += getPointsCount(parts);
+
+    // Periodically remove parts of coastlines that are no longer alive
+    if (++_coastlinesPartsStoredSincePurge >= 1024u)
+    {
+        purgeExpiredCoastlinesParts();
+        _coastlinesPartsStoredSincePurge = 0;
+    }
+
+    while (_coastlinesPartsPointsCount > MaxCoastlinesPartsPointsCount && !_coastlinesPartsStoreOrder.isEmpty())
+        evictEarliestCoastlineParts();
+}
+
+void OsmAnd::MapPrimitiviser::Cache::purgeExpiredCoastlinesParts()
+{
+    for (auto& coastlinesParts : _coastlinesParts)
+    {
+        auto itCachedCoastline = mutableIteratorOf(coastlinesParts);
+        while (itCachedCoastline.hasNext())
+        {
+            const auto& cachedCoastline = itCachedCoastline.next().value();
+            if (!cachedCoastline.coastline.expired())
+                continue;
+
+            for (const auto& cachedParts : constOf(cachedCoastline.partsInBlocks))
+                _coastlinesPartsPointsCount -= getPointsCount(cachedParts);
+            itCachedCoastline.remove();
+        }
+    }
+
+    // Order of storing is kept only for parts that are still cached
+    QList<CoastlinePartsKey> coastlinesPartsStoreOrder;
+    coastlinesPartsStoreOrder.reserve(_coastlinesPartsStoreOrder.size());
+    for (const auto& key : constOf(_coastlinesPartsStoreOrder))
+    {
+        const auto& coastlinesParts = _coastlinesParts[key.blockZoom];
+        const auto citCachedCoastline = coastlinesParts.constFind(key.coastline);
+        if (citCachedCoastline != coastlinesParts.cend() && citCachedCoastline->partsInBlocks.contains(key.blockId))
+            coastlinesPartsStoreOrder.push_back(key);
+    }
+    _coastlinesPartsStoreOrder = qMove(coastlinesPartsStoreOrder);
+}
+
+void OsmAnd::MapPrimitiviser::Cache::evictEarliestCoastlineParts()
+{
+    const auto key = _coastlinesPartsStoreOrder.takeFirst();
+
+    auto& coastlinesParts = _coastlinesParts[key.blockZoom];
+    const auto itCachedCoastline = coastlinesParts.find(key.coastline);
+    if (itCachedCoastline == coastlinesParts.end())
+        return;
+    auto& partsInBlocks = itCachedCoastline->partsInBlocks;
+
+    const auto itParts = partsInBlocks.find(key.blockId);
+    if (itParts != partsInBlocks.end())
+    {
+        _coastlinesPartsPointsCount -= getPointsCount(*itParts);
+        partsInBlocks.erase(itParts);
+    }
+    if (partsInBlocks.isEmpty())
+        coastlinesParts.erase(itCachedCoastline);
+}
+
+size_t OsmAnd::MapPrimitiviser::Cache::getPointsCount(const CoastlineParts& parts)
+{
+    size_t pointsCount = 0;
+    for (const auto& part : constOf(parts))
+        pointsCount += part.size();
+    return pointsCount;
+}
+
 OsmAnd::MapPrimitiviser::PrimitivisedObjects::PrimitivisedObjects(
     const std::shared_ptr<const MapPresentationEnvironment>& mapPresentationEnvironment_,
     const std::shared_ptr<Cache>& cache_,
@@ -411,7 +570,7 @@ OsmAnd::MapPrimitiviser::PrimitivisedObjects::~PrimitivisedObjects()
     // that are owned only current context
     if (cache)
     {
-        auto& sharedGroups = cache->getPrimitivesGroups(zoom);
+        auto& sharedGroups = cache->getPrimitivesGroups(zoom, scaleDivisor31ToPixel);
         for (auto& group : primitivesGroups)
         {
             MapObject::SharingKey sharingKey;
@@ -23,7 +23,8 @@
 #include "Logging.h"
 
 OsmAnd::MapPrimitiviser_P::MapPrimitiviser_P(MapPrimitiviser* const owner_)
-    : owner(owner_)
+    : _coastlinesCache(new Cache())
+    , owner(owner_)
 {
 }
 
@@ -176,6 +177,9 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
 
     const Stopwatch polygonizeCoastlinesStopwatch(metric != nullptr);
 
+    // Parts of coastlines are worth caching even if caller doesn't provide a cache
+    const auto& coastlinesCache = cache ? cache : _coastlinesCache;
+
     // Polygonize coastlines
     auto surfaceType = surfaceType_;
     const auto basemapCoastlinesPresent = !basemapCoastlineObjects.isEmpty();
@@ -192,7 +196,9 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
             detailedmapCoastlineObjects,
             polygonizedCoastlineObjects,
             basemapCoastlinesPresent,
-            true);
+            true,
+            coastlinesCache,
+            metric);
         fillEntireArea = !coastlinesWereAdded && fillEntireArea;
         addBasemapCoastlines = (!coastlinesWereAdded && !detailedLandDataPresent) || zoom <= static_cast<ZoomLevel>(MapPrimitiviser::LastZoomToUseBasemap);
     }
@@ -209,7 +215,9 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
             basemapCoastlineObjects,
             polygonizedCoastlineObjects,
             false,
-            true);
+            true,
+            coastlinesCache,
+            metric);
         fillEntireArea = !coastlinesWereAdded && fillEntireArea;
     }
 
@@ -483,6 +491,34 @@ OsmAnd::AreaI OsmAnd::MapPrimitiviser_P::alignAreaForCoastlines(const AreaI& are
     return alignedArea31;
 }
 
+bool OsmAnd::MapPrimitiviser_P::obtainCoastlinesBlock(
+    const AreaI area31,
+    const ZoomLevel zoom,
+    TileId& outBlockId,
+    ZoomLevel& outBlockZoom,
+    AreaI& outBlockArea31)
+{
+    // Block is always at least one zoom level coarser than the tile, and it's the same for
+    // CoastlinesBlockZoomStep zoom levels, so that parts of coastlines are shared across them
+    if (zoom <= static_cast<ZoomLevel>(CoastlinesBlockZoomStep))
+        return false;
+    const auto blockZoom = static_cast<ZoomLevel>((zoom - 1) - ((zoom - 1) % CoastlinesBlockZoomStep));
+    if (blockZoom <= ZoomLevel0)
+        return false;
+
+    const auto zoomShift = ZoomLevel31 - blockZoom;
+    const auto center31 = area31.center();
+    const auto blockId = TileId::fromXY(center31.x >> zoomShift, center31.y >> zoomShift);
+    const auto blockArea31 = Utilities::tileBoundingBox31(blockId, blockZoom);
+    if (!blockArea31.contains(area31))
+        return false;
+
+    outBlockId = blockId;
+    outBlockZoom = blockZoom;
+    outBlockArea31 = blockArea31;
+    return true;
+}
+
 bool OsmAnd::MapPrimitiviser_P::polygonizeCoastlines(
     const AreaI area31,
     const ZoomLevel zoom,
@@ -490,15 +526,22 @@ bool OsmAnd::MapPrimitiviser_P::polygonizeCoastlines(
     const QList< std::shared_ptr<const MapObject> >& coastlines,
     QList< std::shared_ptr<const MapObject> >& outVectorized,
     bool abortIfBrokenCoastlinesExist,
-    bool includeBrokenCoastlines)
+    bool includeBrokenCoastlines,
+    const std::shared_ptr<Cache>& cache,
+    MapPrimitiviser_Metrics::Metric_primitiviseWithSurface* const metric)
 {
     QList< QVector< PointI > > closedPolygons;
     QList< QVector< PointI > > coastlinePolylines; // Broken == not closed in this case
 
-    // Align area to 32: this fixes coastlines and specifically Antarctica
-    const auto alignedArea31 = alignAreaForCoastlines(area31);
+    // Coastlines are first split by block that contains this area. Those parts are cached and shared with
+    // other tiles inside the same block, so only (much shorter) parts have to be split by this area
+    TileId blockId;
+    ZoomLevel blockZoom;
+    AreaI blockArea31;
+    const auto useBlocks = cache && obtainCoastlinesBlock(area31, zoom, blockId, blockZoom, blockArea31);
 
-    QVector< PointI > linePoints31;
+    Cache::CoastlineParts blockParts;
+    QList< QVector< PointI > > parts;
     for (const auto& coastline : constOf(coastlines))
     {
         if (coastline->points31.size() < 2)
@@ -510,33 +553,42 @@ bool OsmAnd::MapPrimitiviser_P::polygonizeCoastlines(
             continue;
         }
 
-        linePoints31.clear();
-        auto itPoint = coastline->points31.cbegin();
-        auto pp = *itPoint;
-        auto cp = pp;
-        auto prevInside = alignedArea31.contains(cp);
-        if (prevInside)
-            linePoints31.push_back(cp);
-        const auto itEnd = coastline->points31.cend();
-        for (++itPoint; itPoint != itEnd; ++itPoint)
+        parts.clear();
+        if (useBlocks)
         {
-            cp = *itPoint;
-
-            const auto inside = alignedArea31.contains(cp);
-            const auto lineEnded = buildCoastlinePolygonSegment(area31, inside, cp, prevInside, pp, linePoints31);
-            if (lineEnded)
+            blockParts.clear();
+            if (cache->obtainCoastlineParts(coastline, blockId, blockZoom, blockParts))
             {
-                appendCoastlinePolygons(closedPolygons, coastlinePolylines, linePoints31);
+                if (metric)
+                    metric->coastlinesPartsCacheHits++;
+            }
+            else
+            {
+                splitCoastlineByArea(blockArea31, coastline->points31, blockParts);
+
+                // Parts that degenerated to single vertex are useless
+                auto itPart = mutableIteratorOf(blockParts);
+                while (itPart.hasNext())
+                {
+                    if (itPart.next().size() < 2)
+                        itPart.remove();
+                }
 
-                // Create new line if it goes outside
-                linePoints31.clear();
+                cache->storeCoastlineParts(coastline, blockId, blockZoom, blockParts);
+                if (metric)
+                    metric->coastlinesPartsCacheMisses++;
             }
 
-            pp = cp;
-            prevInside = inside;
+            for (const auto& blockPart : constOf(blockParts))
+                splitCoastlineByArea(area31, blockPart, parts);
+        }
+        else
+        {
+            splitCoastlineByArea(area31, coastline->points31, parts);
         }
 
-        appendCoastlinePolygons(closedPolygons, coastlinePolylines, linePoints31);
+        for (auto& part : parts)
+            appendCoastlinePolygons(closedPolygons, coastlinePolylines, part);
     }
 
     if (closedPolygons.isEmpty() && coastlinePolylines.isEmpty())
@@ -667,6 +719,45 @@ bool OsmAnd::MapPrimitiviser_P::polygonizeCoastlines(
     return true;
 }
 
+void OsmAnd::MapPrimitiviser_P::splitCoastlineByArea(
+    const AreaI area31,
+    const QVector< PointI >& points31,
+    QList< QVector< PointI > >& outParts)
+{
+    // Align area to 32: this fixes coastlines and specifically Antarctica
+    const auto alignedArea31 = alignAreaForCoastlines(area31);
+
+    QVector< PointI > linePoints31;
+    auto itPoint = points31.cbegin();
+    auto pp = *itPoint;
+    auto cp = pp;
+    auto prevInside = alignedArea31.contains(cp);
+    if (prevInside)
+        linePoints31.push_back(cp);
+    const auto itEnd = points31.cend();
+    for (++itPoint; itPoint != itEnd; ++itPoint)
+    {
+        cp = *itPoint;
+
+        const auto inside = alignedArea31.contains(cp);
+        const auto lineEnded = buildCoastlinePolygonSegment(area31, inside, cp, prevInside, pp, linePoints31);
+        if (lineEnded)
+        {
+            if (!linePoints31.isEmpty())
+                outParts.push_back(linePoints31);
+
+            // Create new line if it goes outside
+            linePoints31.clear();
+        }
+
+        pp = cp;
+        prevInside = inside;
+    }
+
+    if (!linePoints31.isEmpty())
+        outParts.push_back(qMove(linePoints31));
+}
+
 bool OsmAnd::MapPrimitiviser_P::buildCoastlinePolygonSegment(
     const AreaI area31,
     bool currentInside,
@@ -1150,7 +1241,9 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
     pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
     pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
 
-    const auto pSharedPrimitivesGroups = cache ? cache->getPrimitivesGroupsPtr(zoom) : nullptr;
+    const auto pSharedPrimitivesGroups = cache
+        ? cache->getPrimitivesGroupsPtr(zoom, primitivisedObjects->scaleDivisor31ToPixel)
+        : nullptr;
     QList< proper::shared_future< std::shared_ptr<const PrimitivesGroup> > > futureSharedPrimitivesGroups;
     for (const auto& mapObject : constOf(source))
     {
@@ -1264,6 +1357,30 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     //    return group;
     //////////////////////////////////////////////////////////////////////////
 
+    // Geometry simplified for current zoom is computed only once per group, and only if needed
+    auto geometrySimplified = false;
+    QVector< PointI > simplifiedPoints31;
+    QList< QVector< PointI > > simplifiedInnerPolygonsPoints31;
+    const auto obtainSimplifiedGeometry =
+        [&context, &primitivisedObjects, &mapObject, &geometrySimplified, &simplifiedPoints31, &simplifiedInnerPolygonsPoints31, metric]
+        (const std::shared_ptr<Primitive>& primitive)
+        {
+            if (!geometrySimplified)
+            {
+                simplifyPrimitivesGroupGeometry(
+                    context,
+                    primitivisedObjects,
+                    mapObject,
+                    simplifiedPoints31,
+                    simplifiedInnerPolygonsPoints31,
+                    metric);
+                geometrySimplified = true;
+            }
+
+            primitive->points31 = simplifiedPoints31;
+            primitive->innerPolygonsPoints31 = simplifiedInnerPolygonsPoints31;
+        };
+
     uint32_t typeRuleIdIndex = 0;
     const auto& decRules = mapObject->encodingDecodingRules->decodingRules;
     for (auto itTypeRuleId = cachingIteratorOf(constOf(mapObject->typesRuleIds)); itTypeRuleId; ++itTypeRuleId, typeRuleIdIndex++)
@@ -1412,6 +1529,7 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
                     ? std::numeric_limits<int>::min()
                     : zOrder;
                 primitive->doubledArea = doubledPolygonArea31;
+                obtainSimplifiedGeometry(primitive);
 
                 // Accept this primitive
                 constructedGroup->polygons.push_back(qMove(primitive));
@@ -1521,6 +1639,7 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
                 typeRuleIdIndex,
                 qMove(evaluationResult)));
             primitive->zOrder = zOrder;
+            obtainSimplifiedGeometry(primitive);
 
             // Accept this primitive
             constructedGroup->polylines.push_back(qMove(primitive));
@@ -1609,6 +1728,70 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     return group;
 }
 
+void OsmAnd::MapPrimitiviser_P::simplifyPrimitivesGroupGeometry(
+    const Context& context,
+    const std::shared_ptr<const PrimitivisedObjects>& primitivisedObjects,
+    const std::shared_ptr<const MapObject>& mapObject,
+    QVector< PointI >& outPoints31,
+    QList< QVector< PointI > >& outInnerPolygonsPoints31,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    // By default, geometry of map object is used as-is
+    outPoints31 = mapObject->points31;
+    outInnerPolygonsPoints31 = mapObject->innerPolygonsPoints31;
+
+    // Simplification is possible only if it's known how 31-coordinates map to pixels
+    const auto& scaleDivisor31ToPixel = primitivisedObjects->scaleDivisor31ToPixel;
+    if (scaleDivisor31ToPixel.x <= 0.0 || scaleDivisor31ToPixel.y <= 0.0 || context.geometrySimplificationTolerance <= 0.0f)
+        return;
+
+    const Stopwatch simplificationStopwatch(metric != nullptr);
+
+    const auto tolerance31 = context.geometrySimplificationTolerance * qMin(scaleDivisor31ToPixel.x, scaleDivisor31ToPixel.y);
+    const auto isClosed = mapObject->isClosedFigure();
+    auto verticesBefore = mapObject->points31.size();
+    auto verticesAfter = mapObject->points31.size();
+
+    // Closed figure needs at least 4 vertices (3 + closing one), otherwise keep original
+    QVector< PointI > simplifiedPoints31;
+    if (Utilities::simplifyPolyline(mapObject->points31, tolerance31, simplifiedPoints31) &&
+        simplifiedPoints31.size() >= (isClosed ? 4 : 2))
+    {
+        verticesAfter = simplifiedPoints31.size();
+        outPoints31 = qMove(simplifiedPoints31);
+    }
+
+    // Inner polygons that collapsed during simplification are less than a pixel, so they are dropped
+    if (!mapObject->innerPolygonsPoints31.isEmpty())
+    {
+        outInnerPolygonsPoints31.clear();
+        for (const auto& innerPolygon : constOf(mapObject->innerPolygonsPoints31))
+        {
+            verticesBefore += innerPolygon.size();
+
+            QVector< PointI > simplifiedInnerPolygon;
+            if (!Utilities::simplifyPolyline(innerPolygon, tolerance31, simplifiedInnerPolygon))
+            {
+                verticesAfter += innerPolygon.size();
+                outInnerPolygonsPoints31.push_back(innerPolygon);
+                continue;
+            }
+            if (simplifiedInnerPolygon.size() < 4)
+                continue;
+
+            verticesAfter += simplifiedInnerPolygon.size();
+            outInnerPolygonsPoints31.push_back(qMove(simplifiedInnerPolygon));
+        }
+    }
+
+    if (metric)
+    {
+        metric->elapsedTimeForSimplifyingGeometry += simplificationStopwatch.elapsed();
+        metric->verticesBeforeSimplification += verticesBefore;
+        metric->verticesAfterSimplification += verticesAfter;
+    }
+}
+
 void OsmAnd::MapPrimitiviser_P::sortAndFilterPrimitives(
     const Context& context,
     const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects)
@@ -1659,45 +1842,116 @@ void OsmAnd::MapPrimitiviser_P::filterOutHighwaysByDensity(
         return;
 
     const auto dZ = primitivisedObjects->zoom + context.roadDensityZoomTile;
-    QHash< uint64_t, std::pair<uint32_t, double> > densityMap;
+    const auto cellShift = 31 - dZ;
+    auto& polylines = primitivisedObjects->polylines;
+    const auto polylinesCount = polylines.size();
+
+    const auto isHighway =
+        []
+        (const std::shared_ptr<const Primitive>& line) -> bool
+        {
+            const auto& sourceObject = line->sourceObject;
+            return sourceObject->typesRuleIds[line->typeRuleIdIndex] == sourceObject->encodingDecodingRules->highway_encodingRuleId;
+        };
+
+    // Find cells that are touched by highways, to allocate density grid that covers them
+    AreaI cellsBBox(
+        std::numeric_limits<int32_t>::max(),
+        std::numeric_limits<int32_t>::max(),
+        std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::min());
+    auto highwaysCount = 0;
+    for (const auto& line : constOf(polylines))
+    {
+        if (!isHighway(line))
+            continue;
+        highwaysCount++;
+
+        const auto pointsCount = line->sourceObject->points31.size();
+        auto pPoint = line->sourceObject->points31.constData();
+        for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+            cellsBBox.enlargeToInclude(PointI(pPoint->x >> cellShift, pPoint->y >> cellShift));
+    }
+    if (highwaysCount == 0)
+        return;
 
-    auto itLine = mutableIteratorOf(primitivisedObjects->polylines);
-    itLine.toBack();
-    while (itLine.hasPrevious())
+    // Sub-tiles count is known from roadDensityZoomTile, yet highways may go far beyond the tile. So grid is limited
+    // in size and the rare cells outside of it are counted separately
+    AreaI gridBBox = cellsBBox;
+    if (gridBBox.width() >= MaxDensityGridSize)
+    {
+        gridBBox.left() = cellsBBox.left() + (cellsBBox.width() - MaxDensityGridSize) / 2;
+        gridBBox.right() = gridBBox.left() + MaxDensityGridSize - 1;
+    }
+    if (gridBBox.height() >= MaxDensityGridSize)
     {
-        const auto& line = itLine.previous();
+        gridBBox.top() = cellsBBox.top() + (cellsBBox.height() - MaxDensityGridSize) / 2;
+        gridBBox.bottom() = gridBBox.top() + MaxDensityGridSize - 1;
+    }
+    const auto gridWidth = gridBBox.width() + 1;
+    const auto gridHeight = gridBBox.height() + 1;
+    QVector<uint32_t> densityGrid(gridWidth * gridHeight, 0u);
+    const auto pDensityGrid = densityGrid.data();
+    QHash<uint64_t, uint32_t> outOfGridDensity;
+    const auto obtainDensity =
+        [dZ, gridBBox, gridWidth, pDensityGrid, &outOfGridDensity]
+        (const int32_t x, const int32_t y) -> uint32_t&
+        {
+            if (gridBBox.contains(x, y))
+                return pDensityGrid[(y - gridBBox.top()) * gridWidth + (x - gridBBox.left())];
+
+            return outOfGridDensity[(static_cast<uint64_t>(x) << dZ) | y];
+        };
+
+    // Lines are processed from the last one, since those are drawn on top
+    QVector<bool> acceptedLines(polylinesCount, true);
+    auto rejectedLinesCount = 0;
+    for (auto lineIdx = polylinesCount - 1; lineIdx >= 0; lineIdx--)
+    {
+        const auto& line = polylines[lineIdx];
+        if (!isHighway(line))
+            continue;
 
-        auto accept = true;
-        if (line->sourceObject->typesRuleIds[line->typeRuleIdIndex] == line->sourceObject->encodingDecodingRules->highway_encodingRuleId)
+        auto accept = false;
+        auto prevX = std::numeric_limits<int32_t>::min();
+        auto prevY = std::numeric_limits<int32_t>::min();
+        const auto pointsCount = line->sourceObject->points31.size();
+        auto pPoint = line->sourceObject->points31.constData();
+        for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
         {
-            accept = false;
+            const auto x = pPoint->x >> cellShift;
+            const auto y = pPoint->y >> cellShift;
+            if (x == prevX && y == prevY)
+                continue;
+            prevX = x;
+            prevY = y;
 
-            uint64_t prevId = 0;
-            const auto pointsCount = line->sourceObject->points31.size();
-            auto pPoint = line->sourceObject->points31.constData();
-            for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+            auto& density = obtainDensity(x, y);
+            if (density < context.roadsDensityLimitPerTile)
             {
-                auto x = pPoint->x >> (31 - dZ);
-                auto y = pPoint->y >> (31 - dZ);
-                uint64_t id = (static_cast<uint64_t>(x) << dZ) | y;
-                if (prevId != id)
-                {
-                    prevId = id;
-
-                    auto& mapEntry = densityMap[id];
-                    if (mapEntry.first < context.roadsDensityLimitPerTile /*&& p.second > o */)
-                    {
-                        accept = true;
-                        mapEntry.first += 1;
-                        mapEntry.second = line->zOrder;
-                    }
-                }
+                accept = true;
+                density++;
             }
         }
 
         if (!accept)
-            itLine.remove();
+        {
+            acceptedLines[lineIdx] = false;
+            rejectedLinesCount++;
+        }
     }
+    if (rejectedLinesCount == 0)
+        return;
+
+    // Compact accepted lines in a single pass, instead of removing rejected ones one by one
+    PrimitivesCollection filteredPolylines;
+    filteredPolylines.reserve(polylinesCount - rejectedLinesCount);
+    for (auto lineIdx = 0; lineIdx < polylinesCount; lineIdx++)
+    {
+        if (acceptedLines[lineIdx])
+            filteredPolylines.push_back(polylines[lineIdx]);
+    }
+    polylines = qMove(filteredPolylines);
 }
 
 void OsmAnd::MapPrimitiviser_P::obtainPrimitivesSymbols(
@@ -2517,4 +2771,7 @@ OsmAnd::MapPrimitiviser_P::Context::Context(
     roadDensityZoomTile = env->getRoadDensityZoomTile(zoom);
     roadsDensityLimitPerTile = env->getRoadsDensityLimitPerTile(zoom);
     env->obtainDefaultPathPadding(defaultPathPaddingLeft, defaultPathPaddingRight);
+
+    // Vertices that deviate less than half a pixel from simplified geometry are not visible anyways
+    geometrySimplificationTolerance = 0.5f;
 }
@@ -42,6 +42,8 @@ namespace OsmAnd
     protected:
         MapPrimitiviser_P(MapPrimitiviser* const owner);
 
+        const std::shared_ptr<Cache> _coastlinesCache;
+
         enum class PrimitivesType
         {
             Polygons,
@@ -64,13 +66,29 @@ namespace OsmAnd
             unsigned int roadsDensityLimitPerTile;
             float defaultPathPaddingLeft;
             float defaultPathPaddingRight;
+            float geometrySimplificationTolerance;
 
         private:
             Q_DISABLE_COPY_AND_MOVE(Context);
         };
 
+        enum {
+            // Coastlines are split by blocks of this many zoom levels coarser than tile at most
+            CoastlinesBlockZoomStep = 3,
+
+            // Maximal width and height (in cells) of grid used to filter out highways by density
+            MaxDensityGridSize = 128,
+        };
+
         static AreaI alignAreaForCoastlines(const AreaI& area31);
 
+        static bool obtainCoastlinesBlock(
+            const AreaI area31,
+            const ZoomLevel zoom,
+            TileId& outBlockId,
+            ZoomLevel& outBlockZoom,
+            AreaI& outBlockArea31);
+
         static bool polygonizeCoastlines(
             const AreaI area31,
             const ZoomLevel zoom,
@@ -78,7 +96,14 @@ namespace OsmAnd
             const QList< std::shared_ptr<const MapObject> >& coastlines,
             QList< std::shared_ptr<const MapObject> >& outVectorized,
             bool abortIfBrokenCoastlinesExist,
-            bool includeBrokenCoastlines);
+            bool includeBrokenCoastlines,
+            const std::shared_ptr<Cache>& cache,
+            MapPrimitiviser_Metrics::Metric_primitiviseWithSurface* const metric);
+
+        static void splitCoastlineByArea(
+            const AreaI area31,
+            const QVector< PointI >& points31,
+            QList< QVector< PointI > >& outParts);
 
         static bool buildCoastlinePolygonSegment(
             const AreaI area31,
@@ -134,6 +159,14 @@ namespace OsmAnd
             MapStyleEvaluator& pointEvaluator,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
+        static void simplifyPrimitivesGroupGeometry(
+            const Context& context,
+            const std::shared_ptr<const PrimitivisedObjects>& primitivisedObjects,
+            const std::shared_ptr<const MapObject>& mapObject,
+            QVector< PointI >& outPoints31,
+            QList< QVector< PointI > >& outInnerPolygonsPoints31,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
         static void sortAndFilterPrimitives(
             const Context& context,
             const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects);
@@ -67,6 +67,20 @@ bool OsmAnd::MapRasterLayerProvider::obtainData(
     return _p->obtainData(tileId, zoom, outTiledData, metric, queryController);
 }
 
+bool OsmAnd::MapRasterLayerProvider::isDataCached(const TileId tileId, const ZoomLevel zoom) const
+{
+    return _p->isDataCached(tileId, zoom);
+}
+
+bool OsmAnd::MapRasterLayerProvider::obtainDerivedData(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    std::shared_ptr<Data>& outTiledData,
+    const IQueryController* const queryController /*= nullptr*/)
+{
+    return _p->obtainDerivedData(tileId, zoom, outTiledData, queryController);
+}
+
 OsmAnd::ZoomLevel OsmAnd::MapRasterLayerProvider::getMinZoom() const
 {
     return _p->getMinZoom();
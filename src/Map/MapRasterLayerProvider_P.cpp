@@ -81,6 +81,39 @@ bool OsmAnd::MapRasterLayerProvider_P::obtainData(
     return true;
 }
 
+bool OsmAnd::MapRasterLayerProvider_P::isDataCached(const TileId tileId, const ZoomLevel zoom) const
+{
+    return false;
+}
+
+bool OsmAnd::MapRasterLayerProvider_P::obtainDerivedData(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData,
+    const IQueryController* const queryController)
+{
+    // Derived tile without primitives is not worth showing instead of actual one
+    std::shared_ptr<MapPrimitivesProvider::Data> primitivesTile;
+    if (!owner->primitivesProvider->obtainDerivedData(tileId, zoom, primitivesTile) ||
+        primitivesTile->primitivisedObjects->isEmpty())
+    {
+        return false;
+    }
+
+    const auto bitmap = rasterize(tileId, zoom, primitivesTile, nullptr, queryController);
+    if (!bitmap)
+        return false;
+
+    outTiledData.reset(new MapRasterLayerProvider::Data(
+        tileId,
+        zoom,
+        AlphaChannelPresence::NotPresent,
+        owner->getTileDensityFactor(),
+        bitmap,
+        primitivesTile));
+    return true;
+}
+
 OsmAnd::MapRasterLayerProvider_P::RetainableCacheMetadata::RetainableCacheMetadata(
     const std::shared_ptr<const IMapDataProvider::RetainableCacheMetadata>& binaryMapPrimitivesRetainableCacheMetadata_)
     : binaryMapPrimitivesRetainableCacheMetadata(binaryMapPrimitivesRetainableCacheMetadata_)
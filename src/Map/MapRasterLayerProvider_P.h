@@ -50,13 +50,21 @@ namespace OsmAnd
 
         ImplementationInterface<MapRasterLayerProvider> owner;
 
-        bool obtainData(
+        virtual bool obtainData(
             const TileId tileId,
             const ZoomLevel zoom,
             std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData,
             MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
             const IQueryController* const queryController);
 
+        virtual bool isDataCached(const TileId tileId, const ZoomLevel zoom) const;
+
+        bool obtainDerivedData(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData,
+            const IQueryController* const queryController);
+
         ZoomLevel getMinZoom() const;
         ZoomLevel getMaxZoom() const;
 
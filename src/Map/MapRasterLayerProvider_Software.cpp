@@ -1,10 +1,20 @@
 #include "MapRasterLayerProvider_Software.h"
 #include "MapRasterLayerProvider_Software_P.h"
 
+#include "RasterTilesDiskCache.h"
+
 OsmAnd::MapRasterLayerProvider_Software::MapRasterLayerProvider_Software(
     const std::shared_ptr<MapPrimitivesProvider>& primitivesProvider_,
-    const bool fillBackground_ /*= true*/)
+    const bool fillBackground_ /*= true*/,
+    const unsigned int metatileSize_ /*= 1*/,
+    const unsigned int rasterizationBandsCount_ /*= 1*/,
+    const bool limitColorDepthBy16bits_ /*= false*/,
+    const std::shared_ptr<RasterTilesDiskCache>& diskCache_ /*= nullptr*/)
     : MapRasterLayerProvider(new MapRasterLayerProvider_Software_P(this), primitivesProvider_, fillBackground_)
+    , metatileSize(metatileSize_)
+    , rasterizationBandsCount(rasterizationBandsCount_)
+    , limitColorDepthBy16bits(limitColorDepthBy16bits_)
+    , diskCache(diskCache_)
 {
 }
 
@@ -6,6 +6,10 @@
 #   define OSMAND_PERFORMANCE_METRICS 0
 #endif // !defined(OSMAND_PERFORMANCE_METRICS)
 
+#include "QtExtensions.h"
+#include <QSet>
+#include <QStringList>
+
 #include "ignore_warnings_on_external_includes.h"
 #include <SkStream.h>
 #include <SkBitmap.h>
@@ -16,6 +20,13 @@
 #include "restore_internal_warnings.h"
 
 #include "MapPrimitivesProvider.h"
+#include "MapPrimitiviser.h"
+#include "MapPrimitiviser_Metrics.h"
+#include "IMapObjectsProvider.h"
+#include "ObfMapObjectsProvider.h"
+#include "IObfsCollection.h"
+#include "RasterTilesDiskCache.h"
+#include "QKeyValueIterator.h"
 #include "ObfsCollection.h"
 #include "ObfDataInterface.h"
 #include "MapRasterizer.h"
@@ -26,6 +37,7 @@
 
 OsmAnd::MapRasterLayerProvider_Software_P::MapRasterLayerProvider_Software_P(MapRasterLayerProvider_Software* owner_)
     : MapRasterLayerProvider_P(owner_)
+    , _surfacesPool(new SurfacesPool())
     , owner(owner_)
 {
 }
@@ -34,6 +46,451 @@ OsmAnd::MapRasterLayerProvider_Software_P::~MapRasterLayerProvider_Software_P()
 {
 }
 
+bool OsmAnd::MapRasterLayerProvider_Software_P::obtainData(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData,
+    MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
+    const IQueryController* const queryController)
+{
+    // Check if this tile was already rasterized earlier with exactly same data and settings
+    const auto& diskCache = owner->diskCache;
+    QString diskCacheKey;
+    if (diskCache)
+    {
+        diskCacheKey = getDiskCacheKey(tileId, zoom);
+        if (obtainDataFromDiskCache(tileId, zoom, diskCacheKey, outTiledData))
+        {
+            if (metric)
+                metric->diskCacheHits++;
+            return true;
+        }
+        if (metric)
+            metric->diskCacheMisses++;
+    }
+
+    // Metatile requires primitivisation of an area larger than a tile, which is possible only with surface
+    bool ok;
+    if (owner->metatileSize <= 1 || owner->primitivesProvider->mode != MapPrimitivesProvider::Mode::WithSurface)
+        ok = MapRasterLayerProvider_P::obtainData(tileId, zoom, outTiledData, metric, queryController);
+    else
+        ok = obtainDataFromMetatile(tileId, zoom, outTiledData, metric, queryController);
+
+    // Tile that was aborted may be incomplete, so it's not stored
+    if (diskCache && ok && !(queryController && queryController->isAborted()))
+        storeDataToDiskCache(diskCacheKey, outTiledData);
+
+    return ok;
+}
+
+bool OsmAnd::MapRasterLayerProvider_Software_P::isDataCached(const TileId tileId, const ZoomLevel zoom) const
+{
+    const auto& diskCache = owner->diskCache;
+    return diskCache && diskCache->containsEntry(getDiskCacheKey(tileId, zoom));
+}
+
+QString OsmAnd::MapRasterLayerProvider_Software_P::getDiskCacheKey(const TileId tileId, const ZoomLevel zoom) const
+{
+    // Content of tile depends on style and its settings, presentation and rasterization settings and map data
+    std::shared_ptr<const IObfsCollection> obfsCollection;
+    if (const auto obfMapObjectsProvider =
+        std::dynamic_pointer_cast<const ObfMapObjectsProvider>(owner->primitivesProvider->mapObjectsProvider))
+    {
+        obfsCollection = obfMapObjectsProvider->obfsCollection;
+    }
+
+    return _diskCacheFingerprint.getTileKey(
+        tileId,
+        zoom,
+        owner->primitivesProvider->primitiviser->environment,
+        obfsCollection,
+        QString(QLatin1String("raster:%1:%2:%3:%4:%5"))
+            .arg(owner->getTileSize())
+            .arg(owner->getTileDensityFactor())
+            .arg(owner->fillBackground)
+            .arg(owner->limitColorDepthBy16bits)
+            .arg(static_cast<int>(owner->primitivesProvider->mode)));
+}
+
+bool OsmAnd::MapRasterLayerProvider_Software_P::obtainDataFromDiskCache(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    const QString& diskCacheKey,
+    std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData)
+{
+    QByteArray encodedTile;
+    if (!owner->diskCache->obtainEntry(diskCacheKey, encodedTile))
+        return false;
+
+    // Empty entry means that tile has no data
+    if (encodedTile.isEmpty())
+    {
+        outTiledData.reset();
+        return true;
+    }
+
+    const auto tileSize = owner->getTileSize();
+    const std::shared_ptr<SkBitmap> bitmap(new SkBitmap());
+    if (!SkImageDecoder::DecodeMemory(
+        encodedTile.constData(),
+        encodedTile.size(),
+        bitmap.get(),
+        getSurfaceImageInfo(tileSize, tileSize).colorType(),
+        SkImageDecoder::kDecodePixels_Mode))
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to decode cached tile %dx%d@%d",
+            tileId.x,
+            tileId.y,
+            zoom);
+        return false;
+    }
+
+    outTiledData.reset(new MapRasterLayerProvider::Data(
+        tileId,
+        zoom,
+        AlphaChannelPresence::NotPresent,
+        owner->getTileDensityFactor(),
+        bitmap,
+        nullptr));
+    return true;
+}
+
+void OsmAnd::MapRasterLayerProvider_Software_P::storeDataToDiskCache(
+    const QString& diskCacheKey,
+    const std::shared_ptr<const MapRasterLayerProvider::Data>& tiledData)
+{
+    if (!tiledData || !tiledData->bitmap)
+    {
+        owner->diskCache->storeEntry(diskCacheKey, QByteArray());
+        return;
+    }
+
+    const auto encodedTile = SkImageEncoder::EncodeData(*tiledData->bitmap, SkImageEncoder::kPNG_Type, 100);
+    if (!encodedTile)
+        return;
+    owner->diskCache->storeEntry(
+        diskCacheKey,
+        QByteArray(reinterpret_cast<const char*>(encodedTile->data()), static_cast<int>(encodedTile->size())));
+    encodedTile->unref();
+}
+
+bool OsmAnd::MapRasterLayerProvider_Software_P::obtainDataFromMetatile(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData,
+    MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
+    const IQueryController* const queryController)
+{
+    const Stopwatch totalStopwatch(metric != nullptr);
+
+    const auto tilesCount = 1u << static_cast<unsigned int>(zoom);
+    if (static_cast<unsigned int>(tileId.x) >= tilesCount || static_cast<unsigned int>(tileId.y) >= tilesCount)
+    {
+        outTiledData.reset();
+        return true;
+    }
+    const auto metatileSize = static_cast<int32_t>(qMin(owner->metatileSize, tilesCount));
+    const auto metatileId = TileId::fromXY(
+        tileId.x - (tileId.x % metatileSize),
+        tileId.y - (tileId.y % metatileSize));
+
+    // Find metatile that covers this tile, or reserve it for rasterization
+    std::shared_ptr<Metatile> metatile;
+    auto shouldRasterize = false;
+    {
+        QMutexLocker scopedLocker(&_metatilesMutex);
+
+        purgeExpiredMetatiles();
+
+        auto& metatiles = _metatiles[zoom];
+        const auto citMetatile = metatiles.constFind(metatileId);
+        if (citMetatile != metatiles.cend())
+        {
+            metatile = *citMetatile;
+        }
+        else
+        {
+            metatile.reset(new Metatile(metatileId, metatileSize));
+            metatiles.insert(metatileId, metatile);
+            shouldRasterize = true;
+        }
+    }
+
+    if (shouldRasterize)
+    {
+        const auto success = rasterizeMetatile(zoom, metatile, metric, queryController);
+
+        QMutexLocker scopedLocker(&_metatilesMutex);
+
+        // Failed metatile is not kept, yet those who wait for it have to be woken up
+        if (!success)
+        {
+            metatile->tiles.clear();
+            auto& metatiles = _metatiles[zoom];
+            if (metatiles.value(metatileId) == metatile)
+                metatiles.remove(metatileId);
+        }
+        metatile->isReady = true;
+        metatile->readyTime = std::chrono::steady_clock::now();
+        _metatileReadyCondition.wakeAll();
+
+        if (!success)
+            return false;
+    }
+
+    // Take tile from metatile, so that it's released as soon as possible
+    std::shared_ptr<SkBitmap> bitmap;
+    {
+        QMutexLocker scopedLocker(&_metatilesMutex);
+
+        while (!metatile->isReady)
+            _metatileReadyCondition.wait(&_metatilesMutex);
+
+        if (metatile->isEmpty)
+        {
+            outTiledData.reset();
+            return true;
+        }
+
+        const auto tileIndex = (tileId.y - metatileId.y) * metatile->size + (tileId.x - metatileId.x);
+        if (tileIndex < static_cast<unsigned int>(metatile->tiles.size()))
+        {
+            bitmap = qMove(metatile->tiles[tileIndex]);
+            metatile->tiles[tileIndex].reset();
+        }
+
+        if (bitmap && --metatile->tilesLeft == 0)
+        {
+            auto& metatiles = _metatiles[zoom];
+            if (metatiles.value(metatileId) == metatile)
+                metatiles.remove(metatileId);
+        }
+    }
+
+    // In case this tile was already taken from metatile (or metatile has failed), rasterize it separately
+    if (!bitmap)
+        return MapRasterLayerProvider_P::obtainData(tileId, zoom, outTiledData, metric, queryController);
+
+    outTiledData.reset(new MapRasterLayerProvider::Data(
+        tileId,
+        zoom,
+        AlphaChannelPresence::NotPresent,
+        owner->getTileDensityFactor(),
+        bitmap,
+        nullptr));
+
+    if (metric)
+    {
+        metric->elapsedTime += totalStopwatch.elapsed();
+        metric->tilesFromMetatiles++;
+        metric->amortizedElapsedTimePerTile += metatile->amortizedElapsedTimePerTile;
+    }
+
+    return true;
+}
+
+bool OsmAnd::MapRasterLayerProvider_Software_P::rasterizeMetatile(
+    const ZoomLevel zoom,
+    const std::shared_ptr<Metatile>& metatile,
+    MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
+    const IQueryController* const queryController)
+{
+    const Stopwatch metatileStopwatch(true);
+
+    const auto& metatileId = metatile->metatileId;
+    const auto tileSize = owner->getTileSize();
+
+    // Metatile at the edge of the world is cut, since there are no tiles beyond (1 << zoom) - 1
+    const auto tilesCount = 1u << static_cast<unsigned int>(zoom);
+    const auto columnsCount = qMin(metatile->size, tilesCount - static_cast<unsigned int>(metatileId.x));
+    const auto rowsCount = qMin(metatile->size, tilesCount - static_cast<unsigned int>(metatileId.y));
+
+    const auto zoomShift = ZoomLevel31 - zoom;
+    AreaI metatileBBox31;
+    metatileBBox31.top() = metatileId.y << zoomShift;
+    metatileBBox31.left() = metatileId.x << zoomShift;
+    metatileBBox31.bottom() = static_cast<int32_t>((static_cast<int64_t>(metatileId.y + rowsCount) << zoomShift) - 1);
+    metatileBBox31.right() = static_cast<int32_t>((static_cast<int64_t>(metatileId.x + columnsCount) << zoomShift) - 1);
+
+    // Collect map objects from all tiles of metatile. Objects that cross tiles are shared, so they're taken once
+    const auto& mapObjectsProvider = owner->primitivesProvider->mapObjectsProvider;
+    QList< std::shared_ptr<IMapObjectsProvider::Data> > dataTiles;
+    QList< std::shared_ptr<const MapObject> > mapObjects;
+    QSet<const MapObject*> uniqueMapObjects;
+    auto surfaceType = MapSurfaceType::Undefined;
+    for (auto y = 0u; y < rowsCount; y++)
+    {
+        for (auto x = 0u; x < columnsCount; x++)
+        {
+            std::shared_ptr<IMapObjectsProvider::Data> dataTile;
+            mapObjectsProvider->obtainData(
+                TileId::fromXY(metatileId.x + x, metatileId.y + y),
+                zoom,
+                dataTile,
+                nullptr,
+                nullptr);
+            if (!dataTile)
+                continue;
+
+            if (dataTile->tileSurfaceType != MapSurfaceType::Undefined)
+            {
+                if (surfaceType == MapSurfaceType::Undefined)
+                    surfaceType = dataTile->tileSurfaceType;
+                else if (surfaceType != dataTile->tileSurfaceType)
+                    surfaceType = MapSurfaceType::Mixed;
+            }
+
+            for (const auto& mapObject : constOf(dataTile->mapObjects))
+            {
+                if (uniqueMapObjects.contains(mapObject.get()))
+                    continue;
+                uniqueMapObjects.insert(mapObject.get());
+                mapObjects.push_back(mapObject);
+            }
+
+            dataTiles.push_back(qMove(dataTile));
+        }
+    }
+    if (dataTiles.isEmpty())
+    {
+        metatile->isEmpty = true;
+        return true;
+    }
+
+    // Primitivise entire metatile at once. Scale is defined by size of a single tile
+    const auto primitivisedObjects = owner->primitivesProvider->primitiviser->primitiviseWithSurface(
+        metatileBBox31,
+        PointI(tileSize, tileSize),
+        zoom,
+        surfaceType,
+        mapObjects,
+        nullptr,
+        queryController,
+        metric ? metric->findOrAddSubmetricOfType<MapPrimitiviser_Metrics::Metric_primitiviseWithSurface>().get() : nullptr);
+    if (!primitivisedObjects)
+        return false;
+    if (primitivisedObjects->isEmpty())
+    {
+        metatile->isEmpty = true;
+        return true;
+    }
+
+    // Rasterize entire metatile at once
+    SkBitmap metatileSurface;
+    if (!metatileSurface.tryAllocPixels(getSurfaceImageInfo(columnsCount * tileSize, rowsCount * tileSize)))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to allocate buffer for metatile rasterization surface %dx%d",
+            columnsCount * tileSize,
+            rowsCount * tileSize);
+        return false;
+    }
+    rasterizeOnto(metatileSurface, metatileBBox31, primitivisedObjects, metric, queryController);
+    if (queryController && queryController->isAborted())
+        return false;
+
+    // Slice metatile to separate tiles
+    metatile->tiles.resize(metatile->size * metatile->size);
+    for (auto y = 0u; y < rowsCount; y++)
+    {
+        for (auto x = 0u; x < columnsCount; x++)
+        {
+            SkBitmap tileSubset;
+            if (!metatileSurface.extractSubset(&tileSubset, SkIRect::MakeXYWH(x * tileSize, y * tileSize, tileSize, tileSize)))
+                return false;
+
+            const std::shared_ptr<SkBitmap> tileSurface(new SkBitmap());
+            if (!tileSubset.copyTo(tileSurface.get(), metatileSurface.colorType()))
+                return false;
+
+            metatile->tiles[y * metatile->size + x] = tileSurface;
+        }
+    }
+    metatile->tilesLeft = columnsCount * rowsCount;
+
+    const auto elapsedTime = metatileStopwatch.elapsed();
+    metatile->amortizedElapsedTimePerTile = elapsedTime / metatile->tilesLeft;
+    if (metric)
+    {
+        metric->metatilesRasterized++;
+        metric->elapsedTimeForMetatiles += elapsedTime;
+    }
+
+    return true;
+}
+
+void OsmAnd::MapRasterLayerProvider_Software_P::purgeExpiredMetatiles()
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto lifetime = std::chrono::milliseconds(MetatileLifetimeInMilliseconds);
+    for (auto& metatiles : _metatiles)
+    {
+        auto itMetatile = mutableIteratorOf(metatiles);
+        while (itMetatile.hasNext())
+        {
+            const auto& metatile = itMetatile.next().value();
+            if (metatile->isReady && (now - metatile->readyTime) > lifetime)
+                itMetatile.remove();
+        }
+    }
+}
+
+SkImageInfo OsmAnd::MapRasterLayerProvider_Software_P::getSurfaceImageInfo(
+    const unsigned int width,
+    const unsigned int height) const
+{
+    if (!owner->limitColorDepthBy16bits)
+        return SkImageInfo::Make(width, height, SkColorType::kRGBA_8888_SkColorType, SkAlphaType::kUnpremul_SkAlphaType);
+
+    // Same formats are produced by renderer when color depth is limited by 16 bits
+    if (owner->fillBackground)
+        return SkImageInfo::Make(width, height, SkColorType::kRGB_565_SkColorType, SkAlphaType::kOpaque_SkAlphaType);
+    return SkImageInfo::Make(width, height, SkColorType::kARGB_4444_SkColorType, SkAlphaType::kPremul_SkAlphaType);
+}
+
+void OsmAnd::MapRasterLayerProvider_Software_P::rasterizeOnto(
+    SkBitmap& targetBitmap,
+    const AreaI area31,
+    const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+    MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
+    const IQueryController* const queryController)
+{
+    const auto rasterizeMetric = metric
+        ? metric->findOrAddSubmetricOfType<MapRasterizer_Metrics::Metric_rasterize>().get()
+        : nullptr;
+
+    if (owner->rasterizationBandsCount != 1)
+    {
+        if (!owner->fillBackground)
+            targetBitmap.eraseColor(SK_ColorTRANSPARENT);
+        _mapRasterizer->rasterizeInBands(
+            area31,
+            primitivisedObjects,
+            targetBitmap,
+            owner->fillBackground,
+            owner->rasterizationBandsCount,
+            rasterizeMetric,
+            queryController);
+        return;
+    }
+
+    // Create rasterization canvas
+    SkBitmapDevice rasterizationTarget(targetBitmap);
+    SkCanvas canvas(&rasterizationTarget);
+
+    if (!owner->fillBackground)
+        canvas.clear(SK_ColorTRANSPARENT);
+    _mapRasterizer->rasterize(
+        area31,
+        primitivisedObjects,
+        canvas,
+        owner->fillBackground,
+        nullptr,
+        rasterizeMetric,
+        queryController);
+}
+
 std::shared_ptr<SkBitmap> OsmAnd::MapRasterLayerProvider_Software_P::rasterize(
     const TileId tileId,
     const ZoomLevel zoom,
@@ -56,36 +513,18 @@ std::shared_ptr<SkBitmap> OsmAnd::MapRasterLayerProvider_Software_P::rasterize(
 #endif // OSMAND_PERFORMANCE_METRICS
         );
 
-    // Allocate rasterization target
+    // Obtain rasterization target
     const auto tileSize = owner->getTileSize();
-    const std::shared_ptr<SkBitmap> rasterizationSurface(new SkBitmap());
-    if (!rasterizationSurface->tryAllocPixels(SkImageInfo::Make(
-        tileSize,
-        tileSize,
-        SkColorType::kRGBA_8888_SkColorType,
-        SkAlphaType::kUnpremul_SkAlphaType)))
-    {
-        LogPrintf(LogSeverityLevel::Error,
-            "Failed to allocate buffer for RGBA8888 rasterization surface %dx%d",
-            tileSize,
-            tileSize);
+    const auto rasterizationSurface = _surfacesPool->obtainSurface(getSurfaceImageInfo(tileSize, tileSize), metric);
+    if (!rasterizationSurface)
         return nullptr;
-    }
-    SkBitmapDevice rasterizationTarget(*rasterizationSurface);
-
-    // Create rasterization canvas
-    SkCanvas canvas(&rasterizationTarget);
 
     // Perform actual rasterization
-    if (!owner->fillBackground)
-        canvas.clear(SK_ColorTRANSPARENT);
-    _mapRasterizer->rasterize(
+    rasterizeOnto(
+        *rasterizationSurface,
         Utilities::tileBoundingBox31(tileId, zoom),
         primitivesTile->primitivisedObjects,
-        canvas,
-        owner->fillBackground,
-        nullptr,
-        metric ? metric->findOrAddSubmetricOfType<MapRasterizer_Metrics::Metric_rasterize>().get() : nullptr,
+        metric,
         queryController);
 
     if (metric)
@@ -112,3 +551,93 @@ std::shared_ptr<SkBitmap> OsmAnd::MapRasterLayerProvider_Software_P::rasterize(
 
     return rasterizationSurface;
 }
+
+OsmAnd::MapRasterLayerProvider_Software_P::Metatile::Metatile(const TileId metatileId_, const unsigned int size_)
+    : metatileId(metatileId_)
+    , size(size_)
+    , isReady(false)
+    , isEmpty(false)
+    , amortizedElapsedTimePerTile(0.0f)
+    , tilesLeft(0)
+{
+}
+
+OsmAnd::MapRasterLayerProvider_Software_P::Metatile::~Metatile()
+{
+}
+
+OsmAnd::MapRasterLayerProvider_Software_P::SurfacesPool::SurfacesPool()
+{
+}
+
+OsmAnd::MapRasterLayerProvider_Software_P::SurfacesPool::~SurfacesPool()
+{
+}
+
+std::shared_ptr<SkBitmap> OsmAnd::MapRasterLayerProvider_Software_P::SurfacesPool::obtainSurface(
+    const SkImageInfo& imageInfo,
+    MapRasterLayerProvider_Metrics::Metric_obtainData* const metric)
+{
+    SkBitmap surface;
+    {
+        QMutexLocker scopedLocker(&_mutex);
+
+        auto itSurface = mutableIteratorOf(_surfaces);
+        while (itSurface.hasNext())
+        {
+            const auto& pooledSurface = itSurface.next();
+            if (pooledSurface.info() != imageInfo)
+                continue;
+
+            surface = pooledSurface;
+            itSurface.remove();
+            break;
+        }
+    }
+
+    if (!surface.isNull())
+    {
+        if (metric)
+            metric->surfacesReused++;
+    }
+    else
+    {
+        if (!surface.tryAllocPixels(imageInfo))
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Failed to allocate buffer for rasterization surface %dx%d of color type %d",
+                imageInfo.width(),
+                imageInfo.height(),
+                static_cast<int>(imageInfo.colorType()));
+            return nullptr;
+        }
+
+        if (metric)
+            metric->surfacesAllocated++;
+    }
+
+    const std::weak_ptr<SurfacesPool> weakThis = shared_from_this();
+    return std::shared_ptr<SkBitmap>(
+        new SkBitmap(surface),
+        [weakThis]
+        (SkBitmap* const surface)
+        {
+            if (const auto pool = weakThis.lock())
+                pool->releaseSurface(*surface);
+            delete surface;
+        });
+}
+
+void OsmAnd::MapRasterLayerProvider_Software_P::SurfacesPool::releaseSurface(const SkBitmap& surface)
+{
+    // Pixels can be reused only if no one else references them
+    const auto pixelRef = surface.pixelRef();
+    if (!pixelRef || !pixelRef->unique())
+        return;
+
+    QMutexLocker scopedLocker(&_mutex);
+
+    if (_surfaces.size() >= MaxPooledSurfacesCount)
+        return;
+    _surfaces.push_back(surface);
+}
@@ -4,16 +4,25 @@
 #include "stdlib_common.h"
 #include <functional>
 #include <array>
+#include <chrono>
 
 #include "QtExtensions.h"
+#include <QHash>
+#include <QList>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
 
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
 #include "PrivateImplementation.h"
 #include "IRasterMapLayerProvider.h"
 #include "MapRasterLayerProvider_P.h"
+#include "MapContentFingerprint.h"
 
-class SkBitmap;
+#include "ignore_warnings_on_external_includes.h"
+#include <SkBitmap.h>
+#include "restore_internal_warnings.h"
 
 namespace OsmAnd
 {
@@ -24,6 +33,94 @@ namespace OsmAnd
     protected:
         MapRasterLayerProvider_Software_P(MapRasterLayerProvider_Software* owner);
 
+        enum {
+            // Metatiles are kept only until their tiles are requested, but not longer than this
+            MetatileLifetimeInMilliseconds = 10000,
+        };
+
+        enum {
+            // Maximal number of released rasterization surfaces kept for reuse
+            MaxPooledSurfacesCount = 32,
+        };
+
+        // Keeps pixels of released tiles for next rasterizations. Surfaces are returned to pool once last
+        // reference to tile bitmap is released, e.g. after upload to GPU. Pool may outlive provider
+        class SurfacesPool : public std::enable_shared_from_this<SurfacesPool>
+        {
+        private:
+            mutable QMutex _mutex;
+            QList<SkBitmap> _surfaces;
+        protected:
+            void releaseSurface(const SkBitmap& surface);
+        public:
+            SurfacesPool();
+            ~SurfacesPool();
+
+            std::shared_ptr<SkBitmap> obtainSurface(
+                const SkImageInfo& imageInfo,
+                MapRasterLayerProvider_Metrics::Metric_obtainData* const metric);
+        };
+        const std::shared_ptr<SurfacesPool> _surfacesPool;
+
+        SkImageInfo getSurfaceImageInfo(const unsigned int width, const unsigned int height) const;
+
+        struct Metatile
+        {
+            Metatile(const TileId metatileId, const unsigned int size);
+            ~Metatile();
+
+            const TileId metatileId;
+            const unsigned int size;
+            // Lifetime of metatile is counted since it became ready, so that slowly rasterized metatile is not
+            // purged before its tiles are taken
+            std::chrono::steady_clock::time_point readyTime;
+
+            bool isReady;
+            bool isEmpty;
+            float amortizedElapsedTimePerTile;
+            QVector< std::shared_ptr<SkBitmap> > tiles;
+            unsigned int tilesLeft;
+
+        private:
+            Q_DISABLE_COPY_AND_MOVE(Metatile);
+        };
+        mutable QMutex _metatilesMutex;
+        QWaitCondition _metatileReadyCondition;
+        std::array< QHash< TileId, std::shared_ptr<Metatile> >, ZoomLevelsCount > _metatiles;
+
+        void purgeExpiredMetatiles();
+
+        const MapContentFingerprint _diskCacheFingerprint;
+        QString getDiskCacheKey(const TileId tileId, const ZoomLevel zoom) const;
+        bool obtainDataFromDiskCache(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            const QString& diskCacheKey,
+            std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData);
+        void storeDataToDiskCache(
+            const QString& diskCacheKey,
+            const std::shared_ptr<const MapRasterLayerProvider::Data>& tiledData);
+
+        bool obtainDataFromMetatile(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData,
+            MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
+            const IQueryController* const queryController);
+
+        bool rasterizeMetatile(
+            const ZoomLevel zoom,
+            const std::shared_ptr<Metatile>& metatile,
+            MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
+            const IQueryController* const queryController);
+
+        void rasterizeOnto(
+            SkBitmap& targetBitmap,
+            const AreaI area31,
+            const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+            MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
+            const IQueryController* const queryController);
+
         virtual std::shared_ptr<SkBitmap> rasterize(
             const TileId tileId,
             const ZoomLevel zoom,
@@ -35,6 +132,15 @@ namespace OsmAnd
 
         ImplementationInterface<MapRasterLayerProvider_Software> owner;
 
+        virtual bool obtainData(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            std::shared_ptr<MapRasterLayerProvider::Data>& outTiledData,
+            MapRasterLayerProvider_Metrics::Metric_obtainData* const metric,
+            const IQueryController* const queryController);
+
+        virtual bool isDataCached(const TileId tileId, const ZoomLevel zoom) const;
+
     friend class OsmAnd::MapRasterLayerProvider_Software;
     };
 }
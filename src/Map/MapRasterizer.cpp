@@ -23,3 +23,15 @@ void OsmAnd::MapRasterizer::rasterize(
 {
     _p->rasterize(area31, primitivisedObjects, canvas, fillBackground, destinationArea, metric, controller);
 }
+
+void OsmAnd::MapRasterizer::rasterizeInBands(
+    const AreaI area31,
+    const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+    SkBitmap& targetBitmap,
+    const bool fillBackground /*= true*/,
+    const unsigned int bandsCount /*= 0*/,
+    MapRasterizer_Metrics::Metric_rasterize* const metric /*= nullptr*/,
+    const IQueryController* const controller /*= nullptr*/)
+{
+    _p->rasterizeInBands(area31, primitivisedObjects, targetBitmap, fillBackground, bandsCount, metric, controller);
+}
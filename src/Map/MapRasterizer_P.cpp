@@ -5,6 +5,8 @@
 #include "QtCommon.h"
 #include "ignore_warnings_on_external_includes.h"
 #include <QReadWriteLock>
+#include <QThread>
+#include <QVarLengthArray>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -24,6 +26,7 @@
 #include "MapPrimitiviser.h"
 #include "QKeyValueIterator.h"
 #include "QCachingIterator.h"
+#include "Concurrent.h"
 #include "Stopwatch.h"
 #include "Utilities.h"
 #include "Logging.h"
@@ -59,7 +62,7 @@ void OsmAnd::MapRasterizer_P::rasterize(
 {
     const Stopwatch totalStopwatch(metric != nullptr);
 
-    const Context context(area31, primitivisedObjects);
+    const Context context(area31, primitivisedObjects, area31);
 
     // Deal with background
     if (fillBackground)
@@ -98,14 +101,129 @@ void OsmAnd::MapRasterizer_P::rasterize(
         destinationArea = AreaI(0, 0, targetSize.height(), targetSize.width());
     }
 
-    // Rasterize layers of map:
-    rasterizeMapPrimitives(context, canvas, primitivisedObjects->polygons, PrimitivesType::Polygons, controller);
-    if (context.shadowMode != MapPresentationEnvironment::ShadowMode::NoShadow)
-        rasterizeMapPrimitives(context, canvas, primitivisedObjects->polylines, PrimitivesType::Polylines_ShadowOnly, controller);
-    rasterizeMapPrimitives(context, canvas, primitivisedObjects->polylines, PrimitivesType::Polylines, controller);
+    rasterizeLayers(context, canvas, metric, controller);
+
+    if (metric)
+        metric->elapsedTime += totalStopwatch.elapsed();
+}
+
+void OsmAnd::MapRasterizer_P::rasterizeInBands(
+    const AreaI area31,
+    const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+    SkBitmap& targetBitmap,
+    const bool fillBackground,
+    const unsigned int bandsCount_,
+    MapRasterizer_Metrics::Metric_rasterize* const metric,
+    const IQueryController* const controller)
+{
+    const Stopwatch totalStopwatch(metric != nullptr);
+
+    const auto width = targetBitmap.width();
+    const auto height = targetBitmap.height();
+    const auto maxBandsCount = static_cast<unsigned int>(qMax(height / MinBandHeightInPixels, 1));
+    const auto bandsCount = qMin(
+        bandsCount_ > 0 ? bandsCount_ : static_cast<unsigned int>(qMax(QThread::idealThreadCount(), 1)),
+        maxBandsCount);
+    if (bandsCount <= 1)
+    {
+        SkBitmapDevice rasterizationTarget(targetBitmap);
+        SkCanvas canvas(&rasterizationTarget);
+        rasterize(area31, primitivisedObjects, canvas, fillBackground, nullptr, metric, controller);
+        return;
+    }
+
+    // Each band has separate metric, since metrics are not thread-safe
+    QVector< std::shared_ptr<MapRasterizer_Metrics::Metric_rasterize> > bandsMetrics;
+    if (metric)
+    {
+        for (auto bandIdx = 0u; bandIdx < bandsCount; bandIdx++)
+            bandsMetrics.push_back(std::make_shared<MapRasterizer_Metrics::Metric_rasterize>());
+    }
+
+    // All bands draw onto the same pixels, but each via own canvas clipped to rows of that band. Geometry is
+    // projected exactly as for entire bitmap, so band edges produce same pixels as single canvas does
+    const auto bandHeight = (height + static_cast<int>(bandsCount) - 1) / static_cast<int>(bandsCount);
+    const auto& scaleDivisor31ToPixel = primitivisedObjects->scaleDivisor31ToPixel;
+    const auto rasterizeBand =
+        [this, area31, primitivisedObjects, fillBackground, controller, width, height, bandHeight, scaleDivisor31ToPixel]
+        (const SkBitmap& bandBitmap, const unsigned int bandIdx, MapRasterizer_Metrics::Metric_rasterize* const bandMetric)
+        {
+            const auto bandTop = static_cast<int>(bandIdx) * bandHeight;
+            const auto bandBottom = qMin(bandTop + bandHeight, height);
+
+            // Geometry is clipped only to visible part of band (with margin)
+            auto bandArea31 = area31;
+            if (scaleDivisor31ToPixel.y > 0.0)
+            {
+                bandArea31.top() = static_cast<int32_t>(qBound<int64_t>(
+                    area31.top(),
+                    area31.top() + static_cast<int64_t>(bandTop * scaleDivisor31ToPixel.y),
+                    area31.bottom()));
+                bandArea31.bottom() = static_cast<int32_t>(qBound<int64_t>(
+                    area31.top(),
+                    area31.top() + static_cast<int64_t>(bandBottom * scaleDivisor31ToPixel.y),
+                    area31.bottom()));
+            }
+            const Context context(area31, primitivisedObjects, bandArea31);
+
+            SkBitmapDevice rasterizationTarget(bandBitmap);
+            SkCanvas canvas(&rasterizationTarget);
+            canvas.clipRect(SkRect::MakeLTRB(0, bandTop, width, bandBottom));
+            if (fillBackground)
+            {
+                canvas.drawColor(
+                    context.env->getDefaultBackgroundColor(context.zoom).toSkColor(),
+                    SkXfermode::kSrc_Mode);
+            }
+
+            rasterizeLayers(context, canvas, bandMetric, controller);
+        };
+
+    // First band is rasterized by calling thread, while others go to pool shared by all rasterizers. Then calling
+    // thread helps with bands that were not yet taken by workers
+    auto& bandsRasterizationPool = Concurrent::WorkStealingPool::shared();
+    Concurrent::WorkStealingPool::TaskGroup bandsRasterization;
+    for (auto bandIdx = 1u; bandIdx < bandsCount; bandIdx++)
+    {
+        const SkBitmap bandBitmap(targetBitmap);
+        const auto bandMetric = metric ? bandsMetrics[bandIdx].get() : nullptr;
+        const auto task = new Concurrent::Task(
+            [rasterizeBand, bandBitmap, bandIdx, bandMetric]
+            (Concurrent::Task* const task)
+            {
+                rasterizeBand(bandBitmap, bandIdx, bandMetric);
+            });
+        bandsRasterizationPool.start(task, &bandsRasterization);
+    }
+    rasterizeBand(targetBitmap, 0, metric ? bandsMetrics[0].get() : nullptr);
+    bandsRasterizationPool.waitFor(bandsRasterization);
 
     if (metric)
+    {
+        for (const auto& bandMetric : constOf(bandsMetrics))
+        {
+            metric->elapsedTimeForClipping += bandMetric->elapsedTimeForClipping;
+            metric->clippedPrimitives += bandMetric->clippedPrimitives;
+            metric->verticesClippedAway += bandMetric->verticesClippedAway;
+        }
+        metric->rasterizedBands += bandsCount;
         metric->elapsedTime += totalStopwatch.elapsed();
+    }
+}
+
+void OsmAnd::MapRasterizer_P::rasterizeLayers(
+    const Context& context,
+    SkCanvas& canvas,
+    MapRasterizer_Metrics::Metric_rasterize* const metric,
+    const IQueryController* const controller)
+{
+    const auto& primitivisedObjects = context.primitivisedObjects;
+
+    // Rasterize layers of map:
+    rasterizeMapPrimitives(context, canvas, primitivisedObjects->polygons, PrimitivesType::Polygons, metric, controller);
+    if (context.shadowMode != MapPresentationEnvironment::ShadowMode::NoShadow)
+        rasterizeMapPrimitives(context, canvas, primitivisedObjects->polylines, PrimitivesType::Polylines_ShadowOnly, metric, controller);
+    rasterizeMapPrimitives(context, canvas, primitivisedObjects->polylines, PrimitivesType::Polylines, metric, controller);
 }
 
 void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
@@ -113,6 +231,7 @@ void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
     SkCanvas& canvas,
     const MapPrimitiviser::PrimitivesCollection& primitives,
     PrimitivesType type,
+    MapRasterizer_Metrics::Metric_rasterize* const metric,
     const IQueryController* const controller)
 {
     assert(type != PrimitivesType::Points);
@@ -127,7 +246,8 @@ void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
             rasterizePolygon(
                 context,
                 canvas,
-                primitive);
+                primitive,
+                metric);
         }
         else if (type == PrimitivesType::Polylines || type == PrimitivesType::Polylines_ShadowOnly)
         {
@@ -135,7 +255,8 @@ void OsmAnd::MapRasterizer_P::rasterizeMapPrimitives(
                 context,
                 canvas,
                 primitive,
-                (type == PrimitivesType::Polylines_ShadowOnly));
+                (type == PrimitivesType::Polylines_ShadowOnly),
+                metric);
         }
     }
 }
@@ -149,12 +270,107 @@ bool OsmAnd::MapRasterizer_P::updatePaint(
 {
     const auto& env = context.env;
 
-    bool ok = true;
-
     int valueDefId_color = -1;
     int valueDefId_strokeWidth = -1;
     int valueDefId_cap = -1;
     int valueDefId_pathEffect = -1;
+    if (!obtainPaintValueDefinitionIds(
+        env,
+        valueSetSelector,
+        valueDefId_color,
+        valueDefId_strokeWidth,
+        valueDefId_cap,
+        valueDefId_pathEffect))
+    {
+        return false;
+    }
+
+    // Key of configured paint is composed of all style outputs that affect it
+    QVarLengthArray<char, 256> keyData;
+    const auto appendToKey =
+        [&keyData]
+        (const void* const data, const int size)
+        {
+            keyData.append(static_cast<const char*>(data), size);
+        };
+    const auto appendStringToKey =
+        [&appendToKey]
+        (const QString& value)
+        {
+            const auto length = value.length();
+            appendToKey(&length, sizeof(length));
+            appendToKey(value.constData(), length * sizeof(QChar));
+        };
+    const auto selector = static_cast<int>(valueSetSelector);
+    appendToKey(&selector, sizeof(selector));
+    appendToKey(&isArea, sizeof(isArea));
+    if (isArea)
+    {
+        if (!evalResult.contains(valueDefId_color) && !evalResult.contains(env->styleBuiltinValueDefs->id_OUTPUT_SHADER))
+            return false;
+    }
+    else
+    {
+        float stroke;
+        const auto ok = evalResult.getFloatValue(valueDefId_strokeWidth, stroke);
+        if (!ok || stroke <= 0.0f)
+            return false;
+        appendToKey(&stroke, sizeof(stroke));
+
+        QString cap;
+        evalResult.getStringValue(valueDefId_cap, cap);
+        appendStringToKey(cap);
+
+        QString encodedPathEffect;
+        evalResult.getStringValue(valueDefId_pathEffect, encodedPathEffect);
+        appendStringToKey(encodedPathEffect);
+    }
+    SkColor color = SK_ColorTRANSPARENT;
+    evalResult.getIntegerValue(valueDefId_color, color);
+    appendToKey(&color, sizeof(color));
+    if (valueSetSelector == PaintValuesSet::Layer_1)
+    {
+        QString shader;
+        evalResult.getStringValue(env->styleBuiltinValueDefs->id_OUTPUT_SHADER, shader);
+        appendStringToKey(shader);
+
+        if (context.shadowMode == MapPresentationEnvironment::ShadowMode::OneStep)
+        {
+            ColorARGB shadowColor(0x00000000);
+            evalResult.getIntegerValue(env->styleBuiltinValueDefs->id_OUTPUT_SHADOW_COLOR, shadowColor.argb);
+            float shadowRadius = 0.0f;
+            evalResult.getFloatValue(env->styleBuiltinValueDefs->id_OUTPUT_SHADOW_RADIUS, shadowRadius);
+            appendToKey(&shadowColor.argb, sizeof(shadowColor.argb));
+            appendToKey(&shadowRadius, sizeof(shadowRadius));
+            appendToKey(&context.shadowColor.argb, sizeof(context.shadowColor.argb));
+        }
+    }
+
+    // Reuse paint configured earlier for same outputs, in case there's one
+    const auto key = QByteArray::fromRawData(keyData.constData(), keyData.size());
+    std::shared_ptr<const SkPaint> cachedPaint;
+    if (!env->obtainCachedPaint(key, cachedPaint))
+    {
+        const std::shared_ptr<SkPaint> newPaint(new SkPaint(_defaultPaint));
+        if (configurePaint(context, *newPaint, evalResult, valueSetSelector, isArea))
+            cachedPaint = newPaint;
+        env->cachePaint(QByteArray(keyData.constData(), keyData.size()), cachedPaint);
+    }
+    if (!cachedPaint)
+        return false;
+
+    paint = *cachedPaint;
+    return true;
+}
+
+bool OsmAnd::MapRasterizer_P::obtainPaintValueDefinitionIds(
+    const std::shared_ptr<const MapPresentationEnvironment>& env,
+    const PaintValuesSet valueSetSelector,
+    int& valueDefId_color,
+    int& valueDefId_strokeWidth,
+    int& valueDefId_cap,
+    int& valueDefId_pathEffect)
+{
     switch (valueSetSelector)
     {
         case PaintValuesSet::Layer_minus2:
@@ -162,52 +378,79 @@ bool OsmAnd::MapRasterizer_P::updatePaint(
             valueDefId_strokeWidth = env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH__2;
             valueDefId_cap = env->styleBuiltinValueDefs->id_OUTPUT_CAP__2;
             valueDefId_pathEffect = env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT__2;
-            break;
+            return true;
         case PaintValuesSet::Layer_minus1:
             valueDefId_color = env->styleBuiltinValueDefs->id_OUTPUT_COLOR__1;
             valueDefId_strokeWidth = env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH__1;
             valueDefId_cap = env->styleBuiltinValueDefs->id_OUTPUT_CAP__1;
             valueDefId_pathEffect = env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT__1;
-            break;
+            return true;
         case PaintValuesSet::Layer_0:
             valueDefId_color = env->styleBuiltinValueDefs->id_OUTPUT_COLOR_0;
             valueDefId_strokeWidth = env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH_0;
             valueDefId_cap = env->styleBuiltinValueDefs->id_OUTPUT_CAP_0;
             valueDefId_pathEffect = env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT_0;
-            break;
+            return true;
         case PaintValuesSet::Layer_1:
             valueDefId_color = env->styleBuiltinValueDefs->id_OUTPUT_COLOR;
             valueDefId_strokeWidth = env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH;
             valueDefId_cap = env->styleBuiltinValueDefs->id_OUTPUT_CAP;
             valueDefId_pathEffect = env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT;
-            break;
+            return true;
         case PaintValuesSet::Layer_2:
             valueDefId_color = env->styleBuiltinValueDefs->id_OUTPUT_COLOR_2;
             valueDefId_strokeWidth = env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH_2;
             valueDefId_cap = env->styleBuiltinValueDefs->id_OUTPUT_CAP_2;
             valueDefId_pathEffect = env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT_2;
-            break;
+            return true;
         case PaintValuesSet::Layer_3:
             valueDefId_color = env->styleBuiltinValueDefs->id_OUTPUT_COLOR_3;
             valueDefId_strokeWidth = env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH_3;
             valueDefId_cap = env->styleBuiltinValueDefs->id_OUTPUT_CAP_3;
             valueDefId_pathEffect = env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT_3;
-            break;
+            return true;
         case PaintValuesSet::Layer_4:
             valueDefId_color = env->styleBuiltinValueDefs->id_OUTPUT_COLOR_4;
             valueDefId_strokeWidth = env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH_4;
             valueDefId_cap = env->styleBuiltinValueDefs->id_OUTPUT_CAP_4;
             valueDefId_pathEffect = env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT_4;
-            break;
+            return true;
         case PaintValuesSet::Layer_5:
             valueDefId_color = env->styleBuiltinValueDefs->id_OUTPUT_COLOR_5;
             valueDefId_strokeWidth = env->styleBuiltinValueDefs->id_OUTPUT_STROKE_WIDTH_5;
             valueDefId_cap = env->styleBuiltinValueDefs->id_OUTPUT_CAP_5;
             valueDefId_pathEffect = env->styleBuiltinValueDefs->id_OUTPUT_PATH_EFFECT_5;
-            break;
+            return true;
         default:
             return false;
     }
+}
+
+bool OsmAnd::MapRasterizer_P::configurePaint(
+    const Context& context,
+    SkPaint& paint,
+    const MapStyleEvaluationResult& evalResult,
+    const PaintValuesSet valueSetSelector,
+    const bool isArea)
+{
+    const auto& env = context.env;
+
+    bool ok = true;
+
+    int valueDefId_color = -1;
+    int valueDefId_strokeWidth = -1;
+    int valueDefId_cap = -1;
+    int valueDefId_pathEffect = -1;
+    if (!obtainPaintValueDefinitionIds(
+        env,
+        valueSetSelector,
+        valueDefId_color,
+        valueDefId_strokeWidth,
+        valueDefId_cap,
+        valueDefId_pathEffect))
+    {
+        return false;
+    }
 
     if (isArea)
     {
@@ -309,12 +552,12 @@ bool OsmAnd::MapRasterizer_P::updatePaint(
 void OsmAnd::MapRasterizer_P::rasterizePolygon(
     const Context& context,
     SkCanvas& canvas,
-    const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive)
+    const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+    MapRasterizer_Metrics::Metric_rasterize* const metric)
 {
-    const auto& points31 = primitive->sourceObject->points31;
     const auto& area31 = context.area31;
 
-    assert(points31.size() > 2);
+    assert(primitive->points31.size() > 2);
     assert(primitive->sourceObject->isClosedFigure());
     assert(primitive->sourceObject->isClosedFigure(true));
 
@@ -329,6 +572,23 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
     if (!updatePaint(context, paint, primitive->evaluationResult, PaintValuesSet::Layer_1, true))
         return;
 
+    // Clip geometry to area (with margin), since large polygons usually span many tiles
+    const Stopwatch clippingStopwatch(metric != nullptr);
+    QVector< PointI > clippedPoints31;
+    const auto wasClipped = clipPolygon(primitive->points31, context.clipArea31, clippedPoints31);
+    if (metric)
+    {
+        metric->elapsedTimeForClipping += clippingStopwatch.elapsed();
+        if (wasClipped)
+        {
+            metric->clippedPrimitives++;
+            metric->verticesClippedAway += qMax(primitive->points31.size() - clippedPoints31.size(), 0);
+        }
+    }
+    if (wasClipped && clippedPoints31.isEmpty())
+        return;
+    const auto& points31 = wasClipped ? clippedPoints31 : primitive->points31;
+
     // Construct and test geometry against bbox area
     SkPath path;
     bool containsAtLeastOnePoint = false;
@@ -395,11 +655,24 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
     //}
     //////////////////////////////////////////////////////////////////////////
 
-    if (!primitive->sourceObject->innerPolygonsPoints31.isEmpty())
+    if (!primitive->innerPolygonsPoints31.isEmpty())
     {
         path.setFillType(SkPath::kEvenOdd_FillType);
-        for (const auto& polygon : constOf(primitive->sourceObject->innerPolygonsPoints31))
+        QVector< PointI > clippedPolygon;
+        for (const auto& polygon_ : constOf(primitive->innerPolygonsPoints31))
         {
+            const Stopwatch innerPolygonClippingStopwatch(metric != nullptr);
+            const auto innerPolygonWasClipped = clipPolygon(polygon_, context.clipArea31, clippedPolygon);
+            if (metric)
+            {
+                metric->elapsedTimeForClipping += innerPolygonClippingStopwatch.elapsed();
+                if (innerPolygonWasClipped)
+                    metric->verticesClippedAway += qMax(polygon_.size() - clippedPolygon.size(), 0);
+            }
+            if (innerPolygonWasClipped && clippedPolygon.isEmpty())
+                continue;
+            const auto& polygon = innerPolygonWasClipped ? clippedPolygon : polygon_;
+
             pointIdx = 0;
             for (auto itVertex = cachingIteratorOf(constOf(polygon)); itVertex; ++itVertex, pointIdx++)
             {
@@ -423,13 +696,13 @@ void OsmAnd::MapRasterizer_P::rasterizePolyline(
     const Context& context,
     SkCanvas& canvas,
     const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
-    bool drawOnlyShadow)
+    bool drawOnlyShadow,
+    MapRasterizer_Metrics::Metric_rasterize* const metric)
 {
-    const auto& points31 = primitive->sourceObject->points31;
     const auto& area31 = context.area31;
     const auto& env = context.env;
 
-    assert(points31.size() >= 2);
+    assert(primitive->points31.size() >= 2);
 
     SkPaint paint = _defaultPaint;
     if (!updatePaint(context, paint, primitive->evaluationResult, PaintValuesSet::Layer_1, false))
@@ -447,48 +720,77 @@ void OsmAnd::MapRasterizer_P::rasterizePolyline(
     if (drawOnlyShadow && (!ok || shadowRadius <= 0.0f))
         return;
 
+    // Clip geometry to area (with margin). Dashes and path icons depend on length of the path from its start,
+    // so such polylines are left intact to keep them continuous across tiles
+    QList< QVector< PointI > > clippedParts31;
+    auto wasClipped = false;
+    if (!hasPathDependentEffects(context, primitive->evaluationResult))
+    {
+        const Stopwatch clippingStopwatch(metric != nullptr);
+        wasClipped = clipPolyline(primitive->points31, context.clipArea31, clippedParts31);
+        if (metric)
+        {
+            metric->elapsedTimeForClipping += clippingStopwatch.elapsed();
+            if (wasClipped)
+            {
+                auto clippedPointsCount = 0;
+                for (const auto& part : constOf(clippedParts31))
+                    clippedPointsCount += part.size();
+
+                metric->clippedPrimitives++;
+                metric->verticesClippedAway += qMax(primitive->points31.size() - clippedPointsCount, 0);
+            }
+        }
+        if (wasClipped && clippedParts31.isEmpty())
+            return;
+    }
+    if (!wasClipped)
+        clippedParts31.push_back(primitive->points31);
+
     SkPath path;
-    int pointIdx = 0;
     bool intersect = false;
-    int prevCross = 0;
     PointF vertex;
-    const auto pointsCount = points31.size();
-    auto pPoint = points31.constData();
-    for (pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+    for (const auto& points31 : constOf(clippedParts31))
     {
-        const auto& point = *pPoint;
-        calculateVertex(context, point, vertex);
-
-        // Hit-test
-        if (!intersect)
+        int prevCross = 0;
+        const auto pointsCount = points31.size();
+        auto pPoint = points31.constData();
+        for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
         {
-            if (area31.contains(PointI(vertex)))
-            {
-                intersect = true;
-            }
-            else
+            const auto& point = *pPoint;
+            calculateVertex(context, point, vertex);
+
+            // Hit-test
+            if (!intersect)
             {
-                int cross = 0;
-                cross |= (point.x < area31.left() ? 1 : 0);
-                cross |= (point.x > area31.right() ? 2 : 0);
-                cross |= (point.y < area31.top() ? 4 : 0);
-                cross |= (point.y > area31.bottom() ? 8 : 0);
-                if (pointIdx > 0)
+                if (area31.contains(PointI(vertex)))
+                {
+                    intersect = true;
+                }
+                else
                 {
-                    if ((prevCross & cross) == 0)
+                    int cross = 0;
+                    cross |= (point.x < area31.left() ? 1 : 0);
+                    cross |= (point.x > area31.right() ? 2 : 0);
+                    cross |= (point.y < area31.top() ? 4 : 0);
+                    cross |= (point.y > area31.bottom() ? 8 : 0);
+                    if (pointIdx > 0)
                     {
-                        intersect = true;
+                        if ((prevCross & cross) == 0)
+                        {
+                            intersect = true;
+                        }
                     }
+                    prevCross = cross;
                 }
-                prevCross = cross;
             }
-        }
 
-        // Plot vertex
-        if (pointIdx == 0)
-            path.moveTo(vertex.x, vertex.y);
-        else
-            path.lineTo(vertex.x, vertex.y);
+            // Plot vertex
+            if (pointIdx == 0)
+                path.moveTo(vertex.x, vertex.y);
+            else
+                path.lineTo(vertex.x, vertex.y);
+        }
     }
 
     if (!intersect)
@@ -648,6 +950,212 @@ bool OsmAnd::MapRasterizer_P::containsHelper(const QVector< PointI >& points, co
     return intersections % 2 == 1;
 }
 
+bool OsmAnd::MapRasterizer_P::clipPolygon(
+    const QVector< PointI >& points31,
+    const AreaI& clipArea31,
+    QVector< PointI >& outClippedPoints31)
+{
+    // Check if polygon is entirely inside clip area, then there's nothing to clip
+    const auto pointsCount = points31.size();
+    auto pPoint = points31.constData();
+    auto allPointsInside = true;
+    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+    {
+        if (!clipArea31.contains(*pPoint))
+        {
+            allPointsInside = false;
+            break;
+        }
+    }
+    if (allPointsInside)
+        return false;
+
+    // Sutherland-Hodgman clipping against each edge of clip area: left, right, top, bottom
+    QVector< PointI > input(points31);
+    QVector< PointI > output;
+    output.reserve(pointsCount + 4);
+    for (auto edgeIdx = 0; edgeIdx < 4 && !input.isEmpty(); edgeIdx++)
+    {
+        const auto isInside =
+            [edgeIdx, &clipArea31]
+            (const PointI& p) -> bool
+            {
+                switch (edgeIdx)
+                {
+                    case 0: return p.x >= clipArea31.left();
+                    case 1: return p.x <= clipArea31.right();
+                    case 2: return p.y >= clipArea31.top();
+                    default: return p.y <= clipArea31.bottom();
+                }
+            };
+        const auto computeIntersection =
+            [edgeIdx, &clipArea31]
+            (const PointI& p0, const PointI& p1) -> PointI
+            {
+                const auto dx = static_cast<double>(p1.x) - static_cast<double>(p0.x);
+                const auto dy = static_cast<double>(p1.y) - static_cast<double>(p0.y);
+                if (edgeIdx < 2)
+                {
+                    const auto x = (edgeIdx == 0) ? clipArea31.left() : clipArea31.right();
+                    const auto t = (static_cast<double>(x) - static_cast<double>(p0.x)) / dx;
+                    return PointI(x, static_cast<int32_t>(p0.y + t * dy));
+                }
+                else
+                {
+                    const auto y = (edgeIdx == 2) ? clipArea31.top() : clipArea31.bottom();
+                    const auto t = (static_cast<double>(y) - static_cast<double>(p0.y)) / dy;
+                    return PointI(static_cast<int32_t>(p0.x + t * dx), y);
+                }
+            };
+
+        output.clear();
+        auto pPrevPoint = &input.last();
+        auto prevInside = isInside(*pPrevPoint);
+        for (const auto& point : constOf(input))
+        {
+            const auto inside = isInside(point);
+            if (inside)
+            {
+                if (!prevInside)
+                    output.push_back(computeIntersection(*pPrevPoint, point));
+                output.push_back(point);
+            }
+            else if (prevInside)
+            {
+                output.push_back(computeIntersection(*pPrevPoint, point));
+            }
+
+            pPrevPoint = &point;
+            prevInside = inside;
+        }
+        qSwap(input, output);
+    }
+
+    // In case polygon doesn't intersect clip area at all, it's clipped entirely
+    if (input.size() < 3)
+    {
+        outClippedPoints31.clear();
+        return true;
+    }
+
+    // Keep figure closed
+    if (input.first() != input.last())
+        input.push_back(input.first());
+
+    outClippedPoints31 = qMove(input);
+    return true;
+}
+
+bool OsmAnd::MapRasterizer_P::clipPolyline(
+    const QVector< PointI >& points31,
+    const AreaI& clipArea31,
+    QList< QVector< PointI > >& outClippedParts31)
+{
+    // Check if polyline is entirely inside clip area, then there's nothing to clip
+    const auto pointsCount = points31.size();
+    const auto pPoints = points31.constData();
+    auto allPointsInside = true;
+    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++)
+    {
+        if (!clipArea31.contains(pPoints[pointIdx]))
+        {
+            allPointsInside = false;
+            break;
+        }
+    }
+    if (allPointsInside)
+        return false;
+
+    // Liang-Barsky clipping of each segment, consecutive visible segments are joined into parts
+    const auto clipT =
+        []
+        (const double p, const double q, double& t0, double& t1) -> bool
+        {
+            if (p == 0.0)
+                return q >= 0.0;
+
+            const auto r = q / p;
+            if (p < 0.0)
+            {
+                if (r > t1)
+                    return false;
+                if (r > t0)
+                    t0 = r;
+            }
+            else
+            {
+                if (r < t0)
+                    return false;
+                if (r < t1)
+                    t1 = r;
+            }
+            return true;
+        };
+
+    outClippedParts31.clear();
+    QVector< PointI > currentPart;
+    for (auto pointIdx = 1; pointIdx < pointsCount; pointIdx++)
+    {
+        const auto& p0 = pPoints[pointIdx - 1];
+        const auto& p1 = pPoints[pointIdx];
+        const auto dx = static_cast<double>(p1.x) - static_cast<double>(p0.x);
+        const auto dy = static_cast<double>(p1.y) - static_cast<double>(p0.y);
+
+        auto t0 = 0.0;
+        auto t1 = 1.0;
+        const auto isVisible =
+            clipT(-dx, static_cast<double>(p0.x) - static_cast<double>(clipArea31.left()), t0, t1) &&
+            clipT(dx, static_cast<double>(clipArea31.right()) - static_cast<double>(p0.x), t0, t1) &&
+            clipT(-dy, static_cast<double>(p0.y) - static_cast<double>(clipArea31.top()), t0, t1) &&
+            clipT(dy, static_cast<double>(clipArea31.bottom()) - static_cast<double>(p0.y), t0, t1);
+        if (!isVisible)
+        {
+            if (currentPart.size() >= 2)
+                outClippedParts31.push_back(currentPart);
+            currentPart.clear();
+            continue;
+        }
+
+        const auto segmentStart = (t0 > 0.0)
+            ? PointI(static_cast<int32_t>(p0.x + t0 * dx), static_cast<int32_t>(p0.y + t0 * dy))
+            : p0;
+        const auto segmentEnd = (t1 < 1.0)
+            ? PointI(static_cast<int32_t>(p0.x + t1 * dx), static_cast<int32_t>(p0.y + t1 * dy))
+            : p1;
+
+        if (currentPart.isEmpty() || currentPart.last() != segmentStart)
+        {
+            if (currentPart.size() >= 2)
+                outClippedParts31.push_back(currentPart);
+            currentPart.clear();
+            currentPart.push_back(segmentStart);
+        }
+        currentPart.push_back(segmentEnd);
+    }
+    if (currentPart.size() >= 2)
+        outClippedParts31.push_back(currentPart);
+
+    return true;
+}
+
+bool OsmAnd::MapRasterizer_P::hasPathDependentEffects(
+    const Context& context,
+    const MapStyleEvaluationResult& evalResult)
+{
+    const auto& builtinValueDefs = context.env->styleBuiltinValueDefs;
+
+    return
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_EFFECT__2) ||
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_EFFECT__1) ||
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_EFFECT_0) ||
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_EFFECT) ||
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_EFFECT_2) ||
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_EFFECT_3) ||
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_EFFECT_4) ||
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_EFFECT_5) ||
+        evalResult.contains(builtinValueDefs->id_OUTPUT_PATH_ICON);
+}
+
 bool OsmAnd::MapRasterizer_P::obtainPathEffect(const QString& encodedPathEffect, SkPathEffect* &outPathEffect) const
 {
     QMutexLocker scopedLocker(&_pathEffectsMutex);
@@ -714,11 +1222,31 @@ bool OsmAnd::MapRasterizer_P::obtainBitmapShader(const std::shared_ptr<const Map
 
 OsmAnd::MapRasterizer_P::Context::Context(
     const AreaI area31_,
-    const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects_)
+    const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects_,
+    const AreaI visibleArea31)
     : area31(area31_)
     , primitivisedObjects(primitivisedObjects_)
     , env(primitivisedObjects->mapPresentationEnvironment)
     , zoom(primitivisedObjects->zoom)
 {
     env->obtainShadowOptions(zoom, shadowMode, shadowColor);
+
+    // Clip area is visible part of rasterized area extended by margin, but it never exceeds the 31-coordinates space
+    const auto& scaleDivisor31ToPixel = primitivisedObjects->scaleDivisor31ToPixel;
+    if (scaleDivisor31ToPixel.x > 0.0 && scaleDivisor31ToPixel.y > 0.0)
+    {
+        const auto marginInPixels = static_cast<double>(ClipAreaMarginInPixels) * env->displayDensityFactor;
+        const auto marginX31 = static_cast<int64_t>(marginInPixels * scaleDivisor31ToPixel.x);
+        const auto marginY31 = static_cast<int64_t>(marginInPixels * scaleDivisor31ToPixel.y);
+        const auto maxValue31 = static_cast<int64_t>(std::numeric_limits<int32_t>::max());
+
+        clipArea31.top() = static_cast<int32_t>(qBound<int64_t>(0, visibleArea31.top() - marginY31, maxValue31));
+        clipArea31.left() = static_cast<int32_t>(qBound<int64_t>(0, visibleArea31.left() - marginX31, maxValue31));
+        clipArea31.bottom() = static_cast<int32_t>(qBound<int64_t>(0, visibleArea31.bottom() + marginY31, maxValue31));
+        clipArea31.right() = static_cast<int32_t>(qBound<int64_t>(0, visibleArea31.right() + marginX31, maxValue31));
+    }
+    else
+    {
+        clipArea31 = AreaI(0, 0, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::max());
+    }
 }
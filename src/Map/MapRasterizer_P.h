@@ -39,7 +39,8 @@ namespace OsmAnd
         {
             Context(
                 const AreaI area31,
-                const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects);
+                const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+                const AreaI visibleArea31);
 
             const AreaI area31;
             const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects> primitivisedObjects;
@@ -49,10 +50,22 @@ namespace OsmAnd
             MapPresentationEnvironment::ShadowMode shadowMode;
             ColorARGB shadowColor;
 
+            // Area that geometry is clipped to before rasterization
+            AreaI clipArea31;
+
         private:
             Q_DISABLE_COPY_AND_MOVE(Context);
         };
 
+        enum {
+            // Margin around rasterized area that is kept during clipping, so that strokes, shadows and
+            // outlines crossing border of the area are not affected
+            ClipAreaMarginInPixels = 64,
+
+            // Bands lower than this are not worth rasterizing concurrently
+            MinBandHeightInPixels = 64,
+        };
+
         enum class PrimitivesType
         {
             Polygons,
@@ -73,6 +86,13 @@ namespace OsmAnd
             Layer_5,
         };
 
+        void rasterizeLayers(
+            const Context& context,
+            SkCanvas& canvas,
+            MapRasterizer_Metrics::Metric_rasterize* const metric,
+            const IQueryController* const controller);
+
+        // Takes configured paint from cache of environment, configuring it only if it wasn't found there
         bool updatePaint(
             const Context& context,
             SkPaint& paint,
@@ -80,23 +100,41 @@ namespace OsmAnd
             const PaintValuesSet valueSetSelector,
             const bool isArea);
 
+        bool configurePaint(
+            const Context& context,
+            SkPaint& paint,
+            const MapStyleEvaluationResult& evalResult,
+            const PaintValuesSet valueSetSelector,
+            const bool isArea);
+
+        static bool obtainPaintValueDefinitionIds(
+            const std::shared_ptr<const MapPresentationEnvironment>& env,
+            const PaintValuesSet valueSetSelector,
+            int& valueDefId_color,
+            int& valueDefId_strokeWidth,
+            int& valueDefId_cap,
+            int& valueDefId_pathEffect);
+
         void rasterizeMapPrimitives(
             const Context& context,
             SkCanvas& canvas,
             const MapPrimitiviser::PrimitivesCollection& primitives,
             const PrimitivesType type,
+            MapRasterizer_Metrics::Metric_rasterize* const metric,
             const IQueryController* const controller);
 
         void rasterizePolygon(
             const Context& context,
             SkCanvas& canvas,
-            const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive);
+            const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
+            MapRasterizer_Metrics::Metric_rasterize* const metric);
 
         void rasterizePolyline(
             const Context& context,
             SkCanvas& canvas,
             const std::shared_ptr<const MapPrimitiviser::Primitive>& primitive,
-            bool drawOnlyShadow);
+            bool drawOnlyShadow,
+            MapRasterizer_Metrics::Metric_rasterize* const metric);
 
         void rasterizePolylineShadow(
             const Context& context,
@@ -121,6 +159,20 @@ namespace OsmAnd
             const QVector< PointI >& points,
             const PointI& otherPoint);
 
+        static bool clipPolygon(
+            const QVector< PointI >& points31,
+            const AreaI& clipArea31,
+            QVector< PointI >& outClippedPoints31);
+
+        static bool clipPolyline(
+            const QVector< PointI >& points31,
+            const AreaI& clipArea31,
+            QList< QVector< PointI > >& outClippedParts31);
+
+        static bool hasPathDependentEffects(
+            const Context& context,
+            const MapStyleEvaluationResult& evalResult);
+
         void initialize();
         
         SkPaint _defaultPaint;
@@ -143,6 +195,15 @@ namespace OsmAnd
             MapRasterizer_Metrics::Metric_rasterize* const metric,
             const IQueryController* const controller);
 
+        void rasterizeInBands(
+            const AreaI area31,
+            const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
+            SkBitmap& targetBitmap,
+            const bool fillBackground,
+            const unsigned int bandsCount,
+            MapRasterizer_Metrics::Metric_rasterize* const metric,
+            const IQueryController* const controller);
+
     friend class OsmAnd::MapRasterizer;
     };
 }
@@ -5,6 +5,7 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QMutableHashIterator>
+#include <QtMath>
 
 #include "ignore_warnings_on_external_includes.h"
 #include <SkBitmap.h>
@@ -40,6 +41,15 @@ OsmAnd::MapRenderer::MapRenderer(
     , _currentConfiguration(baseConfiguration_->createCopy())
     , _currentConfigurationAsConst(_currentConfiguration)
     , _requestedConfiguration(baseConfiguration_->createCopy())
+    , _currentStateRevision(0)
+    , _predictedStatesUpdated(false)
+    , _prefetchCorridorProgressTolerance(0.0)
+    , _prefetchCorridorTilesPerSecond(0.0f)
+    , _prefetchCorridorUpdated(false)
+    , _prefetchCorridorProgressSegmentIndex(0)
+    , _prefetchCorridorPassedDistance(0.0)
+    , _publishedMapSymbolsRevision(0)
+    , _mapSymbolsUpdatesRevision(0)
     , _suspendSymbolsUpdateCounter(0)
     , _gpuWorkerThreadId(nullptr)
     , _gpuWorkerIsAlive(false)
@@ -50,8 +60,10 @@ OsmAnd::MapRenderer::MapRenderer(
     , setupOptions(_setupOptions)
     , currentConfiguration(_currentConfigurationAsConst)
     , currentState(_currentState)
+    , currentStateRevision(_currentStateRevision)
     , publishedMapSymbolsByOrderLock(_publishedMapSymbolsByOrderLock)
     , publishedMapSymbolsByOrder(_publishedMapSymbolsByOrder)
+    , mapSymbolsUpdatesRevision(_mapSymbolsUpdatesRevision)
     , currentDebugSettings(_currentDebugSettingsAsConst)
     , gpuAPI(gpuAPI_)
 {
@@ -254,7 +266,7 @@ void OsmAnd::MapRenderer::gpuWorkerThreadProcedure()
     _gpuWorkerThreadId = nullptr;
 }
 
-void OsmAnd::MapRenderer::processGpuWorker()
+void OsmAnd::MapRenderer::processGpuWorker(IMapRenderer_Metrics::Metric_update* const metric /*= nullptr*/)
 {
     if (isInGpuWorkerThread())
     {
@@ -265,7 +277,7 @@ void OsmAnd::MapRenderer::processGpuWorker()
             const auto requestsToProcess = _resourcesGpuSyncRequestsCounter.fetchAndAddOrdered(0);
             unsigned int resourcesUploaded = 0u;
             unsigned int resourcesUnloaded = 0u;
-            _resources->syncResourcesInGPU(0, nullptr, &resourcesUploaded, &resourcesUnloaded);
+            _resources->syncResourcesInGPU(0, 0, 0.0f, nullptr, &resourcesUploaded, &resourcesUnloaded);
             if (resourcesUploaded > 0 || resourcesUnloaded > 0)
                 invalidateFrame();
             unprocessedRequests = _resourcesGpuSyncRequestsCounter.fetchAndAddOrdered(-requestsToProcess) - requestsToProcess;
@@ -273,14 +285,37 @@ void OsmAnd::MapRenderer::processGpuWorker()
     }
     else if (isInRenderThread())
     {
-        // To reduce FPS drop, upload not more than 1 resource per frame.
+        // To reduce FPS drop, limit amount of data and time spent on uploads per frame. Resources that do not fit
+        // remain ready and will be uploaded during next frames.
         const auto requestsToProcess = _resourcesGpuSyncRequestsCounter.fetchAndAddOrdered(0);
         bool moreUploadThanLimitAvailable = false;
         unsigned int resourcesUploaded = 0u;
         unsigned int resourcesUnloaded = 0u;
-        _resources->syncResourcesInGPU(1u, &moreUploadThanLimitAvailable, &resourcesUploaded, &resourcesUnloaded);
+        size_t bytesUploaded = 0u;
+        Stopwatch gpuSyncStopwatch(metric != nullptr);
+        _resources->syncResourcesInGPU(
+            0u,
+            _setupOptions.maxGpuUploadBytesPerFrame,
+            _setupOptions.maxGpuUploadTimePerFrame / 1000000.0f,
+            &moreUploadThanLimitAvailable,
+            &resourcesUploaded,
+            &resourcesUnloaded,
+            &bytesUploaded);
+        if (metric)
+        {
+            metric->elapsedTimeForGpuSync = gpuSyncStopwatch.elapsed();
+            metric->resourcesUploadedToGPU = resourcesUploaded;
+            metric->bytesUploadedToGPU = static_cast<unsigned int>(bytesUploaded);
+            metric->resourcesUnloadedFromGPU = resourcesUnloaded;
+            metric->gpuUploadsDeferred = moreUploadThanLimitAvailable ? 1u : 0u;
+        }
         const auto unprocessedRequests = _resourcesGpuSyncRequestsCounter.fetchAndAddOrdered(-requestsToProcess) - requestsToProcess;
 
+        // When there's nothing left to upload, compact atlas textures few slots at a time. It's done only when
+        // resources are uploaded from render thread, since migrated slots change location used by rendering
+        if (!moreUploadThanLimitAvailable)
+            gpuAPI->compactAtlasTextures(AtlasTextureSlotsToMigratePerFrame);
+
         // If any resource was uploaded or there is more resources to uploaded, invalidate frame
         // to use that resource
         if (resourcesUploaded > 0 || moreUploadThanLimitAvailable || resourcesUnloaded > 0 || unprocessedRequests > 0)
@@ -342,6 +377,12 @@ bool OsmAnd::MapRenderer::preInitializeRendering()
     assert(!static_cast<bool>(_resources));
     _resources.reset(new MapRendererResourcesManager(this));
 
+    // Prefetch corridor has to be passed to new resources
+    {
+        QMutexLocker scopedLocker(&_prefetchCorridorMutex);
+        _prefetchCorridorUpdated = true;
+    }
+
     return true;
 }
 
@@ -395,7 +436,12 @@ bool OsmAnd::MapRenderer::preUpdate(IMapRenderer_Metrics::Metric_update* const m
     // Check for resources updates
     Stopwatch updatesStopwatch(metric != nullptr);
     if (_resources->checkForUpdatesAndApply())
+    {
+        // Updates may have changed published symbols in-place
+        _mapSymbolsUpdatesRevision++;
+
         invalidateFrame();
+    }
     if (metric)
         metric->elapsedTimeForUpdatesProcessing = updatesStopwatch.elapsed();
 
@@ -406,7 +452,7 @@ bool OsmAnd::MapRenderer::doUpdate(IMapRenderer_Metrics::Metric_update* const me
 {
     // If GPU worker thread is not enabled, upload resource to GPU from render thread.
     if (!_gpuWorkerThread)
-        processGpuWorker();
+        processGpuWorker(metric);
 
     // Process render thread dispatcher
     Stopwatch renderThreadDispatcherStopwatch(metric != nullptr);
@@ -455,6 +501,7 @@ bool OsmAnd::MapRenderer::prePrepareFrame()
     if (currentDebugSettingsInvalidatedCounter > 0)
     {
         updateCurrentDebugSettings();
+        _currentStateRevision++;
 
         _currentDebugSettingsInvalidatedCounter.fetchAndAddOrdered(-currentDebugSettingsInvalidatedCounter);
     }
@@ -503,6 +550,8 @@ bool OsmAnd::MapRenderer::prePrepareFrame()
     // Update internal state, that is derived from current state and configuration
     if (requestedStateUpdatedMask != 0 || currentConfigurationInvalidatedMask != 0)
     {
+        _currentStateRevision++;
+
         ok = updateInternalState(*getInternalStateRef(), _currentState, *currentConfiguration);
 
         // Anyways, invalidate the frame
@@ -538,6 +587,23 @@ bool OsmAnd::MapRenderer::postPrepareFrame()
     if (!_resources->updateCollectionsSnapshots())
         invalidateFrame();
 
+    // Pass updated prefetch corridor to resources and feed it on each frame according to progress along it
+    {
+        QMutexLocker scopedLocker(&_prefetchCorridorMutex);
+
+        if (_prefetchCorridorUpdated)
+        {
+            _resources->setPrefetchCorridor(_prefetchCorridor, _prefetchCorridorTilesPerSecond);
+            _prefetchCorridorUpdated = false;
+            _prefetchCorridorProgressSegmentIndex = 0;
+            _prefetchCorridorPassedDistance = 0.0;
+            updatePrefetchCorridorProgress();
+        }
+        else if (_prefetchCorridorProgressTarget31 != _currentState.target31)
+            updatePrefetchCorridorProgress();
+    }
+    _resources->feedPrefetchCorridor(_prefetchCorridorPassedDistance);
+
     return true;
 }
 
@@ -782,10 +848,11 @@ bool OsmAnd::MapRenderer::adjustBitmapToConfiguration(
     const bool canUsePaletteTextures = currentConfiguration->paletteTexturesAllowed && gpuAPI->isSupported_8bitPaletteRGBA8;
     const bool paletteTexture = (input->colorType() == SkColorType::kIndex_8_SkColorType);
     const bool unsupportedFormat =
-        (canUsePaletteTextures ? !paletteTexture : paletteTexture) ||
-        (input->colorType() != SkColorType::kRGBA_8888_SkColorType) ||
-        (input->colorType() != SkColorType::kARGB_4444_SkColorType) ||
-        (input->colorType() != SkColorType::kRGB_565_SkColorType);
+        (paletteTexture && !canUsePaletteTextures) ||
+        (!paletteTexture &&
+            input->colorType() != SkColorType::kRGBA_8888_SkColorType &&
+            input->colorType() != SkColorType::kARGB_4444_SkColorType &&
+            input->colorType() != SkColorType::kRGB_565_SkColorType);
     doConvert = doConvert || force16bit;
     doConvert = doConvert || unsupportedFormat;
 
@@ -890,6 +957,7 @@ void OsmAnd::MapRenderer::doPublishMapSymbol(
         _publishedMapSymbolsCount.fetchAndAddOrdered(1);
     assert(!symbolReferencedResources.contains(resource));
     symbolReferencedResources.insert(resource);
+    _publishedMapSymbolsRevision.fetchAndAddOrdered(1);
 
     _publishedMapSymbolsGroups[symbolGroup] += 1;
 
@@ -968,6 +1036,7 @@ void OsmAnd::MapRenderer::doUnpublishMapSymbol(
         assert(false);
         return;
     }
+    _publishedMapSymbolsRevision.fetchAndAddOrdered(1);
 #if OSMAND_LOG_MAP_SYMBOLS_REGISTRATION_LIFECYCLE
     const auto symbolReferencedResourcesSize = symbolReferencedResources.size();
 #endif // OSMAND_LOG_MAP_SYMBOLS_REGISTRATION_LIFECYCLE
@@ -1006,6 +1075,11 @@ void OsmAnd::MapRenderer::doUnpublishMapSymbol(
 #endif // OSMAND_VERIFY_PUBLISHED_MAP_SYMBOLS_INTEGRITY
 }
 
+unsigned int OsmAnd::MapRenderer::getPublishedMapSymbolsRevision() const
+{
+    return _publishedMapSymbolsRevision.loadAcquire();
+}
+
 bool OsmAnd::MapRenderer::validatePublishedMapSymbolsIntegrity()
 {
     bool integrityValid = true;
@@ -1098,6 +1172,179 @@ void OsmAnd::MapRenderer::forcedGpuProcessingCycle()
     requestResourcesUploadOrUnload();
 }
 
+void OsmAnd::MapRenderer::setPredictedStates(const QList<MapRendererState>& predictedStates)
+{
+    {
+        QMutexLocker scopedLocker(&_predictedStatesMutex);
+
+        _predictedStates = predictedStates;
+        _predictedStatesUpdated = true;
+    }
+
+    invalidateFrame();
+}
+
+void OsmAnd::MapRenderer::setPrefetchCorridor(
+    const QVector<PointI>& path31,
+    const ZoomLevel minZoom,
+    const ZoomLevel maxZoom,
+    const unsigned int bufferInTiles /*= 1*/,
+    const float tilesPerSecond /*= 4.0f*/)
+{
+    // Collect tiles of all zooms, ordered by distance along path from its beginning. Distance at which corridor
+    // leaves tile is kept too, so that tiles that were passed are released
+    MapRendererResourcesManager::PrefetchCorridor corridorTiles;
+    const auto buffer = static_cast<int32_t>(bufferInTiles);
+    for (int zoom = minZoom; zoom <= maxZoom && !path31.isEmpty(); zoom++)
+    {
+        const auto zoomShift = ZoomLevel31 - zoom;
+        const auto tileSize31 = static_cast<double>(1u << zoomShift);
+
+        QHash<TileId, int> zoomTilesIndices;
+        const auto collectTilesAround =
+            [&corridorTiles, &zoomTilesIndices, zoom, zoomShift, buffer]
+            (const PointI& point31, const double distance)
+            {
+                const auto centerTileId = TileId::fromXY(point31.x >> zoomShift, point31.y >> zoomShift);
+                for (auto dy = -buffer; dy <= buffer; dy++)
+                {
+                    for (auto dx = -buffer; dx <= buffer; dx++)
+                    {
+                        const auto tileId = Utilities::normalizeTileId(
+                            TileId::fromXY(centerTileId.x + dx, centerTileId.y + dy),
+                            static_cast<ZoomLevel>(zoom));
+                        const auto citTileIndex = zoomTilesIndices.constFind(tileId);
+                        if (citTileIndex != zoomTilesIndices.cend())
+                        {
+                            corridorTiles[*citTileIndex].lastDistance = distance;
+                            continue;
+                        }
+                        zoomTilesIndices.insert(tileId, corridorTiles.size());
+
+                        MapRendererResourcesManager::PrefetchCorridorTile corridorTile;
+                        corridorTile.zoom = static_cast<ZoomLevel>(zoom);
+                        corridorTile.tileId = tileId;
+                        corridorTile.firstDistance = distance;
+                        corridorTile.lastDistance = distance;
+                        corridorTiles.push_back(corridorTile);
+                    }
+                }
+            };
+
+        // Segments are sampled at half of tile size, so that no crossed tile is missed
+        auto distance = 0.0;
+        collectTilesAround(path31.first(), distance);
+        for (auto pointIdx = 1; pointIdx < path31.size(); pointIdx++)
+        {
+            const PointI64 start(path31[pointIdx - 1]);
+            const PointI64 end(path31[pointIdx]);
+            const auto dx = static_cast<double>(end.x - start.x);
+            const auto dy = static_cast<double>(end.y - start.y);
+            const auto segmentLength = qSqrt(dx*dx + dy*dy);
+            const auto stepsCount = qMax(1, qCeil(segmentLength / (tileSize31 / 2.0)));
+            for (auto stepIdx = 1; stepIdx <= stepsCount; stepIdx++)
+            {
+                const auto t = static_cast<double>(stepIdx) / stepsCount;
+                const PointI64 sample(
+                    start.x + static_cast<int64_t>(dx * t),
+                    start.y + static_cast<int64_t>(dy * t));
+                collectTilesAround(Utilities::normalizeCoordinates(sample, ZoomLevel31), distance + segmentLength * t);
+            }
+            distance += segmentLength;
+        }
+    }
+    std::stable_sort(corridorTiles.begin(), corridorTiles.end(),
+        []
+        (const MapRendererResourcesManager::PrefetchCorridorTile& l, const MapRendererResourcesManager::PrefetchCorridorTile& r) -> bool
+        {
+            return l.firstDistance < r.firstDistance;
+        });
+
+    // Distances along path are needed to track progress of target along it
+    QVector<double> pathDistances(path31.size());
+    for (auto pointIdx = 0; pointIdx < path31.size(); pointIdx++)
+    {
+        if (pointIdx == 0)
+        {
+            pathDistances[pointIdx] = 0.0;
+            continue;
+        }
+
+        const auto dx = static_cast<double>(path31[pointIdx].x) - path31[pointIdx - 1].x;
+        const auto dy = static_cast<double>(path31[pointIdx].y) - path31[pointIdx - 1].y;
+        pathDistances[pointIdx] = pathDistances[pointIdx - 1] + qSqrt(dx*dx + dy*dy);
+    }
+
+    {
+        QMutexLocker scopedLocker(&_prefetchCorridorMutex);
+
+        _prefetchCorridor = corridorTiles;
+        _prefetchCorridorPath31 = path31;
+        _prefetchCorridorPathDistances = pathDistances;
+        _prefetchCorridorProgressTolerance = static_cast<double>(1u << (ZoomLevel31 - minZoom)) * (bufferInTiles + 1);
+        _prefetchCorridorTilesPerSecond = tilesPerSecond;
+        _prefetchCorridorUpdated = true;
+    }
+
+    invalidateFrame();
+}
+
+void OsmAnd::MapRenderer::updatePrefetchCorridorProgress()
+{
+    _prefetchCorridorProgressTarget31 = _currentState.target31;
+
+    const auto segmentsCount = _prefetchCorridorPath31.size() - 1;
+    if (segmentsCount <= 0)
+        return;
+
+    // Target is considered to move along path only forward, and only while it's near the path. Otherwise map
+    // that is being looked around would release tiles ahead on the route
+    const PointI64 target(_currentState.target31);
+    auto bestDistanceSquared = _prefetchCorridorProgressTolerance * _prefetchCorridorProgressTolerance;
+    auto bestSegmentIndex = -1;
+    auto bestPassedDistance = 0.0;
+    for (auto segmentIndex = _prefetchCorridorProgressSegmentIndex; segmentIndex < segmentsCount; segmentIndex++)
+    {
+        const PointI64 start(_prefetchCorridorPath31[segmentIndex]);
+        const PointI64 end(_prefetchCorridorPath31[segmentIndex + 1]);
+        const auto sx = static_cast<double>(end.x - start.x);
+        const auto sy = static_cast<double>(end.y - start.y);
+        const auto tx = static_cast<double>(target.x - start.x);
+        const auto ty = static_cast<double>(target.y - start.y);
+        const auto segmentLengthSquared = sx*sx + sy*sy;
+        const auto t = segmentLengthSquared > 0.0
+            ? qBound(0.0, (tx*sx + ty*sy) / segmentLengthSquared, 1.0)
+            : 0.0;
+        const auto ox = tx - sx*t;
+        const auto oy = ty - sy*t;
+        const auto distanceSquared = ox*ox + oy*oy;
+        if (distanceSquared > bestDistanceSquared)
+            continue;
+
+        bestDistanceSquared = distanceSquared;
+        bestSegmentIndex = segmentIndex;
+        bestPassedDistance = _prefetchCorridorPathDistances[segmentIndex] + qSqrt(segmentLengthSquared) * t;
+    }
+    if (bestSegmentIndex < 0)
+        return;
+
+    _prefetchCorridorProgressSegmentIndex = bestSegmentIndex;
+    _prefetchCorridorPassedDistance = qMax(_prefetchCorridorPassedDistance, bestPassedDistance);
+}
+
+bool OsmAnd::MapRenderer::obtainUpdatedPredictedStates(QList<MapRendererState>& outPredictedStates)
+{
+    QMutexLocker scopedLocker(&_predictedStatesMutex);
+
+    if (!_predictedStatesUpdated)
+        return false;
+
+    outPredictedStates = _predictedStates;
+    _predictedStatesUpdated = false;
+
+    return true;
+}
+
 OsmAnd::Concurrent::Dispatcher& OsmAnd::MapRenderer::getRenderThreadDispatcher()
 {
     return _renderThreadDispatcher;
@@ -44,6 +44,11 @@ namespace OsmAnd
         typedef QMap< int, PublishedMapSymbolsByGroup > PublishedMapSymbolsByOrder;
 
     private:
+        enum {
+            // Number of atlas texture slots migrated per frame while compacting atlas textures
+            AtlasTextureSlotsToMigratePerFrame = 4,
+        };
+
         // General:
         bool _isRenderingInitialized;
         MapRendererSetupOptions _setupOptions;
@@ -62,8 +67,25 @@ namespace OsmAnd
         mutable QMutex _requestedStateMutex;
         MapRendererState _requestedState;
         MapRendererState _currentState;
+        unsigned int _currentStateRevision;
         QAtomicInt _requestedStateUpdatedMask;
         void notifyRequestedStateWasUpdated(const MapRendererStateChange change);
+        mutable QMutex _predictedStatesMutex;
+        QList<MapRendererState> _predictedStates;
+        bool _predictedStatesUpdated;
+        mutable QMutex _prefetchCorridorMutex;
+        MapRendererResourcesManager::PrefetchCorridor _prefetchCorridor;
+        QVector<PointI> _prefetchCorridorPath31;
+        QVector<double> _prefetchCorridorPathDistances;
+        double _prefetchCorridorProgressTolerance;
+        float _prefetchCorridorTilesPerSecond;
+        bool _prefetchCorridorUpdated;
+
+        // Progress of target along prefetch corridor path, tracked by render thread
+        int _prefetchCorridorProgressSegmentIndex;
+        PointI _prefetchCorridorProgressTarget31;
+        double _prefetchCorridorPassedDistance;
+        void updatePrefetchCorridorProgress();
 
         // Resources-related:
         std::unique_ptr<MapRendererResourcesManager> _resources;
@@ -74,6 +96,8 @@ namespace OsmAnd
         PublishedMapSymbolsByOrder _publishedMapSymbolsByOrder;
         QHash< std::shared_ptr<const MapSymbolsGroup>, SmartPOD<unsigned int, 0> > _publishedMapSymbolsGroups;
         QAtomicInt _publishedMapSymbolsCount;
+        QAtomicInt _publishedMapSymbolsRevision;
+        unsigned int _mapSymbolsUpdatesRevision;
         void doPublishMapSymbol(
             const std::shared_ptr<const MapSymbolsGroup>& symbolGroup,
             const std::shared_ptr<const MapSymbol>& symbol,
@@ -93,7 +117,7 @@ namespace OsmAnd
         QWaitCondition _gpuWorkerThreadWakeup;
         volatile bool _gpuWorkerIsPaused;
         void gpuWorkerThreadProcedure();
-        void processGpuWorker();
+        void processGpuWorker(IMapRenderer_Metrics::Metric_update* const metric = nullptr);
 
         // General:
         void invalidateFrame();
@@ -143,6 +167,8 @@ namespace OsmAnd
 
         // State-related:
         const MapRendererState& currentState;
+        // Changes each time current state, configuration or debug settings are changed
+        const unsigned int& currentStateRevision;
         mutable QReadWriteLock _internalStateLock;
         virtual const MapRendererInternalState* getInternalStateRef() const = 0;
         virtual MapRendererInternalState* getInternalStateRef() = 0;
@@ -152,6 +178,7 @@ namespace OsmAnd
             MapRendererInternalState& outInternalState,
             const MapRendererState& state,
             const MapRendererConfiguration& configuration) const;
+        bool obtainUpdatedPredictedStates(QList<MapRendererState>& outPredictedStates);
 
         // Resources-related:
         const MapRendererResourcesManager& getResources() const;
@@ -169,6 +196,10 @@ namespace OsmAnd
         // Symbols-related:
         QReadWriteLock& publishedMapSymbolsByOrderLock;
         const PublishedMapSymbolsByOrder& publishedMapSymbolsByOrder;
+        // Changes each time any symbol is published or unpublished
+        unsigned int getPublishedMapSymbolsRevision() const;
+        // Changes each time published symbols may have been changed in-place by applied updates
+        const unsigned int& mapSymbolsUpdatesRevision;
         void publishMapSymbol(
             const std::shared_ptr<const MapSymbolsGroup>& symbolGroup,
             const std::shared_ptr<const MapSymbol>& symbol,
@@ -238,6 +269,13 @@ namespace OsmAnd
         virtual bool isFrameInvalidated() const;
         virtual void forcedFrameInvalidate();
         virtual void forcedGpuProcessingCycle();
+        virtual void setPredictedStates(const QList<MapRendererState>& predictedStates);
+        virtual void setPrefetchCorridor(
+            const QVector<PointI>& path31,
+            const ZoomLevel minZoom,
+            const ZoomLevel maxZoom,
+            const unsigned int bufferInTiles = 1,
+            const float tilesPerSecond = 4.0f);
 
         Concurrent::Dispatcher& getRenderThreadDispatcher();
         Concurrent::Dispatcher& getGpuThreadDispatcher();
@@ -18,6 +18,11 @@ void OsmAnd::MapRendererBaseResource::markAsJunk()
     _isJunk = true;
 }
 
+bool OsmAnd::MapRendererBaseResource::gpuUpdatePending() const
+{
+    return false;
+}
+
 bool OsmAnd::MapRendererBaseResource::updatesPresent()
 {
     return false;
@@ -36,6 +36,11 @@ namespace OsmAnd
         
         virtual bool obtainData(bool& dataAvailable, const IQueryController* queryController = nullptr) = 0;
         virtual bool uploadToGPU() = 0;
+        // Estimated amount of data (in bytes) that uploadToGPU() will transfer, used to limit uploads per frame
+        virtual size_t estimateGpuUploadCost() const = 0;
+        // Uploaded resource may obtain newer content to replace one in GPU. It's uploaded by uploadToGPU() along
+        // with other resources, so that it's limited by same budget
+        virtual bool gpuUpdatePending() const;
         virtual void unloadFromGPU() = 0;
         virtual void releaseData() = 0;
 
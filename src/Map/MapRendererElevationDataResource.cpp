@@ -57,6 +57,11 @@ bool OsmAnd::MapRendererElevationDataResource::uploadToGPU()
     return true;
 }
 
+size_t OsmAnd::MapRendererElevationDataResource::estimateGpuUploadCost() const
+{
+    return resourcesManager->estimateTiledDataUploadCost(_sourceData);
+}
+
 void OsmAnd::MapRendererElevationDataResource::unloadFromGPU()
 {
     _resourceInGPU.reset();
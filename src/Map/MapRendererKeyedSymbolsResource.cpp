@@ -163,6 +163,17 @@ bool OsmAnd::MapRendererKeyedSymbolsResource::uploadToGPU()
     return true;
 }
 
+size_t OsmAnd::MapRendererKeyedSymbolsResource::estimateGpuUploadCost() const
+{
+    if (!_sourceData)
+        return 0;
+
+    size_t cost = 0;
+    for (const auto& symbol : constOf(_sourceData->symbolsGroup->symbols))
+        cost += resourcesManager->estimateSymbolUploadCost(symbol);
+    return cost;
+}
+
 void OsmAnd::MapRendererKeyedSymbolsResource::unloadFromGPU()
 {
     _resourcesInGPU.clear();
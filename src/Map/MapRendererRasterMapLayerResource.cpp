@@ -1,7 +1,10 @@
 #include "MapRendererRasterMapLayerResource.h"
 
 #include "IRasterMapLayerProvider.h"
+#include "MapRasterLayerProvider.h"
 #include "MapRendererResourcesManager.h"
+#include "FunctorQueryController.h"
+#include "Logging.h"
 
 OsmAnd::MapRendererRasterMapLayerResource::MapRendererRasterMapLayerResource(
     MapRendererResourcesManager* owner_,
@@ -30,8 +33,41 @@ bool OsmAnd::MapRendererRasterMapLayerResource::obtainData(bool& dataAvailable,
         return false;
     const auto provider = std::static_pointer_cast<IMapTiledDataProvider>(provider_);
 
-    // Obtain tile from provider
+    // Tile that was warmed along prefetch corridor is ready already
     std::shared_ptr<IMapTiledDataProvider::Data> tiledData;
+    if (resourcesManager->takePrefetchCorridorWarmedData(provider_, tileId, zoom, tiledData))
+    {
+        _sourceData = std::static_pointer_cast<IRasterMapLayerProvider::Data>(tiledData);
+        _sourceData->bitmap = resourcesManager->adjustBitmapToConfiguration(
+            _sourceData->bitmap,
+            _sourceData->alphaChannelPresence);
+        dataAvailable = true;
+        return true;
+    }
+
+    // Right after zoom change, tile that can be quickly derived from recently obtained tiles of nearby zoom is
+    // shown while actual tile is being obtained, so that no empty tiles are seen during zooming. Cached actual
+    // tile is obtained quickly anyways
+    const auto rasterLayerProvider = std::dynamic_pointer_cast<MapRasterLayerProvider>(provider);
+    if (rasterLayerProvider &&
+        resourcesManager->isDerivingTilesAllowed(zoom) &&
+        !rasterLayerProvider->isDataCached(tileId, zoom))
+    {
+        std::shared_ptr<MapRasterLayerProvider::Data> derivedData;
+        if (rasterLayerProvider->obtainDerivedData(tileId, zoom, derivedData, queryController))
+        {
+            derivedData->bitmap = resourcesManager->adjustBitmapToConfiguration(
+                derivedData->bitmap,
+                derivedData->alphaChannelPresence);
+            _sourceData = derivedData;
+            dataAvailable = true;
+
+            requestActualData(provider);
+            return true;
+        }
+    }
+
+    // Obtain tile from provider
     const auto requestSucceeded = provider->obtainData(tileId, zoom, tiledData, nullptr, queryController);
     if (!requestSucceeded)
         return false;
@@ -52,8 +88,95 @@ bool OsmAnd::MapRendererRasterMapLayerResource::obtainData(bool& dataAvailable,
     return true;
 }
 
+void OsmAnd::MapRendererRasterMapLayerResource::requestActualData(const std::shared_ptr<IMapTiledDataProvider>& provider)
+{
+    // Actual tile is requested same way as other resources, so it's prioritized against them. It's not tracked as
+    // request of this resource, since resource already has data
+    const auto executeProc =
+        [provider]
+        (Concurrent::Task* task_)
+        {
+            const auto task = static_cast<MapRendererResourcesManager::ResourceRequestTask*>(task_);
+            const auto self = std::static_pointer_cast<MapRendererRasterMapLayerResource>(task->requestedResource);
+
+            // Actual tile is no longer needed once resource is junk
+            FunctorQueryController queryController(
+                [self]
+                (const FunctorQueryController* const controller) -> bool
+                {
+                    return self->isJunk;
+                });
+            if (queryController.isAborted())
+                return;
+
+            std::shared_ptr<IMapTiledDataProvider::Data> tiledData;
+            const auto requestSucceeded = provider->obtainData(
+                self->tileId,
+                self->zoom,
+                tiledData,
+                nullptr,
+                &queryController);
+            if (!requestSucceeded || queryController.isAborted())
+                return;
+
+            // In case actual tile has no data, derived one is kept
+            const auto actualData = std::static_pointer_cast<IRasterMapLayerProvider::Data>(tiledData);
+            if (!actualData)
+                return;
+            actualData->bitmap = self->resourcesManager->adjustBitmapToConfiguration(
+                actualData->bitmap,
+                actualData->alphaChannelPresence);
+            {
+                QMutexLocker scopedLocker(&self->_actualDataMutex);
+
+                self->_actualSourceData = actualData;
+            }
+
+            // Actual tile is uploaded along with other resources, replacing derived one
+            self->resourcesManager->requestResourcesUploadOrUnload();
+        };
+    resourcesManager->enqueueResourceRequest(new MapRendererResourcesManager::ResourceRequestTask(
+        shared_from_this(),
+        resourcesManager->_taskHostBridge,
+        executeProc));
+}
+
 bool OsmAnd::MapRendererRasterMapLayerResource::uploadToGPU()
 {
+    std::shared_ptr<IRasterMapLayerProvider::Data> actualData;
+    {
+        QMutexLocker scopedLocker(&_actualDataMutex);
+
+        actualData = qMove(_actualSourceData);
+        _actualSourceData.reset();
+    }
+
+    // Actual tile replaces derived one that is already in GPU. Previous content is kept if replacement fails
+    if (!_sourceData)
+    {
+        if (!actualData)
+            return false;
+
+        std::shared_ptr<const GPUAPI::ResourceInGPU> actualResourceInGPU;
+        if (!resourcesManager->uploadTiledDataToGPU(actualData, actualResourceInGPU))
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Failed to replace derived tile %dx%d@%d with actual one",
+                tileId.x,
+                tileId.y,
+                zoom);
+            return false;
+        }
+        _resourceInGPU = actualResourceInGPU;
+        _retainableCacheMetadata = actualData->retainableCacheMetadata;
+
+        return true;
+    }
+
+    // If actual tile was obtained before derived one was uploaded, there's no need to upload derived one
+    if (actualData)
+        _sourceData = actualData;
+
     bool ok = resourcesManager->uploadTiledDataToGPU(_sourceData, _resourceInGPU);
     if (!ok)
         return false;
@@ -65,6 +188,25 @@ bool OsmAnd::MapRendererRasterMapLayerResource::uploadToGPU()
     return true;
 }
 
+size_t OsmAnd::MapRendererRasterMapLayerResource::estimateGpuUploadCost() const
+{
+    if (!_sourceData)
+    {
+        QMutexLocker scopedLocker(&_actualDataMutex);
+
+        return resourcesManager->estimateTiledDataUploadCost(_actualSourceData);
+    }
+
+    return resourcesManager->estimateTiledDataUploadCost(_sourceData);
+}
+
+bool OsmAnd::MapRendererRasterMapLayerResource::gpuUpdatePending() const
+{
+    QMutexLocker scopedLocker(&_actualDataMutex);
+
+    return static_cast<bool>(_actualSourceData);
+}
+
 void OsmAnd::MapRendererRasterMapLayerResource::unloadFromGPU()
 {
     _resourceInGPU.reset();
@@ -74,4 +216,7 @@ void OsmAnd::MapRendererRasterMapLayerResource::releaseData()
 {
     _retainableCacheMetadata.reset();
     _sourceData.reset();
+
+    QMutexLocker scopedLocker(&_actualDataMutex);
+    _actualSourceData.reset();
 }
@@ -4,6 +4,7 @@
 #include "stdlib_common.h"
 
 #include "QtExtensions.h"
+#include <QMutex>
 
 #include "OsmAndCore.h"
 #include "MapRendererResourceType.h"
@@ -29,8 +30,15 @@ namespace OsmAnd
         std::shared_ptr<IRasterMapLayerProvider::Data> _sourceData;
         std::shared_ptr<const GPUAPI::ResourceInGPU> _resourceInGPU;
 
+        // Tile derived from nearby zoom is uploaded first, and is replaced by actual tile once it's obtained
+        mutable QMutex _actualDataMutex;
+        std::shared_ptr<IRasterMapLayerProvider::Data> _actualSourceData;
+        void requestActualData(const std::shared_ptr<IMapTiledDataProvider>& provider);
+
         virtual bool obtainData(bool& dataAvailable, const IQueryController* queryController);
         virtual bool uploadToGPU();
+        virtual size_t estimateGpuUploadCost() const;
+        virtual bool gpuUpdatePending() const;
         virtual void unloadFromGPU();
         virtual void releaseData();
     public:
@@ -14,6 +14,9 @@
 #include "IMapLayerProvider.h"
 #include "IMapElevationDataProvider.h"
 #include "IRasterMapLayerProvider.h"
+#include "MapRasterLayerProvider.h"
+#include "MapPrimitivesProvider.h"
+#include "MapObject.h"
 #include "MapSymbol.h"
 #include "RasterMapSymbol.h"
 #include "VectorMapSymbol.h"
@@ -57,6 +60,12 @@
 
 OsmAnd::MapRendererResourcesManager::MapRendererResourcesManager(MapRenderer* const owner_)
     : _taskHostBridge(this)
+    , _activeZoomChanged(false)
+    , _prefetchCorridorRevision(0)
+    , _prefetchCorridorNextTileIndex(0)
+    , _prefetchCorridorTilesPerSecond(0.0f)
+    , _prefetchCorridorWarmedBytes(0)
+    , _prefetchCorridorWarmingTilesCount(0)
     , _workerThreadIsAlive(false)
     , _workerThreadId(nullptr)
     , _workerThread(new Concurrent::Thread(std::bind(&MapRendererResourcesManager::workerThreadProcedure, this)))
@@ -166,6 +175,43 @@ bool OsmAnd::MapRendererResourcesManager::uploadSymbolToGPU(const std::shared_pt
     return renderer->gpuAPI->uploadSymbolToGPU(mapSymbol, outResourceInGPU);
 }
 
+size_t OsmAnd::MapRendererResourcesManager::estimateTiledDataUploadCost(const std::shared_ptr<const IMapTiledDataProvider::Data>& mapTile)
+{
+    if (!mapTile)
+        return 0;
+
+    if (const auto rasterMapLayerData = std::dynamic_pointer_cast<const IRasterMapLayerProvider::Data>(mapTile))
+    {
+        if (!rasterMapLayerData->bitmap)
+            return 0;
+        return rasterMapLayerData->bitmap->getSize();
+    }
+    else if (const auto elevationData = std::dynamic_pointer_cast<const IMapElevationDataProvider::Data>(mapTile))
+    {
+        return static_cast<size_t>(elevationData->size) * elevationData->size * sizeof(float);
+    }
+
+    return 0;
+}
+
+size_t OsmAnd::MapRendererResourcesManager::estimateSymbolUploadCost(const std::shared_ptr<const MapSymbol>& mapSymbol)
+{
+    if (const auto rasterMapSymbol = std::dynamic_pointer_cast<const RasterMapSymbol>(mapSymbol))
+    {
+        if (!rasterMapSymbol->bitmap)
+            return 0;
+        return rasterMapSymbol->bitmap->getSize();
+    }
+    else if (const auto vectorMapSymbol = std::dynamic_pointer_cast<const VectorMapSymbol>(mapSymbol))
+    {
+        return
+            vectorMapSymbol->verticesCount * sizeof(VectorMapSymbol::Vertex) +
+            vectorMapSymbol->indicesCount * sizeof(VectorMapSymbol::Index);
+    }
+
+    return 0;
+}
+
 std::shared_ptr<const SkBitmap> OsmAnd::MapRendererResourcesManager::adjustBitmapToConfiguration(const std::shared_ptr<const SkBitmap>& input, const AlphaChannelPresence alphaChannelPresence) const
 {
     return renderer->adjustBitmapToConfiguration(input, alphaChannelPresence);
@@ -367,12 +413,13 @@ void OsmAnd::MapRendererResourcesManager::updateBindings(const MapRendererState&
         _resourcesStoragesLock.unlock();
 }
 
-void OsmAnd::MapRendererResourcesManager::updateActiveZone(const QSet<TileId>& tiles, const ZoomLevel zoom)
+void OsmAnd::MapRendererResourcesManager::updateActiveZone(const QSet<TileId>& tiles, const ZoomLevel zoom, const TileId targetTileId)
 {
     // Check if update needed
     bool update = true; //NOTE: So far this won't work, since resources won't be updated
     update = update || (_activeZoom != zoom);
     update = update || (_activeTiles != tiles);
+    update = update || (_activeTargetTileId != targetTileId);
 
     if (update)
     {
@@ -380,14 +427,270 @@ void OsmAnd::MapRendererResourcesManager::updateActiveZone(const QSet<TileId>& t
         QMutexLocker scopedLocker(&_workerThreadWakeupMutex);
 
         // Update active zone
+        if (_activeZoom != zoom)
+        {
+            _activeZoomChanged = true;
+            _activeZoomChangeStopwatch.start();
+        }
         _activeTiles = tiles;
         _activeZoom = zoom;
+        _activeTargetTileId = targetTileId;
 
         // Wake up the worker
         _workerThreadWakeup.wakeAll();
     }
 }
 
+bool OsmAnd::MapRendererResourcesManager::isDerivingTilesAllowed(const ZoomLevel zoom) const
+{
+    QMutexLocker scopedLocker(&_workerThreadWakeupMutex);
+
+    return _activeZoomChanged &&
+        _activeZoom == zoom &&
+        _activeZoomChangeStopwatch.elapsed() * 1000.0f < DeriveTilesAfterZoomChangePeriodMs;
+}
+
+void OsmAnd::MapRendererResourcesManager::updatePrefetchZone(const PrefetchZone zone, const TilesByZoom& tiles)
+{
+    // Lock worker wakeup mutex
+    QMutexLocker scopedLocker(&_workerThreadWakeupMutex);
+
+    // Update prefetch zone
+    if (tiles.isEmpty())
+        _prefetchZones.remove(zone);
+    else
+        _prefetchZones.insert(zone, tiles);
+
+    // Wake up the worker
+    _workerThreadWakeup.wakeAll();
+}
+
+void OsmAnd::MapRendererResourcesManager::setPrefetchCorridor(const PrefetchCorridor& corridor, const float tilesPerSecond)
+{
+    QMutexLocker scopedLocker(&_prefetchCorridorMutex);
+
+    // Tiles already warmed for previous corridor are kept if new corridor has them too, so that moving along
+    // the route does not drop and obtain them again
+    std::array< QHash<TileId, int>, ZoomLevelsCount > corridorTilesIndices;
+    for (auto tileIndex = 0; tileIndex < corridor.size(); tileIndex++)
+    {
+        const auto& tile = corridor[tileIndex];
+        corridorTilesIndices[tile.zoom].insert(tile.tileId, tileIndex);
+    }
+    QVector<bool> isTileWarmed(corridor.size(), false);
+    auto itWarmedTile = mutableIteratorOf(_prefetchCorridorWarmedTiles);
+    while (itWarmedTile.hasNext())
+    {
+        auto& warmedTile = itWarmedTile.next();
+
+        const auto tileIndex = corridorTilesIndices[warmedTile.tile.zoom].value(warmedTile.tile.tileId, -1);
+        if (tileIndex >= 0)
+        {
+            warmedTile.tile = corridor[tileIndex];
+            isTileWarmed[tileIndex] = true;
+            continue;
+        }
+
+        _prefetchCorridorWarmedBytes -= warmedTile.bytes;
+        itWarmedTile.remove();
+    }
+
+    _prefetchCorridor.clear();
+    _prefetchCorridor.reserve(corridor.size());
+    for (auto tileIndex = 0; tileIndex < corridor.size(); tileIndex++)
+    {
+        if (!isTileWarmed[tileIndex])
+            _prefetchCorridor.push_back(corridor[tileIndex]);
+    }
+
+    // Tiles that are being warmed for previous corridor are dropped once ready
+    _prefetchCorridorRevision++;
+    _prefetchCorridorNextTileIndex = 0;
+    _prefetchCorridorTilesPerSecond = tilesPerSecond;
+    _prefetchCorridorStopwatch.start();
+}
+
+void OsmAnd::MapRendererResourcesManager::feedPrefetchCorridor(const double passedDistance)
+{
+    // Only map layers that are rasterized from map data are warmed, since other providers are quick enough
+    QList< std::shared_ptr<MapRasterLayerProvider> > rasterLayerProviders;
+    const auto& bindings = _bindings[static_cast<int>(MapRendererResourceType::MapLayer)];
+    for (const auto& bindingEntry : rangeOf(constOf(bindings.providersToCollections)))
+    {
+        if (const auto rasterMapLayerProvider = std::dynamic_pointer_cast<MapRasterLayerProvider>(bindingEntry.key()))
+            rasterLayerProviders.push_back(rasterMapLayerProvider);
+    }
+
+    QList<PrefetchCorridorTile> tilesToWarm;
+    unsigned int revision;
+    {
+        QMutexLocker scopedLocker(&_prefetchCorridorMutex);
+
+        // Data of tiles that were passed is not needed anymore
+        auto itWarmedTile = mutableIteratorOf(_prefetchCorridorWarmedTiles);
+        while (itWarmedTile.hasNext())
+        {
+            const auto& warmedTile = itWarmedTile.next();
+            if (warmedTile.tile.lastDistance >= passedDistance)
+                continue;
+
+            _prefetchCorridorWarmedBytes -= warmedTile.bytes;
+            itWarmedTile.remove();
+        }
+
+        const auto corridorTilesCount = _prefetchCorridor.size();
+        if (_prefetchCorridorNextTileIndex >= corridorTilesCount || rasterLayerProviders.isEmpty())
+            return;
+
+        // Corridor tiles are warmed at limited rate, so that they never take all workers
+        auto allowedTilesCount = static_cast<int>(_prefetchCorridorStopwatch.elapsed() * _prefetchCorridorTilesPerSecond);
+        if (allowedTilesCount <= 0)
+            return;
+        while (allowedTilesCount > 0 && _prefetchCorridorNextTileIndex < corridorTilesCount)
+        {
+            if (_prefetchCorridorWarmedTiles.size() + _prefetchCorridorWarmingTilesCount >= MaxPrefetchCorridorWarmedTilesCount ||
+                _prefetchCorridorWarmedBytes >= MaxPrefetchCorridorWarmedBytes)
+            {
+                break;
+            }
+
+            const auto& tile = _prefetchCorridor[_prefetchCorridorNextTileIndex++];
+            if (tile.lastDistance < passedDistance)
+                continue;
+
+            tilesToWarm.push_back(tile);
+            _prefetchCorridorWarmingTilesCount++;
+            allowedTilesCount--;
+        }
+
+        // Allowance is not accumulated while limits are reached, so that tiles are not warmed in bursts later
+        _prefetchCorridorStopwatch.start();
+        if (tilesToWarm.isEmpty())
+            return;
+        revision = _prefetchCorridorRevision;
+    }
+
+    // Warming has lower priority than any resource request
+    for (const auto& tile : constOf(tilesToWarm))
+    {
+        _resourcesRequestWorkersPool.start(new Concurrent::HostedTask(
+            _taskHostBridge,
+            [this, tile, rasterLayerProviders, revision]
+            (Concurrent::Task* const task)
+            {
+                warmPrefetchCorridorTile(tile, rasterLayerProviders, revision);
+            }),
+            -1);
+    }
+}
+
+void OsmAnd::MapRendererResourcesManager::warmPrefetchCorridorTile(
+    const PrefetchCorridorTile& tile,
+    const QList< std::shared_ptr<MapRasterLayerProvider> >& rasterLayerProviders,
+    const unsigned int revision)
+{
+    PrefetchCorridorWarmedTile warmedTile;
+    warmedTile.tile = tile;
+    warmedTile.bytes = 0;
+    for (const auto& rasterLayerProvider : constOf(rasterLayerProviders))
+    {
+        // Primitives are obtained first without retaining them as recent tiles, otherwise warming would push
+        // recently shown tiles out and leave nothing to derive tiles from. While held, same primitives are reused
+        // for rasterization below and for symbols once tile becomes visible
+        if (!rasterLayerProvider->isDataCached(tile.tileId, tile.zoom))
+        {
+            std::shared_ptr<MapPrimitivesProvider::Data> primitivesData;
+            if (rasterLayerProvider->primitivesProvider->obtainData(
+                    tile.tileId,
+                    tile.zoom,
+                    primitivesData,
+                    nullptr,
+                    nullptr,
+                    false) &&
+                primitivesData)
+            {
+                warmedTile.bytes += estimateWarmedDataBytes(primitivesData);
+                warmedTile.data.push_back(qMove(primitivesData));
+            }
+        }
+
+        // Raster is kept in memory only, it's uploaded to GPU once resource of visible tile takes it
+        std::shared_ptr<MapRasterLayerProvider::Data> rasterData;
+        if (!rasterLayerProvider->obtainData(tile.tileId, tile.zoom, rasterData, nullptr, nullptr) || !rasterData)
+            continue;
+        warmedTile.bytes += estimateWarmedDataBytes(rasterData);
+        warmedTile.rasterData.insert(rasterLayerProvider, qMove(rasterData));
+    }
+
+    QMutexLocker scopedLocker(&_prefetchCorridorMutex);
+
+    _prefetchCorridorWarmingTilesCount--;
+    if (revision != _prefetchCorridorRevision || (warmedTile.data.isEmpty() && warmedTile.rasterData.isEmpty()))
+        return;
+    _prefetchCorridorWarmedBytes += warmedTile.bytes;
+    _prefetchCorridorWarmedTiles.push_back(qMove(warmedTile));
+}
+
+size_t OsmAnd::MapRendererResourcesManager::estimateWarmedDataBytes(
+    const std::shared_ptr<const IMapTiledDataProvider::Data>& data)
+{
+    // Primitives referenced by raster are held and counted separately
+    if (const auto rasterData = std::dynamic_pointer_cast<const IRasterMapLayerProvider::Data>(data))
+        return sizeof(MapRasterLayerProvider::Data) + (rasterData->bitmap ? rasterData->bitmap->getSize() : 0);
+
+    const auto primitivesData = std::dynamic_pointer_cast<const MapPrimitivesProvider::Data>(data);
+    if (!primitivesData)
+        return 0;
+
+    // Map objects may be shared with other tiles, so this is an upper estimate
+    size_t bytes = sizeof(MapPrimitivesProvider::Data);
+    if (primitivesData->mapObjectsData)
+    {
+        for (const auto& mapObject : constOf(primitivesData->mapObjectsData->mapObjects))
+            bytes += sizeof(MapObject) + mapObject->points31.size() * sizeof(PointI);
+    }
+    if (const auto& primitivisedObjects = primitivesData->primitivisedObjects)
+    {
+        const auto primitivesCount =
+            primitivisedObjects->polygons.size() +
+            primitivisedObjects->polylines.size() +
+            primitivisedObjects->points.size();
+        bytes += primitivesCount * sizeof(MapPrimitiviser::Primitive);
+    }
+
+    return bytes;
+}
+
+bool OsmAnd::MapRendererResourcesManager::takePrefetchCorridorWarmedData(
+    const std::shared_ptr<IMapDataProvider>& provider,
+    const TileId tileId,
+    const ZoomLevel zoom,
+    std::shared_ptr<IMapTiledDataProvider::Data>& outTiledData)
+{
+    QMutexLocker scopedLocker(&_prefetchCorridorMutex);
+
+    // Raster is handed over only once, since resource holds it from now on. Primitives remain warmed until tile
+    // is passed, since symbols of tile may still need them
+    for (auto& warmedTile : _prefetchCorridorWarmedTiles)
+    {
+        if (warmedTile.tile.zoom != zoom || warmedTile.tile.tileId != tileId)
+            continue;
+
+        const auto itRasterData = warmedTile.rasterData.find(provider);
+        if (itRasterData == warmedTile.rasterData.end())
+            return false;
+
+        outTiledData = *itRasterData;
+        const auto bytes = estimateWarmedDataBytes(outTiledData);
+        warmedTile.bytes -= bytes;
+        _prefetchCorridorWarmedBytes -= bytes;
+        warmedTile.rasterData.erase(itRasterData);
+        return true;
+    }
+
+    return false;
+}
+
 bool OsmAnd::MapRendererResourcesManager::obtainProviderFor(MapRendererBaseResourcesCollection* const resourcesRef, std::shared_ptr<IMapDataProvider>& provider) const
 {
     assert(resourcesRef != nullptr);
@@ -478,9 +781,10 @@ void OsmAnd::MapRendererResourcesManager::workerThreadProcedure()
 
     while (_workerThreadIsAlive)
     {
-        // Local copy of active zone
+        // Local copy of active zone and all prefetch zones merged
         QSet<TileId> activeTiles;
         ZoomLevel activeZoom;
+        TilesByZoom prefetchTiles;
 
         // Wait until we're unblocked by host
         {
@@ -490,18 +794,26 @@ void OsmAnd::MapRendererResourcesManager::workerThreadProcedure()
             // Copy active zone to local copy
             activeTiles = _activeTiles;
             activeZoom = _activeZoom;
+            for (const auto& prefetchZone : constOf(_prefetchZones))
+            {
+                for (const auto& prefetchZoneEntry : rangeOf(constOf(prefetchZone)))
+                    prefetchTiles[prefetchZoneEntry.key()].unite(prefetchZoneEntry.value());
+            }
         }
         if (!_workerThreadIsAlive)
             break;
 
         // Update resources
-        updateResources(activeTiles, activeZoom);
+        updateResources(activeTiles, activeZoom, prefetchTiles);
     }
 
     _workerThreadId = nullptr;
 }
 
-void OsmAnd::MapRendererResourcesManager::requestNeededResources(const QSet<TileId>& activeTiles, const ZoomLevel activeZoom)
+void OsmAnd::MapRendererResourcesManager::requestNeededResources(
+    const QSet<TileId>& activeTiles,
+    const ZoomLevel activeZoom,
+    const TilesByZoom& prefetchTiles)
 {
     for (const auto& resourcesCollections : constOf(_storageByType))
     {
@@ -515,7 +827,16 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResources(const QSet<Tile
                 continue;
 
             if (const auto tiledResourcesCollection = std::dynamic_pointer_cast<MapRendererTiledResourcesCollection>(resourcesCollection))
+            {
                 requestNeededTiledResources(tiledResourcesCollection, activeTiles, activeZoom);
+
+                // Symbols are not prefetched, since published symbols of invisible tiles would take part in
+                // placement of visible ones
+                if (tiledResourcesCollection->type == MapRendererResourceType::Symbols)
+                    continue;
+                for (const auto& prefetchTilesEntry : rangeOf(constOf(prefetchTiles)))
+                    requestNeededTiledResources(tiledResourcesCollection, prefetchTilesEntry.value(), prefetchTilesEntry.key());
+            }
             else if (const auto keyedResourcesCollection = std::dynamic_pointer_cast<MapRendererKeyedResourcesCollection>(resourcesCollection))
                 requestNeededKeyedResources(keyedResourcesCollection);
         }
@@ -612,15 +933,29 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResource(const std::share
         }
 
         // Ask resource to obtain it's data
+        // Abort as well in case resource has left active zone while being processed
         bool dataAvailable = false;
         FunctorQueryController obtainDataQueryController(
-            [task_]
+            [task_, resource]
             (const FunctorQueryController* const controller) -> bool
             {
-                return task_->isCancellationRequested();
+                return task_->isCancellationRequested() ||
+                    resource->getState() == MapRendererResourceState::RequestCanceledWhileBeingProcessed;
             });
         const auto requestSucceeded = resource->obtainData(dataAvailable, &obtainDataQueryController) && !task->isCancellationRequested();
 
+        // If resource is not needed anymore, let post-execute handler remove it
+        if (!requestSucceeded && resource->getState() == MapRendererResourceState::RequestCanceledWhileBeingProcessed)
+        {
+            {
+                QMutexLocker scopedLocker(&_pendingResourceRequestsMutex);
+                _resourceRequestsQueueMetrics.canceledWhileProcessed++;
+            }
+
+            task->requestCancellation();
+            return;
+        }
+
         // If failed to obtain resource data, remove resource entry to repeat try later
         if (!requestSucceeded)
         {
@@ -693,8 +1028,121 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResource(const std::share
     resource->setState(MapRendererResourceState::Requested);
     LOG_RESOURCE_STATE_CHANGE(resource, ? , MapRendererResourceState::Requested);
 
-    // Finally start the request
-    _resourcesRequestWorkersPool.start(asyncTask);
+    // Finally queue the request
+    enqueueResourceRequest(asyncTask);
+}
+
+void OsmAnd::MapRendererResourcesManager::enqueueResourceRequest(ResourceRequestTask* const task)
+{
+    {
+        QMutexLocker scopedLocker(&_pendingResourceRequestsMutex);
+
+        task->queueStopwatch.start();
+        _pendingResourceRequests.push_back(task);
+    }
+
+    // Each queued request is paired with a dispatch, so a free worker will take the most important request,
+    // not necessarily this one
+    _resourcesRequestWorkersPool.start(new Concurrent::Task(
+        [this]
+        (Concurrent::Task* const dispatchTask)
+        {
+            dispatchResourceRequest();
+        }));
+}
+
+void OsmAnd::MapRendererResourcesManager::dispatchResourceRequest()
+{
+    // Get target of active zone
+    QSet<TileId> activeTiles;
+    TileId targetTileId;
+    ZoomLevel targetZoom;
+    {
+        QMutexLocker scopedLocker(&_workerThreadWakeupMutex);
+
+        activeTiles = _activeTiles;
+        targetTileId = _activeTargetTileId;
+        targetZoom = _activeZoom;
+    }
+
+    ResourceRequestTask* task = nullptr;
+    {
+        QMutexLocker scopedLocker(&_pendingResourceRequestsMutex);
+        assert(!_pendingResourceRequests.isEmpty());
+
+        // Priority of requests is following:
+        //  - canceled requests, since disposing them is cheap and releases resources
+        //  - keyed resources, since these do not depend on active zone
+        //  - tiled resources of active zone
+        //  - other tiled resources (prefetched or left from previous zone) with least difference to active zoom
+        // Tiled resources of same rank are ordered by distance to target tile
+        auto bestIndex = -1;
+        auto bestRank = 0;
+        auto bestZoomDelta = 0;
+        int64_t bestDistanceSquared = 0;
+        const auto pendingResourceRequestsCount = _pendingResourceRequests.size();
+        for (auto index = 0; index < pendingResourceRequestsCount; index++)
+        {
+            const auto pendingTask = _pendingResourceRequests[index];
+            if (pendingTask->isCancellationRequested())
+            {
+                bestIndex = index;
+                break;
+            }
+
+            auto rank = 0;
+            auto zoomDelta = 0;
+            int64_t distanceSquared = 0;
+            if (const auto& tiledResource = pendingTask->requestedTiledResource)
+            {
+                const auto zoomShift = static_cast<int>(tiledResource->zoom) - static_cast<int>(targetZoom);
+                const auto isActive = (zoomShift == 0 && activeTiles.contains(tiledResource->tileId));
+                rank = isActive ? 1 : 2;
+                zoomDelta = qAbs(zoomShift);
+
+                // Target tile is converted to zoom of the resource
+                int64_t targetX = targetTileId.x;
+                int64_t targetY = targetTileId.y;
+                if (zoomShift >= 0)
+                {
+                    targetX <<= zoomShift;
+                    targetY <<= zoomShift;
+                }
+                else
+                {
+                    targetX >>= -zoomShift;
+                    targetY >>= -zoomShift;
+                }
+                const auto dx = static_cast<int64_t>(tiledResource->tileId.x) - targetX;
+                const auto dy = static_cast<int64_t>(tiledResource->tileId.y) - targetY;
+                distanceSquared = dx*dx + dy*dy;
+            }
+
+            if (bestIndex < 0 ||
+                rank < bestRank ||
+                (rank == bestRank && zoomDelta < bestZoomDelta) ||
+                (rank == bestRank && zoomDelta == bestZoomDelta && distanceSquared < bestDistanceSquared))
+            {
+                bestIndex = index;
+                bestRank = rank;
+                bestZoomDelta = zoomDelta;
+                bestDistanceSquared = distanceSquared;
+            }
+        }
+        task = _pendingResourceRequests.takeAt(bestIndex);
+
+        const auto queueLatency = task->queueStopwatch.elapsed();
+        auto& metrics = _resourceRequestsQueueMetrics;
+        metrics.dispatched++;
+        if (task->isCancellationRequested())
+            metrics.canceledWhileQueued++;
+        metrics.totalQueueLatency += queueLatency;
+        metrics.maxQueueLatency = qMax(metrics.maxQueueLatency, queueLatency);
+    }
+
+    // Since task holds the manager, after it's deleted manager may be already gone
+    task->run();
+    delete task;
 }
 
 void OsmAnd::MapRendererResourcesManager::invalidateAllResources()
@@ -839,14 +1287,17 @@ bool OsmAnd::MapRendererResourcesManager::checkForUpdatesAndApply() const
     return (updatesApplied || updatesPresent);
 }
 
-void OsmAnd::MapRendererResourcesManager::updateResources(const QSet<TileId>& tiles, const ZoomLevel zoom)
+void OsmAnd::MapRendererResourcesManager::updateResources(
+    const QSet<TileId>& tiles,
+    const ZoomLevel zoom,
+    const TilesByZoom& prefetchTiles)
 {
     // Before requesting missing tiled resources, clean up cache to free some space
-    cleanupJunkResources(tiles, zoom);
+    cleanupJunkResources(tiles, zoom, prefetchTiles);
 
     // In the end of rendering processing, request tiled resources that are neither
     // present in requested list, nor in pending, nor in uploaded
-    requestNeededResources(tiles, zoom);
+    requestNeededResources(tiles, zoom, prefetchTiles);
 }
 
 unsigned int OsmAnd::MapRendererResourcesManager::unloadResources()
@@ -903,15 +1354,37 @@ void OsmAnd::MapRendererResourcesManager::unloadResourcesFrom(
     }
 }
 
-unsigned int OsmAnd::MapRendererResourcesManager::uploadResources(const unsigned int limit /*= 0u*/, bool* const outMoreThanLimitAvailable /*= nullptr*/)
+unsigned int OsmAnd::MapRendererResourcesManager::uploadResources(
+    const unsigned int limit /*= 0u*/,
+    const size_t bytesLimit /*= 0u*/,
+    const float timeLimit /*= 0.0f*/,
+    bool* const outMoreThanLimitAvailable /*= nullptr*/,
+    size_t* const outBytesUploaded /*= nullptr*/)
 {
     unsigned int totalUploaded = 0u;
+    size_t totalBytesUploaded = 0u;
     bool moreThanLimitAvailable = false;
     bool atLeastOneUploadFailed = false;
+    const Stopwatch stopwatch(timeLimit > 0.0f);
 
     const auto& resourcesCollections = safeGetAllResourcesCollections();
     for (const auto& resourcesCollection : constOf(resourcesCollections))
-        uploadResourcesFrom(resourcesCollection, limit, totalUploaded, moreThanLimitAvailable, atLeastOneUploadFailed);
+    {
+        uploadResourcesFrom(
+            resourcesCollection,
+            limit,
+            bytesLimit,
+            timeLimit,
+            stopwatch,
+            totalUploaded,
+            totalBytesUploaded,
+            moreThanLimitAvailable,
+            atLeastOneUploadFailed);
+
+        // Once budget is exhausted, leave all remaining resources for next call
+        if (moreThanLimitAvailable)
+            break;
+    }
 
     // If any resource failed to upload, report that more ready resources are available
     if (atLeastOneUploadFailed)
@@ -919,28 +1392,38 @@ unsigned int OsmAnd::MapRendererResourcesManager::uploadResources(const unsigned
 
     if (outMoreThanLimitAvailable)
         *outMoreThanLimitAvailable = moreThanLimitAvailable;
+    if (outBytesUploaded)
+        *outBytesUploaded = totalBytesUploaded;
     return totalUploaded;
 }
 
 void OsmAnd::MapRendererResourcesManager::uploadResourcesFrom(
     const std::shared_ptr<MapRendererBaseResourcesCollection>& collection,
     const unsigned int limit,
+    const size_t bytesLimit,
+    const float timeLimit,
+    const Stopwatch& stopwatch,
     unsigned int& totalUploaded,
+    size_t& totalBytesUploaded,
     bool& moreThanLimitAvailable,
     bool& atLeastOneUploadFailed)
 {
-    // Select all resources with "Ready" state
+    // Select all resources with "Ready" state and uploaded resources that have content to replace one in GPU
     QList< std::shared_ptr<MapRendererBaseResource> > resources;
     collection->obtainResources(&resources,
         [&resources, limit, totalUploaded, &moreThanLimitAvailable]
         (const std::shared_ptr<MapRendererBaseResource>& entry, bool& cancel) -> bool
         {
             // Skip not-ready resources
-            if (entry->getState() != MapRendererResourceState::Ready)
+            const auto state = entry->getState();
+            if (state != MapRendererResourceState::Ready &&
+                !(state == MapRendererResourceState::Uploaded && entry->gpuUpdatePending()))
+            {
                 return false;
+            }
 
             // Check if limit was reached
-            if (limit > 0 && (totalUploaded + resources.size()) > limit)
+            if (limit > 0 && (totalUploaded + resources.size()) >= limit)
             {
                 // Tell that more resources are available for upload
                 moreThanLimitAvailable = true;
@@ -958,10 +1441,30 @@ void OsmAnd::MapRendererResourcesManager::uploadResourcesFrom(
     // Upload to GPU all selected resources
     for (const auto& resource : constOf(resources))
     {
-        // Since state change is allowed (it's not changed to "Uploading" during query), check state here
-        if (!resource->setStateIf(MapRendererResourceState::Ready, MapRendererResourceState::Uploading))
+        // Since state change is allowed (it's not changed to "Uploading" during query), check state here.
+        // While uploaded resource is being updated, it's not used for rendering
+        const auto isUpdate = resource->gpuUpdatePending() &&
+            resource->setStateIf(MapRendererResourceState::Uploaded, MapRendererResourceState::Uploading);
+        if (!isUpdate && !resource->setStateIf(MapRendererResourceState::Ready, MapRendererResourceState::Uploading))
             continue;
-        LOG_RESOURCE_STATE_CHANGE(resource, MapRendererResourceState::Ready, MapRendererResourceState::Uploading);
+        const auto previousState = isUpdate ? MapRendererResourceState::Uploaded : MapRendererResourceState::Ready;
+        LOG_RESOURCE_STATE_CHANGE(resource, previousState, MapRendererResourceState::Uploading);
+
+        // Check if budget allows this upload. At least one resource is always uploaded, otherwise resource
+        // that is larger than entire budget would never be uploaded
+        const auto uploadCost = resource->estimateGpuUploadCost();
+        const auto budgetExhausted =
+            (bytesLimit > 0 && totalBytesUploaded + uploadCost > bytesLimit) ||
+            (timeLimit > 0.0f && stopwatch.elapsed() >= timeLimit);
+        if (totalUploaded > 0 && budgetExhausted)
+        {
+            // Return resource back to previous state, so that it will be uploaded next time
+            resource->setState(previousState);
+            LOG_RESOURCE_STATE_CHANGE(resource, MapRendererResourceState::Uploading, previousState);
+
+            moreThanLimitAvailable = true;
+            break;
+        }
 
         // Actually upload resource to GPU
         const auto didUpload = resource->uploadToGPU();
@@ -969,6 +1472,13 @@ void OsmAnd::MapRendererResourcesManager::uploadResourcesFrom(
             atLeastOneUploadFailed = true;
         if (!didUpload)
         {
+            // Failed update leaves previous content in GPU, so resource is still usable
+            if (isUpdate)
+            {
+                resource->setState(MapRendererResourceState::Uploaded);
+                LOG_RESOURCE_STATE_CHANGE(resource, MapRendererResourceState::Uploading, MapRendererResourceState::Uploaded);
+            }
+
             if (const auto tiledResource = std::dynamic_pointer_cast<const MapRendererBaseTiledResource>(resource))
             {
                 LogPrintf(LogSeverityLevel::Error,
@@ -997,10 +1507,14 @@ void OsmAnd::MapRendererResourcesManager::uploadResourcesFrom(
 
         // Count uploaded resources
         totalUploaded++;
+        totalBytesUploaded += uploadCost;
     }
 }
 
-void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(const QSet<TileId>& activeTiles, const ZoomLevel activeZoom)
+void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
+    const QSet<TileId>& activeTiles,
+    const ZoomLevel activeZoom,
+    const TilesByZoom& prefetchTiles)
 {
     // This method is called from non-GPU thread, so it's impossible to unload resources from GPU here
     bool needsResourcesUploadOrUnload = false;
@@ -1036,7 +1550,7 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(const QSet<TileId
             const auto dataSourceAvailable = isDataSourceAvailableFor(resourcesCollection);
 
             resourcesCollection->removeResources(
-                [this, dataSourceAvailable, activeTiles, activeZoom, &needsResourcesUploadOrUnload]
+                [this, dataSourceAvailable, activeTiles, activeZoom, &prefetchTiles, &needsResourcesUploadOrUnload]
                 (const std::shared_ptr<MapRendererBaseResource>& entry, bool& cancel) -> bool
                 {
                     // Resource with "Unloaded" state is junk, regardless if it's needed or not
@@ -1057,9 +1571,15 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(const QSet<TileId
                     // If data source is gone, all resources from it are considered junk:
                     isJunk = isJunk || !dataSourceAvailable;
 
-                    // If resource is not in set of "needed tiles", it's junk:
+                    // If resource is neither in set of "needed tiles", nor in prefetch zone, it's junk:
                     if (const auto tiledEntry = std::dynamic_pointer_cast<MapRendererBaseTiledResource>(entry))
-                        isJunk = isJunk || !(activeTiles.contains(tiledEntry->tileId) && tiledEntry->zoom == activeZoom);
+                    {
+                        const auto isActive = (tiledEntry->zoom == activeZoom && activeTiles.contains(tiledEntry->tileId));
+                        const auto citPrefetchTiles = prefetchTiles.constFind(tiledEntry->zoom);
+                        const auto isPrefetched =
+                            (citPrefetchTiles != prefetchTiles.cend() && citPrefetchTiles->contains(tiledEntry->tileId));
+                        isJunk = isJunk || !(isActive || isPrefetched);
+                    }
 
                     // Skip cleaning if this resource is not junk
                     if (!isJunk)
@@ -1349,9 +1869,12 @@ void OsmAnd::MapRendererResourcesManager::releaseAllResources()
 
 void OsmAnd::MapRendererResourcesManager::syncResourcesInGPU(
     const unsigned int limitUploads /*= 0u*/,
+    const size_t limitUploadsBytes /*= 0u*/,
+    const float limitUploadsTime /*= 0.0f*/,
     bool* const outMoreUploadsThanLimitAvailable /*= nullptr*/,
     unsigned int* const outResourcesUploaded /*= nullptr*/,
-    unsigned int* const outResourcesUnloaded /*= nullptr*/)
+    unsigned int* const outResourcesUnloaded /*= nullptr*/,
+    size_t* const outBytesUploaded /*= nullptr*/)
 {
     // Unload resources
     const auto resourcesUnloaded = unloadResources();
@@ -1359,7 +1882,12 @@ void OsmAnd::MapRendererResourcesManager::syncResourcesInGPU(
         *outResourcesUnloaded = resourcesUnloaded;
 
     // Upload resources
-    const auto resourcesUploaded = uploadResources(limitUploads, outMoreUploadsThanLimitAvailable);
+    const auto resourcesUploaded = uploadResources(
+        limitUploads,
+        limitUploadsBytes,
+        limitUploadsTime,
+        outMoreUploadsThanLimitAvailable,
+        outBytesUploaded);
     if (outResourcesUploaded)
         *outResourcesUploaded = resourcesUploaded;
 }
@@ -1503,6 +2031,37 @@ void OsmAnd::MapRendererResourcesManager::dumpResourcesInfo() const
     resourceStateMap.insert(MapRendererResourceState::JustBeforeDeath, QLatin1String("JustBeforeDeath"));
 
     QString dump;
+    {
+        QMutexLocker scopedLocker(&_pendingResourceRequestsMutex);
+        const auto& metrics = _resourceRequestsQueueMetrics;
+
+        dump += QString(QLatin1String("Requests: %1 pending, %2 dispatched (%3 canceled while queued, %4 canceled while processed), queue latency %5s avg, %6s max\n")).
+            arg(_pendingResourceRequests.size()).
+            arg(metrics.dispatched).
+            arg(metrics.canceledWhileQueued).
+            arg(metrics.canceledWhileProcessed).
+            arg(metrics.dispatched > 0 ? metrics.totalQueueLatency / metrics.dispatched : 0.0f).
+            arg(metrics.maxQueueLatency);
+    }
+    const auto atlasTexturesPoolsStatistics = renderer->gpuAPI->getAtlasTexturesPoolsStatistics();
+    for (const auto& itAtlasTexturesPoolStatistics : rangeOf(constOf(atlasTexturesPoolsStatistics)))
+    {
+        const auto& typeId = itAtlasTexturesPoolStatistics.key();
+        const auto& statistics = itAtlasTexturesPoolStatistics.value();
+
+        dump += QString(QLatin1String("Atlas textures %1 (tile %2, padding %3): %4 textures (%5 sparse), %6 of %7 slots used (%8%), %9 freed, %10 migrated, %11 textures released\n")).
+            arg(typeId.id, 16, 16, QLatin1Char('0')).
+            arg(typeId.tileSize).
+            arg(typeId.tilePadding).
+            arg(statistics.atlasTexturesCount).
+            arg(statistics.sparseAtlasTexturesCount).
+            arg(statistics.usedSlotsCount).
+            arg(statistics.slotsCount).
+            arg(statistics.getOccupancy() * 100.0f).
+            arg(statistics.freedSlotsCount).
+            arg(statistics.migratedSlotsCount).
+            arg(statistics.releasedAtlasTexturesCount);
+    }
     dump += QLatin1String("Resources:\n");
     dump += QLatin1String("--------------------------------------------------------------------------------\n");
 
@@ -1581,6 +2140,7 @@ OsmAnd::MapRendererResourcesManager::ResourceRequestTask::ResourceRequestTask(
     : HostedTask(bridge_, executeMethod_, preExecuteMethod_, postExecuteMethod_)
     , manager(reinterpret_cast<const MapRendererResourcesManager*>(lockedOwner))
     , requestedResource(requestedResource_)
+    , requestedTiledResource(std::dynamic_pointer_cast<MapRendererBaseTiledResource>(requestedResource_))
 {
     manager->_resourcesRequestTasksCounter.fetchAndAddOrdered(1);
 }
@@ -1589,3 +2149,12 @@ OsmAnd::MapRendererResourcesManager::ResourceRequestTask::~ResourceRequestTask()
 {
     manager->_resourcesRequestTasksCounter.fetchAndSubOrdered(1);
 }
+
+OsmAnd::MapRendererResourcesManager::ResourceRequestsQueueMetrics::ResourceRequestsQueueMetrics()
+    : dispatched(0)
+    , canceledWhileQueued(0)
+    , canceledWhileProcessed(0)
+    , totalQueueLatency(0.0f)
+    , maxQueueLatency(0.0f)
+{
+}
@@ -8,9 +8,12 @@
 #include "QtExtensions.h"
 #include <QList>
 #include <QHash>
+#include <QMap>
 #include <QSet>
+#include <QPair>
 #include <QThreadPool>
 #include <QReadWriteLock>
+#include <QMutex>
 #include <QWaitCondition>
 
 #include "OsmAndCore.h"
@@ -34,6 +37,7 @@
 #include "KeyedEntriesCollection.h"
 #include "SharedResourcesContainer.h"
 #include "Concurrent.h"
+#include "Stopwatch.h"
 #include "IQueryController.h"
 
 namespace OsmAnd
@@ -41,6 +45,7 @@ namespace OsmAnd
     class AtlasMapRenderer;
     class MapRenderer;
     class IMapDataProvider;
+    class MapRasterLayerProvider;
     class TiledMapSymbolsData;
     class MapSymbolsGroup;
     class MapSymbol;
@@ -51,6 +56,25 @@ namespace OsmAnd
 
     public:
         typedef std::array< QList< std::shared_ptr<MapRendererBaseResourcesCollection> >, MapRendererResourceTypesCount > ResourcesStorage;
+        typedef QMap< ZoomLevel, QSet<TileId> > TilesByZoom;
+
+        // Tiles that are not visible but are expected to become visible soon. Resources for them are requested
+        // with lower priority than for active zone, and are kept while tiles remain in prefetch zone.
+        enum class PrefetchZone
+        {
+            AnimationPath,
+        };
+
+        // Tile covered by corridor along path. Distances along path at which corridor covers tile first and last
+        // time are kept, so that it's known when tile has been passed.
+        struct PrefetchCorridorTile
+        {
+            ZoomLevel zoom;
+            TileId tileId;
+            double firstDistance;
+            double lastDistance;
+        };
+        typedef QList<PrefetchCorridorTile> PrefetchCorridor;
 
     private:
         // Resource-requests related:
@@ -73,8 +97,30 @@ namespace OsmAnd
 
             const MapRendererResourcesManager* const manager;
             const std::shared_ptr<MapRendererBaseResource> requestedResource;
+            const std::shared_ptr<MapRendererBaseTiledResource> requestedTiledResource;
+
+            // Measures time spent in queue of pending requests
+            Stopwatch queueStopwatch;
         };
 
+        // Requests are not started on workers pool as they come, but are kept in queue and the most important one
+        // is taken each time a worker becomes free. Priority is evaluated against active zone at that moment, so
+        // queue is implicitly reordered each time active zone changes.
+        mutable QMutex _pendingResourceRequestsMutex;
+        QList<ResourceRequestTask*> _pendingResourceRequests;
+        struct ResourceRequestsQueueMetrics
+        {
+            ResourceRequestsQueueMetrics();
+
+            unsigned int dispatched;
+            unsigned int canceledWhileQueued;
+            unsigned int canceledWhileProcessed;
+            float totalQueueLatency;
+            float maxQueueLatency;
+        } _resourceRequestsQueueMetrics;
+        void enqueueResourceRequest(ResourceRequestTask* const task);
+        void dispatchResourceRequest();
+
         // Each provider has a binded resource collection, and these are bindings:
         struct Binding
         {
@@ -115,24 +161,78 @@ namespace OsmAnd
         // Resources management:
         QSet<TileId> _activeTiles;
         ZoomLevel _activeZoom;
+        TileId _activeTargetTileId;
+
+        // Tiles derived from nearby zoom are worth showing only shortly after zoom was changed: later on, tiles of
+        // nearby zoom are either gone or belong to another area, and deriving would only delay actual tiles
+        enum {
+            DeriveTilesAfterZoomChangePeriodMs = 2000,
+        };
+        bool _activeZoomChanged;
+        Stopwatch _activeZoomChangeStopwatch;
+        bool isDerivingTilesAllowed(const ZoomLevel zoom) const;
+        QMap<PrefetchZone, TilesByZoom> _prefetchZones;
+
+        // Tiles of prefetch corridor are not turned into resources and never uploaded to GPU: primitives and
+        // rasters of map layers are obtained in advance and held in memory, and raster is handed over to resource
+        // once tile becomes visible. Amount of held data is limited, and data of passed tiles is released.
+        enum {
+            MaxPrefetchCorridorWarmedTilesCount = 128,
+            MaxPrefetchCorridorWarmedBytes = 32 * 1024 * 1024,
+        };
+        struct PrefetchCorridorWarmedTile
+        {
+            PrefetchCorridorTile tile;
+            QList< std::shared_ptr<IMapTiledDataProvider::Data> > data;
+            QHash< std::shared_ptr<IMapDataProvider>, std::shared_ptr<IMapTiledDataProvider::Data> > rasterData;
+            size_t bytes;
+        };
+        mutable QMutex _prefetchCorridorMutex;
+        PrefetchCorridor _prefetchCorridor;
+        unsigned int _prefetchCorridorRevision;
+        int _prefetchCorridorNextTileIndex;
+        float _prefetchCorridorTilesPerSecond;
+        Stopwatch _prefetchCorridorStopwatch;
+        QList<PrefetchCorridorWarmedTile> _prefetchCorridorWarmedTiles;
+        size_t _prefetchCorridorWarmedBytes;
+        unsigned int _prefetchCorridorWarmingTilesCount;
+        void warmPrefetchCorridorTile(
+            const PrefetchCorridorTile& tile,
+            const QList< std::shared_ptr<MapRasterLayerProvider> >& rasterLayerProviders,
+            const unsigned int revision);
+        static size_t estimateWarmedDataBytes(const std::shared_ptr<const IMapTiledDataProvider::Data>& data);
+        bool takePrefetchCorridorWarmedData(
+            const std::shared_ptr<IMapDataProvider>& provider,
+            const TileId tileId,
+            const ZoomLevel zoom,
+            std::shared_ptr<IMapTiledDataProvider::Data>& outTiledData);
         bool updatesPresent() const;
         bool checkForUpdatesAndApply() const;
-        void updateResources(const QSet<TileId>& tiles, const ZoomLevel zoom);
-        void requestNeededResources(const QSet<TileId>& activeTiles, const ZoomLevel activeZoom);
+        void updateResources(const QSet<TileId>& tiles, const ZoomLevel zoom, const TilesByZoom& prefetchTiles);
+        void requestNeededResources(const QSet<TileId>& activeTiles, const ZoomLevel activeZoom, const TilesByZoom& prefetchTiles);
         void requestNeededTiledResources(const std::shared_ptr<MapRendererTiledResourcesCollection>& resourcesCollection, const QSet<TileId>& activeTiles, const ZoomLevel activeZoom);
         void requestNeededKeyedResources(const std::shared_ptr<MapRendererKeyedResourcesCollection>& resourcesCollection);
         void requestNeededResource(const std::shared_ptr<MapRendererBaseResource>& resource);
-        void cleanupJunkResources(const QSet<TileId>& activeTiles, const ZoomLevel activeZoom);
+        void cleanupJunkResources(const QSet<TileId>& activeTiles, const ZoomLevel activeZoom, const TilesByZoom& prefetchTiles);
         bool cleanupJunkResource(const std::shared_ptr<MapRendererBaseResource>& resource, bool& needsResourcesUploadOrUnload);
         unsigned int unloadResources();
         void unloadResourcesFrom(
             const std::shared_ptr<MapRendererBaseResourcesCollection>& collection,
             unsigned int& totalUnloaded);
-        unsigned int uploadResources(const unsigned int limit = 0u, bool* const outMoreThanLimitAvailable = nullptr);
+        unsigned int uploadResources(
+            const unsigned int limit = 0u,
+            const size_t bytesLimit = 0u,
+            const float timeLimit = 0.0f,
+            bool* const outMoreThanLimitAvailable = nullptr,
+            size_t* const outBytesUploaded = nullptr);
         void uploadResourcesFrom(
             const std::shared_ptr<MapRendererBaseResourcesCollection>& collection,
             const unsigned int limit,
+            const size_t bytesLimit,
+            const float timeLimit,
+            const Stopwatch& stopwatch,
             unsigned int& totalUploaded,
+            size_t& totalBytesUploaded,
             bool& moreThanLimitAvailable,
             bool& atLeastOneUploadFailed);
         void blockingReleaseResourcesFrom(const std::shared_ptr<MapRendererBaseResourcesCollection>& collection);
@@ -159,18 +259,27 @@ namespace OsmAnd
         // Resources management:
         bool uploadTiledDataToGPU(const std::shared_ptr<const IMapTiledDataProvider::Data>& mapTile, std::shared_ptr<const GPUAPI::ResourceInGPU>& outResourceInGPU);
         bool uploadSymbolToGPU(const std::shared_ptr<const MapSymbol>& mapSymbol, std::shared_ptr<const GPUAPI::ResourceInGPU>& outResourceInGPU);
+        static size_t estimateTiledDataUploadCost(const std::shared_ptr<const IMapTiledDataProvider::Data>& mapTile);
+        static size_t estimateSymbolUploadCost(const std::shared_ptr<const MapSymbol>& mapSymbol);
         std::shared_ptr<const SkBitmap> adjustBitmapToConfiguration(
             const std::shared_ptr<const SkBitmap>& input,
             const AlphaChannelPresence alphaChannelPresence) const;
         void releaseGpuUploadableDataFrom(const std::shared_ptr<MapSymbol>& mapSymbol);
 
         void updateBindings(const MapRendererState& state, const MapRendererStateChanges updatedMask);
-        void updateActiveZone(const QSet<TileId>& tiles, const ZoomLevel zoom);
+        void updateActiveZone(const QSet<TileId>& tiles, const ZoomLevel zoom, const TileId targetTileId);
+        void updatePrefetchZone(const PrefetchZone zone, const TilesByZoom& tiles);
+        void setPrefetchCorridor(const PrefetchCorridor& corridor, const float tilesPerSecond);
+        // Called each frame with distance along corridor path that has been passed already
+        void feedPrefetchCorridor(const double passedDistance);
         void syncResourcesInGPU(
             const unsigned int limitUploads = 0u,
+            const size_t limitUploadsBytes = 0u,
+            const float limitUploadsTime = 0.0f,
             bool* const outMoreUploadsThanLimitAvailable = nullptr,
             unsigned int* const outResourcesUploaded = nullptr,
-            unsigned int* const outResourcesUnloaded = nullptr);
+            unsigned int* const outResourcesUnloaded = nullptr,
+            size_t* const outBytesUploaded = nullptr);
 
         std::shared_ptr<const MapRendererBaseResourcesCollection> getCollection(
             const MapRendererResourceType type,
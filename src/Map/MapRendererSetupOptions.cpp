@@ -4,6 +4,8 @@ OsmAnd::MapRendererSetupOptions::MapRendererSetupOptions()
     : gpuWorkerThreadEnabled(false)
     , gpuWorkerThreadPrologue(nullptr)
     , gpuWorkerThreadEpilogue(nullptr)
+    , maxGpuUploadBytesPerFrame(2 * 1024 * 1024)
+    , maxGpuUploadTimePerFrame(4000)
     , frameUpdateRequestCallback(nullptr)
     , maxNumberOfRasterMapLayersInBatch(0)
 {
@@ -8,10 +8,12 @@ OsmAnd::MapRendererStage::MapRendererStage(MapRenderer* const renderer_)
     , setupOptions(renderer->setupOptions)
     , currentConfiguration(renderer->currentConfiguration)
     , currentState(renderer->currentState)
+    , currentStateRevision(renderer->currentStateRevision)
     , internalState(renderer->getInternalState())
     , debugSettings(renderer->currentDebugSettings)
     , publishedMapSymbolsByOrderLock(renderer->publishedMapSymbolsByOrderLock)
     , publishedMapSymbolsByOrder(renderer->publishedMapSymbolsByOrder)
+    , mapSymbolsUpdatesRevision(renderer->mapSymbolsUpdatesRevision)
 {
 }
 
@@ -24,6 +26,11 @@ const OsmAnd::MapRendererResourcesManager& OsmAnd::MapRendererStage::getResource
     return renderer->getResources();
 }
 
+unsigned int OsmAnd::MapRendererStage::getPublishedMapSymbolsRevision() const
+{
+    return renderer->getPublishedMapSymbolsRevision();
+}
+
 void OsmAnd::MapRendererStage::invalidateFrame()
 {
     renderer->invalidateFrame();
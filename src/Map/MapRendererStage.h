@@ -36,10 +36,13 @@ namespace OsmAnd
         const MapRendererSetupOptions& setupOptions;
         const std::shared_ptr<const MapRendererConfiguration>& currentConfiguration;
         const MapRendererState& currentState;
+        const unsigned int& currentStateRevision;
         const MapRendererInternalState& internalState;
         const std::shared_ptr<const MapRendererDebugSettings>& debugSettings;
         QReadWriteLock& publishedMapSymbolsByOrderLock;
         const MapRenderer::PublishedMapSymbolsByOrder& publishedMapSymbolsByOrder;
+        const unsigned int& mapSymbolsUpdatesRevision;
+        unsigned int getPublishedMapSymbolsRevision() const;
 
         virtual bool initialize() = 0;
         virtual bool render(IMapRenderer_Metrics::Metric_renderFrame* const metric) = 0;
@@ -5,6 +5,7 @@
 #include "IMapDataProvider.h"
 #include "IMapTiledSymbolsProvider.h"
 #include "RasterMapSymbol.h"
+#include "OnPathRasterMapSymbol.h"
 #include "MapRendererResourcesManager.h"
 #include "MapRendererBaseResourcesCollection.h"
 #include "MapRendererTiledSymbolsResourcesCollection.h"
@@ -110,7 +111,9 @@ bool OsmAnd::MapRendererTiledSymbolsResource::obtainData(bool& dataAvailable, co
     if (!dataAvailable)
         return true;
 
-    // Convert data
+    // Convert data. Also compute view-independent data of on-path symbols here, on worker thread, instead of doing
+    // that each frame on render thread. Paths are usually shared by several symbols, so each is processed once
+    QHash< std::shared_ptr< const QVector<PointI> >, std::shared_ptr< const QVector<float> > > pathsSegmentsLengths31;
     for (const auto& symbolsGroup : constOf(_sourceData->symbolsGroups))
     {
         for (const auto& mapSymbol : constOf(symbolsGroup->symbols))
@@ -122,6 +125,18 @@ bool OsmAnd::MapRendererTiledSymbolsResource::obtainData(bool& dataAvailable, co
             rasterMapSymbol->bitmap = resourcesManager->adjustBitmapToConfiguration(
                 rasterMapSymbol->bitmap,
                 AlphaChannelPresence::Present);
+
+            const auto onPathMapSymbol = std::dynamic_pointer_cast<OnPathRasterMapSymbol>(rasterMapSymbol);
+            if (!onPathMapSymbol || !onPathMapSymbol->shareablePath31 || onPathMapSymbol->hasPathSegmentsLengths31())
+                continue;
+
+            auto& pathSegmentsLengths31 = pathsSegmentsLengths31[onPathMapSymbol->shareablePath31];
+            if (!pathSegmentsLengths31)
+            {
+                pathSegmentsLengths31.reset(new QVector<float>(
+                    OnPathRasterMapSymbol::computePathSegmentsLengths31(*onPathMapSymbol->shareablePath31)));
+            }
+            onPathMapSymbol->shareablePathSegmentsLengths31 = pathSegmentsLengths31;
         }
     }
 
@@ -388,6 +403,29 @@ bool OsmAnd::MapRendererTiledSymbolsResource::uploadToGPU()
     return true;
 }
 
+size_t OsmAnd::MapRendererTiledSymbolsResource::estimateGpuUploadCost() const
+{
+    size_t cost = 0;
+
+    for (const auto& groupResources : constOf(_uniqueGroupsResources))
+    {
+        for (const auto& symbol : constOf(groupResources->group->symbols))
+            cost += resourcesManager->estimateSymbolUploadCost(symbol);
+    }
+
+    for (const auto& groupResources : constOf(_referencedSharedGroupsResources))
+    {
+        // Shared symbols that were already uploaded by other resource are only referenced
+        if (!groupResources->resourcesInGPU.isEmpty())
+            continue;
+
+        for (const auto& symbol : constOf(groupResources->group->symbols))
+            cost += resourcesManager->estimateSymbolUploadCost(symbol);
+    }
+
+    return cost;
+}
+
 void OsmAnd::MapRendererTiledSymbolsResource::unloadFromGPU()
 {
     const auto link_ = link.lock();
@@ -67,6 +67,7 @@ namespace OsmAnd
 
         virtual bool obtainData(bool& dataAvailable, const IQueryController* queryController);
         virtual bool uploadToGPU();
+        virtual size_t estimateGpuUploadCost() const;
         virtual void unloadFromGPU();
         virtual void releaseData();
     public:
@@ -0,0 +1,351 @@
+#include "MapSurfaceTypeMask.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QFile>
+#include <QDataStream>
+#include "restore_internal_warnings.h"
+
+#include "IObfsCollection.h"
+#include "ObfDataInterface.h"
+#include "ObfReader.h"
+#include "ObfInfo.h"
+#include "ObfMapSectionInfo.h"
+#include "ObfMapSectionReader.h"
+#include "IQueryController.h"
+#include "Utilities.h"
+#include "Logging.h"
+
+namespace OsmAnd
+{
+    // "OSTM" signature followed by format version
+    static const quint32 MapSurfaceTypeMaskSignature = 0x4F53544Du;
+    static const quint32 MapSurfaceTypeMaskVersion = 2u;
+}
+
+OsmAnd::MapSurfaceTypeMask::MapSurfaceTypeMask(const ZoomLevel maxZoom_, const Entry root_, const QVector<Entry>& nodes_)
+    : _root(root_)
+    , _nodes(nodes_)
+    , maxZoom(maxZoom_)
+{
+}
+
+OsmAnd::MapSurfaceTypeMask::~MapSurfaceTypeMask()
+{
+}
+
+OsmAnd::MapSurfaceTypeMask::Entry OsmAnd::MapSurfaceTypeMask::encodeSurfaceType(const MapSurfaceType surfaceType)
+{
+    return static_cast<Entry>(static_cast<int>(surfaceType) + 1);
+}
+
+OsmAnd::MapSurfaceType OsmAnd::MapSurfaceTypeMask::decodeSurfaceType(const Entry entry)
+{
+    return static_cast<MapSurfaceType>(static_cast<int>(entry & EntrySurfaceTypeMask) - 1);
+}
+
+OsmAnd::MapSurfaceType OsmAnd::MapSurfaceTypeMask::getSurfaceType(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    bool* const outHasNoBasemapObjects /*= nullptr*/) const
+{
+    auto entry = _root;
+    const auto depth = qMin(zoom, maxZoom);
+    for (int level = 1; level <= depth; level++)
+    {
+        const auto childrenNodeIndex = entry >> EntryChildrenShift;
+        if (decodeSurfaceType(entry) != MapSurfaceType::Mixed || childrenNodeIndex == 0)
+            break;
+
+        const auto shift = zoom - level;
+        const auto childX = (tileId.x >> shift) & 0x1;
+        const auto childY = (tileId.y >> shift) & 0x1;
+        entry = _nodes[(childrenNodeIndex - 1) * 4 + (childY << 1) + childX];
+    }
+
+    if (outHasNoBasemapObjects)
+        *outHasNoBasemapObjects = (entry & EntryNoObjectsFlag) != 0;
+    return decodeSurfaceType(entry);
+}
+
+bool OsmAnd::MapSurfaceTypeMask::saveTo(const QString& fileName) const
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to open '%s' to save surface type mask",
+            qPrintable(fileName));
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << MapSurfaceTypeMaskSignature;
+    stream << MapSurfaceTypeMaskVersion;
+    stream << static_cast<quint32>(maxZoom);
+    stream << static_cast<quint32>(_root);
+    stream << static_cast<quint32>(_nodes.size());
+    for (const auto& entry : constOf(_nodes))
+        stream << static_cast<quint32>(entry);
+
+    return (stream.status() == QDataStream::Ok);
+}
+
+std::shared_ptr<const OsmAnd::MapSurfaceTypeMask> OsmAnd::MapSurfaceTypeMask::loadFrom(const QString& fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return nullptr;
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 signature = 0;
+    quint32 version = 0;
+    stream >> signature >> version;
+    if (signature != MapSurfaceTypeMaskSignature || version != MapSurfaceTypeMaskVersion)
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "'%s' is not a surface type mask or has unsupported version %d",
+            qPrintable(fileName),
+            version);
+        return nullptr;
+    }
+
+    quint32 maxZoom = 0;
+    quint32 root = 0;
+    quint32 nodesCount = 0;
+    stream >> maxZoom >> root >> nodesCount;
+    if (maxZoom > MaxZoomLevel || (nodesCount % 4) != 0)
+        return nullptr;
+
+    QVector<Entry> nodes(nodesCount);
+    for (auto& entry : nodes)
+    {
+        quint32 value = 0;
+        stream >> value;
+        entry = value;
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Surface type mask '%s' is truncated",
+            qPrintable(fileName));
+        return nullptr;
+    }
+
+    // Verify that all references to children are valid
+    const auto isValidEntry =
+        [nodesCount]
+        (const Entry entry) -> bool
+        {
+            return (entry >> EntryChildrenShift) <= (nodesCount / 4);
+        };
+    if (!isValidEntry(root))
+        return nullptr;
+    for (const auto& entry : constOf(nodes))
+    {
+        if (!isValidEntry(entry))
+            return nullptr;
+    }
+
+    return std::shared_ptr<const MapSurfaceTypeMask>(new MapSurfaceTypeMask(
+        static_cast<ZoomLevel>(maxZoom),
+        root,
+        nodes));
+}
+
+std::shared_ptr<const OsmAnd::MapSurfaceTypeMask> OsmAnd::MapSurfaceTypeMask::buildFromBasemap(
+    const std::shared_ptr<const ObfReader>& basemapReader,
+    const ZoomLevel maxZoom,
+    const IQueryController* const controller /*= nullptr*/)
+{
+    const auto& obfInfo = basemapReader->obtainInfo();
+    if (!obfInfo || !obfInfo->isBasemap)
+    {
+        LogPrintf(LogSeverityLevel::Error, "Surface type mask can be built only from basemap");
+        return nullptr;
+    }
+
+    // Objects themselves are not needed, only surface types of tree nodes
+    const FilterBinaryMapObjectsByIdFunction rejectAllFilter =
+        []
+        (const std::shared_ptr<const ObfMapSectionInfo>& section,
+        const ObfObjectId id,
+        const AreaI& bbox,
+        const ZoomLevel firstZoomLevel,
+        const ZoomLevel lastZoomLevel) -> bool
+        {
+            return false;
+        };
+    const auto obtainTileBBox31 =
+        []
+        (const TileId tileId, const ZoomLevel zoom) -> AreaI
+        {
+            // Bounding box of the only tile on ZoomLevel0 can not be computed by shifting
+            return (zoom == ZoomLevel0)
+                ? AreaI(0, 0, std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::max())
+                : Utilities::tileBoundingBox31(tileId, zoom);
+        };
+    const auto obtainTileSurfaceType =
+        [basemapReader, obfInfo, rejectAllFilter, obtainTileBBox31, controller]
+        (const TileId tileId, const ZoomLevel zoom) -> MapSurfaceType
+        {
+            const auto tileBBox31 = obtainTileBBox31(tileId, zoom);
+
+            auto mergedSurfaceType = MapSurfaceType::Undefined;
+            for (const auto& mapSection : constOf(obfInfo->mapSections))
+            {
+                auto surfaceTypeToMerge = MapSurfaceType::Undefined;
+                ObfMapSectionReader::loadMapObjects(
+                    basemapReader,
+                    mapSection,
+                    static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel),
+                    &tileBBox31,
+                    nullptr,
+                    &surfaceTypeToMerge,
+                    rejectAllFilter,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    controller);
+                if (surfaceTypeToMerge == MapSurfaceType::Undefined)
+                    continue;
+
+                if (mergedSurfaceType == MapSurfaceType::Undefined)
+                    mergedSurfaceType = surfaceTypeToMerge;
+                else if (mergedSurfaceType != surfaceTypeToMerge)
+                    mergedSurfaceType = MapSurfaceType::Mixed;
+            }
+
+            return mergedSurfaceType;
+        };
+
+    // Tile has no basemap objects if none of basemap levels used for this tile or any of its children (on any
+    // zoom) has objects in it. Zooms more detailed than basemap read tile of MaxBasemapZoomLevel that covers them
+    const auto hasNoObjects =
+        [basemapReader, obfInfo, obtainTileBBox31, controller]
+        (const TileId tileId, const ZoomLevel zoom) -> bool
+        {
+            const auto basemapZoom = qMin(zoom, static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel));
+            const auto tileBBox31 = obtainTileBBox31(
+                TileId::fromXY(tileId.x >> (zoom - basemapZoom), tileId.y >> (zoom - basemapZoom)),
+                basemapZoom);
+
+            bool hasObjects = false;
+            const FilterBinaryMapObjectsByIdFunction detectObjectsFilter =
+                [tileBBox31, &hasObjects]
+                (const std::shared_ptr<const ObfMapSectionInfo>& section,
+                const ObfObjectId id,
+                const AreaI& bbox,
+                const ZoomLevel firstZoomLevel,
+                const ZoomLevel lastZoomLevel) -> bool
+                {
+                    if (bbox.intersects(tileBBox31))
+                        hasObjects = true;
+                    return false;
+                };
+            for (const auto& mapSection : constOf(obfInfo->mapSections))
+            {
+                for (const auto& level : constOf(mapSection->levels))
+                {
+                    if (level->maxZoom < basemapZoom)
+                        continue;
+
+                    ObfMapSectionReader::loadMapObjects(
+                        basemapReader,
+                        mapSection,
+                        qBound(level->minZoom, basemapZoom, level->maxZoom),
+                        &tileBBox31,
+                        nullptr,
+                        nullptr,
+                        detectObjectsFilter,
+                        nullptr,
+                        nullptr,
+                        nullptr,
+                        controller);
+                    if (hasObjects)
+                        return false;
+                }
+            }
+
+            return true;
+        };
+
+    QVector<Entry> nodes;
+    const std::function<Entry(const TileId, const ZoomLevel)> buildEntry =
+        [maxZoom, controller, &nodes, &buildEntry, &obtainTileSurfaceType, &hasNoObjects]
+        (const TileId tileId, const ZoomLevel zoom) -> Entry
+        {
+            const auto surfaceType = obtainTileSurfaceType(tileId, zoom);
+            auto entry = encodeSurfaceType(surfaceType);
+            if ((surfaceType == MapSurfaceType::FullLand || surfaceType == MapSurfaceType::FullWater) &&
+                hasNoObjects(tileId, zoom))
+            {
+                entry |= EntryNoObjectsFlag;
+            }
+            if (surfaceType != MapSurfaceType::Mixed || zoom >= maxZoom)
+                return entry;
+            if (controller && controller->isAborted())
+                return entry;
+
+            // Reserve node for children first, since building children appends their nodes
+            const auto nodeIndex = nodes.size() / 4;
+            nodes.resize(nodes.size() + 4);
+            for (int childIdx = 0; childIdx < 4; childIdx++)
+            {
+                const auto childTileId = TileId::fromXY(
+                    (tileId.x << 1) + (childIdx & 0x1),
+                    (tileId.y << 1) + (childIdx >> 1));
+                const auto childEntry = buildEntry(childTileId, static_cast<ZoomLevel>(zoom + 1));
+                nodes[nodeIndex * 4 + childIdx] = childEntry;
+            }
+
+            entry |= static_cast<Entry>(nodeIndex + 1) << EntryChildrenShift;
+            return entry;
+        };
+    const auto root = buildEntry(TileId::fromXY(0, 0), ZoomLevel0);
+
+    if (controller && controller->isAborted())
+        return nullptr;
+
+    return std::shared_ptr<const MapSurfaceTypeMask>(new MapSurfaceTypeMask(
+        qMin(maxZoom, MaxZoomLevel),
+        root,
+        nodes));
+}
+
+std::shared_ptr<const OsmAnd::MapSurfaceTypeMask> OsmAnd::MapSurfaceTypeMask::obtain(
+    const std::shared_ptr<const IObfsCollection>& obfsCollection,
+    const QString& fileName /*= QString::null*/,
+    const ZoomLevel maxZoom /*= static_cast<ZoomLevel>(DefaultMaxZoom)*/,
+    const IQueryController* const controller /*= nullptr*/)
+{
+    if (!fileName.isEmpty() && QFile::exists(fileName))
+    {
+        if (const auto mask = loadFrom(fileName))
+            return mask;
+    }
+
+    std::shared_ptr<const ObfReader> basemapReader;
+    const auto dataInterface = obfsCollection->obtainDataInterface();
+    for (const auto& obfReader : constOf(dataInterface->obfReaders))
+    {
+        if (!obfReader->obtainInfo()->isBasemap)
+            continue;
+
+        basemapReader = obfReader;
+        break;
+    }
+    if (!basemapReader)
+    {
+        LogPrintf(LogSeverityLevel::Warning, "No basemap available to build surface type mask from");
+        return nullptr;
+    }
+
+    const auto mask = buildFromBasemap(basemapReader, maxZoom, controller);
+    if (mask && !fileName.isEmpty())
+        mask->saveTo(fileName);
+    return mask;
+}
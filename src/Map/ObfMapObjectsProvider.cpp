@@ -2,13 +2,16 @@
 #include "ObfMapObjectsProvider_P.h"
 
 #include "ObfMapObjectsProvider_Metrics.h"
+#include "MapSurfaceTypeMask.h"
 
 OsmAnd::ObfMapObjectsProvider::ObfMapObjectsProvider(
     const std::shared_ptr<const IObfsCollection>& obfsCollection_,
-    const Mode mode_ /*= Mode::BinaryMapObjectsAndRoads*/)
+    const Mode mode_ /*= Mode::BinaryMapObjectsAndRoads*/,
+    const std::shared_ptr<const MapSurfaceTypeMask>& surfaceTypeMask_ /*= nullptr*/)
     : _p(new ObfMapObjectsProvider_P(this))
     , obfsCollection(obfsCollection_)
     , mode(mode_)
+    , surfaceTypeMask(surfaceTypeMask_)
 {
 }
 
@@ -8,12 +8,15 @@
 
 #include "ObfsCollection.h"
 #include "ObfDataInterface.h"
+#include "ObfReader.h"
+#include "ObfInfo.h"
 #include "ObfMapSectionInfo.h"
 #include "ObfMapSectionReader_Metrics.h"
 #include "BinaryMapObject.h"
 #include "ObfRoutingSectionInfo.h"
 #include "ObfRoutingSectionReader_Metrics.h"
 #include "Road.h"
+#include "MapSurfaceTypeMask.h"
 #include "Stopwatch.h"
 #include "Utilities.h"
 #include "Logging.h"
@@ -107,6 +110,27 @@ bool OsmAnd::ObfMapObjectsProvider_P::obtainData(
     // General:
     auto tileSurfaceType = MapSurfaceType::Undefined;
 
+    // Precomputed surface type mask knows fully land or fully water tiles regardless of OBFs that cover this tile.
+    // In case basemap has no objects in such tile and no other OBF has data for it, there's nothing to read
+    auto maskSurfaceType = MapSurfaceType::Undefined;
+    auto hasNoBasemapObjects = false;
+    if (owner->surfaceTypeMask)
+        maskSurfaceType = owner->surfaceTypeMask->getSurfaceType(tileId, zoom, &hasNoBasemapObjects);
+    const auto isFullLandOrFullWater =
+        (maskSurfaceType == MapSurfaceType::FullLand || maskSurfaceType == MapSurfaceType::FullWater);
+    auto skipReadOut = isFullLandOrFullWater && hasNoBasemapObjects;
+    if (skipReadOut)
+    {
+        for (const auto& obfReader : constOf(dataInterface->obfReaders))
+        {
+            if (obfReader->obtainInfo()->isBasemap)
+                continue;
+
+            skipReadOut = false;
+            break;
+        }
+    }
+
     // BinaryMapObjects:
     QList< std::shared_ptr< const ObfMapSectionReader::DataBlock > > referencedBinaryMapObjectsDataBlocks;
     QList< std::shared_ptr<const BinaryMapObject> > referencedBinaryMapObjects;
@@ -263,7 +287,11 @@ bool OsmAnd::ObfMapObjectsProvider_P::obtainData(
             return true;
         };
 
-    if (owner->mode == ObfMapObjectsProvider::Mode::OnlyBinaryMapObjects)
+    if (skipReadOut)
+    {
+        // Nothing to read, surface type is taken from mask
+    }
+    else if (owner->mode == ObfMapObjectsProvider::Mode::OnlyBinaryMapObjects)
     {
         Ref<ObfMapSectionReader_Metrics::Metric_loadMapObjects> loadMapObjectsMetric;
         if (metric)
@@ -335,6 +363,11 @@ bool OsmAnd::ObfMapObjectsProvider_P::obtainData(
             loadRoadsMetric.get());
     }
 
+    // Surface type computed from read-out data is more precise than mask one, which above mask resolution is taken
+    // from coarser tile
+    if (isFullLandOrFullWater && (skipReadOut || tileSurfaceType == MapSurfaceType::Undefined))
+        tileSurfaceType = maskSurfaceType;
+
     // Process loaded-and-shared map objects (both binary and roads)
     for (auto& binaryMapObject : loadedBinaryMapObjects)
     {
@@ -1,5 +1,10 @@
 #include "OnPathRasterMapSymbol.h"
 
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QtMath>
+#include "restore_internal_warnings.h"
+
 OsmAnd::OnPathRasterMapSymbol::OnPathRasterMapSymbol(
     const std::shared_ptr<MapSymbolsGroup>& group_)
     : RasterMapSymbol(group_)
@@ -23,11 +28,41 @@ std::shared_ptr< const QVector<OsmAnd::PointI> > OsmAnd::OnPathRasterMapSymbol::
 void OsmAnd::OnPathRasterMapSymbol::setPath31(const QVector<PointI>& newPath31)
 {
     shareablePath31.reset(new QVector<PointI>(newPath31));
+    shareablePathSegmentsLengths31.reset();
 }
 
 void OsmAnd::OnPathRasterMapSymbol::setPath31(const std::shared_ptr< const QVector<PointI> >& newSharedPath31)
 {
     shareablePath31 = newSharedPath31;
+    shareablePathSegmentsLengths31.reset();
+}
+
+bool OsmAnd::OnPathRasterMapSymbol::hasPathSegmentsLengths31() const
+{
+    return shareablePath31 && shareablePathSegmentsLengths31 &&
+        shareablePathSegmentsLengths31->size() == shareablePath31->size() - 1;
+}
+
+QVector<float> OsmAnd::OnPathRasterMapSymbol::computePathSegmentsLengths31(const QVector<PointI>& path31)
+{
+    const auto segmentsCount = path31.size() - 1;
+    if (segmentsCount <= 0)
+        return QVector<float>();
+    QVector<float> lengths(segmentsCount);
+
+    auto pPoint31 = path31.constData();
+    auto pPrevPoint31 = pPoint31++;
+    auto pLength = lengths.data();
+    for (auto segmentIdx = 0; segmentIdx < segmentsCount; segmentIdx++)
+    {
+        const auto dx = static_cast<double>(pPoint31->x) - static_cast<double>(pPrevPoint31->x);
+        const auto dy = static_cast<double>(pPoint31->y) - static_cast<double>(pPrevPoint31->y);
+        *(pLength++) = static_cast<float>(qSqrt(dx*dx + dy*dy));
+
+        pPrevPoint31 = pPoint31++;
+    }
+
+    return lengths;
 }
 
 OsmAnd::OnPathRasterMapSymbol::PinPoint OsmAnd::OnPathRasterMapSymbol::getPinPointOnPath() const
@@ -298,6 +298,21 @@ bool OsmAnd::AtlasMapRenderer_OpenGL::updateInternalState(
     return true;
 }
 
+bool OsmAnd::AtlasMapRenderer_OpenGL::obtainVisibleTiles(
+    const MapRendererState& state,
+    const MapRendererConfiguration& configuration,
+    QSet<TileId>& outUniqueTiles) const
+{
+    InternalState internalState;
+    if (!updateInternalState(internalState, state, configuration))
+        return false;
+
+    for (const auto& tileId : constOf(internalState.visibleTiles))
+        outUniqueTiles.insert(Utilities::normalizeTileId(tileId, state.zoomBase));
+
+    return true;
+}
+
 const OsmAnd::MapRendererInternalState* OsmAnd::AtlasMapRenderer_OpenGL::getInternalStateRef() const
 {
     return &_internalState;
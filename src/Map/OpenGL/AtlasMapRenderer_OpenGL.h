@@ -71,6 +71,11 @@ namespace OsmAnd
 
         virtual double getCurrentTileSizeInMeters() const;
         virtual double getCurrentPixelsToMetersScaleFactor() const;
+
+        virtual bool obtainVisibleTiles(
+            const MapRendererState& state,
+            const MapRendererConfiguration& configuration,
+            QSet<TileId>& outUniqueTiles) const;
     };
 }
 
@@ -817,6 +817,91 @@ bool OsmAnd::GPUAPI_OpenGL::releaseResourceInGPU(const ResourceInGPU::Type type,
     return false;
 }
 
+bool OsmAnd::GPUAPI_OpenGL::copyAtlasTextureSlot(
+    const std::shared_ptr<const AtlasTextureInGPU>& sourceAtlasTexture,
+    const uint32_t sourceSlotIndex,
+    const std::shared_ptr<const AtlasTextureInGPU>& targetAtlasTexture,
+    const uint32_t targetSlotIndex)
+{
+    GL_CHECK_PRESENT(glGetIntegerv);
+    GL_CHECK_PRESENT(glGenFramebuffers);
+    GL_CHECK_PRESENT(glBindFramebuffer);
+    GL_CHECK_PRESENT(glFramebufferTexture2D);
+    GL_CHECK_PRESENT(glCheckFramebufferStatus);
+    GL_CHECK_PRESENT(glDeleteFramebuffers);
+    GL_CHECK_PRESENT(glBindTexture);
+    GL_CHECK_PRESENT(glCopyTexSubImage2D);
+
+    // Both atlas textures belong to same pool, so slots have same size (including padding) and layout
+    assert(sourceAtlasTexture->pool == targetAtlasTexture->pool);
+    const auto slotSize = sourceAtlasTexture->tileSize + 2 * sourceAtlasTexture->padding;
+    const auto sourceRowIndex = sourceSlotIndex / sourceAtlasTexture->slotsPerSide;
+    const auto sourceColIndex = sourceSlotIndex - sourceRowIndex * sourceAtlasTexture->slotsPerSide;
+    const auto targetRowIndex = targetSlotIndex / targetAtlasTexture->slotsPerSide;
+    const auto targetColIndex = targetSlotIndex - targetRowIndex * targetAtlasTexture->slotsPerSide;
+
+    // Copying is done by reading from framebuffer that has source atlas texture attached
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+    GL_CHECK_RESULT;
+
+    GLuint framebuffer;
+    glGenFramebuffers(1, &framebuffer);
+    GL_CHECK_RESULT;
+    assert(framebuffer != 0);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    GL_CHECK_RESULT;
+
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+        static_cast<GLuint>(reinterpret_cast<intptr_t>(sourceAtlasTexture->refInGPU)), 0);
+    GL_CHECK_RESULT;
+
+    // Not every texture format is color-renderable, e.g. luminance or float textures may be not
+    const auto isFramebufferComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    GL_CHECK_RESULT;
+    if (isFramebufferComplete)
+    {
+        glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(reinterpret_cast<intptr_t>(targetAtlasTexture->refInGPU)));
+        GL_CHECK_RESULT;
+
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0,
+            targetColIndex * slotSize, targetRowIndex * slotSize,
+            sourceColIndex * slotSize, sourceRowIndex * slotSize,
+            slotSize, slotSize);
+        GL_CHECK_RESULT;
+
+        glBindTexture(GL_TEXTURE_2D, 0);
+        GL_CHECK_RESULT;
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(previousFramebuffer));
+    GL_CHECK_RESULT;
+
+    glDeleteFramebuffers(1, &framebuffer);
+    GL_CHECK_RESULT;
+
+    return isFramebufferComplete;
+}
+
+void OsmAnd::GPUAPI_OpenGL::updateAtlasTextureMipmaps(const std::shared_ptr<const AtlasTextureInGPU>& atlasTexture)
+{
+    GL_CHECK_PRESENT(glBindTexture);
+    GL_CHECK_PRESENT(glGenerateMipmap);
+
+    if (atlasTexture->mipmapLevels <= 1)
+        return;
+
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(reinterpret_cast<intptr_t>(atlasTexture->refInGPU)));
+    GL_CHECK_RESULT;
+
+    glGenerateMipmap(GL_TEXTURE_2D);
+    GL_CHECK_RESULT;
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    GL_CHECK_RESULT;
+}
+
 bool OsmAnd::GPUAPI_OpenGL::uploadTiledDataAsTextureToGPU(const std::shared_ptr< const IMapTiledDataProvider::Data >& tile, std::shared_ptr< const ResourceInGPU >& resourceInGPU)
 {
     GL_CHECK_PRESENT(glGenTextures);
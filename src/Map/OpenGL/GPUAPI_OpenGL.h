@@ -253,6 +253,12 @@ namespace OsmAnd
         GLint _maxVertexAttribs;
         
         virtual bool releaseResourceInGPU(const ResourceInGPU::Type type, const RefInGPU& refInGPU);
+        virtual bool copyAtlasTextureSlot(
+            const std::shared_ptr<const AtlasTextureInGPU>& sourceAtlasTexture,
+            const uint32_t sourceSlotIndex,
+            const std::shared_ptr<const AtlasTextureInGPU>& targetAtlasTexture,
+            const uint32_t targetSlotIndex);
+        virtual void updateAtlasTextureMipmaps(const std::shared_ptr<const AtlasTextureInGPU>& atlasTexture);
 
         virtual void glPushGroupMarkerEXT_wrapper(GLsizei length, const GLchar* marker) = 0;
         virtual void glPopGroupMarkerEXT_wrapper() = 0;
@@ -0,0 +1,46 @@
+#include "RasterTilesDiskCache.h"
+#include "RasterTilesDiskCache_P.h"
+
+OsmAnd::RasterTilesDiskCache::RasterTilesDiskCache(
+    const QString& path_,
+    const uint64_t maxSize_ /*= DefaultMaxSizeInMegabytes * 1024 * 1024*/)
+    : _p(new RasterTilesDiskCache_P(this))
+    , path(path_)
+    , maxSize(maxSize_)
+{
+    _p->initialize();
+}
+
+OsmAnd::RasterTilesDiskCache::~RasterTilesDiskCache()
+{
+}
+
+bool OsmAnd::RasterTilesDiskCache::containsEntry(const QString& key) const
+{
+    return _p->containsEntry(key);
+}
+
+bool OsmAnd::RasterTilesDiskCache::obtainEntry(const QString& key, QByteArray& outData)
+{
+    return _p->obtainEntry(key, outData);
+}
+
+bool OsmAnd::RasterTilesDiskCache::storeEntry(const QString& key, const QByteArray& data)
+{
+    return _p->storeEntry(key, data);
+}
+
+void OsmAnd::RasterTilesDiskCache::clear()
+{
+    _p->clear();
+}
+
+uint64_t OsmAnd::RasterTilesDiskCache::getTotalSize() const
+{
+    return _p->getTotalSize();
+}
+
+unsigned int OsmAnd::RasterTilesDiskCache::getEntriesCount() const
+{
+    return _p->getEntriesCount();
+}
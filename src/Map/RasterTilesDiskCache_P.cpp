@@ -0,0 +1,192 @@
+#include "RasterTilesDiskCache_P.h"
+#include "RasterTilesDiskCache.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include "restore_internal_warnings.h"
+
+#include "QKeyValueIterator.h"
+#include "Logging.h"
+
+OsmAnd::RasterTilesDiskCache_P::RasterTilesDiskCache_P(RasterTilesDiskCache* const owner_)
+    : _nextAccessStamp(0)
+    , _totalSize(0)
+    , owner(owner_)
+{
+}
+
+OsmAnd::RasterTilesDiskCache_P::~RasterTilesDiskCache_P()
+{
+}
+
+void OsmAnd::RasterTilesDiskCache_P::initialize()
+{
+    const QDir cacheDir(owner->path);
+    if (!cacheDir.mkpath(QLatin1String(".")))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to create raster tiles disk cache directory '%s'",
+            qPrintable(owner->path));
+        return;
+    }
+
+    // Restore usage order of entries left from previous sessions by their modification time
+    QMap< qint64, QList<QString> > keysByModificationTime;
+    QDirIterator itFile(owner->path, QStringList() << QLatin1String("*.tile"), QDir::Files, QDirIterator::Subdirectories);
+    while (itFile.hasNext())
+    {
+        const QFileInfo fileInfo(itFile.next());
+
+        auto key = cacheDir.relativeFilePath(fileInfo.absoluteFilePath());
+        key.chop(5);
+
+        Entry entry;
+        entry.size = static_cast<uint64_t>(fileInfo.size());
+        _entries.insert(key, entry);
+        _totalSize += entry.size;
+
+        keysByModificationTime[fileInfo.lastModified().toMSecsSinceEpoch()].append(key);
+    }
+    for (const auto& keys : constOf(keysByModificationTime))
+    {
+        for (const auto& key : constOf(keys))
+            touchEntry(key, _entries[key]);
+    }
+
+    removeLeastRecentlyUsedEntries(QString());
+}
+
+QString OsmAnd::RasterTilesDiskCache_P::getEntryFilePath(const QString& key) const
+{
+    return owner->path + QLatin1Char('/') + key + QLatin1String(".tile");
+}
+
+void OsmAnd::RasterTilesDiskCache_P::touchEntry(const QString& key, Entry& entry)
+{
+    if (entry.accessStamp != 0)
+        _entriesByAccessStamp.remove(entry.accessStamp);
+    entry.accessStamp = ++_nextAccessStamp;
+    _entriesByAccessStamp.insert(entry.accessStamp, key);
+}
+
+void OsmAnd::RasterTilesDiskCache_P::removeEntry(const QString& key)
+{
+    const auto itEntry = _entries.find(key);
+    if (itEntry == _entries.end())
+        return;
+
+    _entriesByAccessStamp.remove(itEntry->accessStamp);
+    _totalSize -= itEntry->size;
+    _entries.erase(itEntry);
+
+    QFile::remove(getEntryFilePath(key));
+}
+
+void OsmAnd::RasterTilesDiskCache_P::removeLeastRecentlyUsedEntries(const QString& keyToKeep)
+{
+    auto itEntryKey = _entriesByAccessStamp.begin();
+    while (_totalSize > owner->maxSize && itEntryKey != _entriesByAccessStamp.end())
+    {
+        const auto key = *itEntryKey;
+        if (key == keyToKeep)
+        {
+            ++itEntryKey;
+            continue;
+        }
+
+        removeEntry(key);
+        itEntryKey = _entriesByAccessStamp.begin();
+    }
+}
+
+bool OsmAnd::RasterTilesDiskCache_P::containsEntry(const QString& key) const
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    return _entries.contains(key);
+}
+
+bool OsmAnd::RasterTilesDiskCache_P::obtainEntry(const QString& key, QByteArray& outData)
+{
+    {
+        QMutexLocker scopedLocker(&_entriesMutex);
+
+        const auto itEntry = _entries.find(key);
+        if (itEntry == _entries.end())
+            return false;
+        touchEntry(key, *itEntry);
+    }
+
+    QFile file(getEntryFilePath(key));
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        // File was removed in the meanwhile, so forget about this entry
+        QMutexLocker scopedLocker(&_entriesMutex);
+
+        removeEntry(key);
+        return false;
+    }
+    outData = file.readAll();
+    file.close();
+
+    return true;
+}
+
+bool OsmAnd::RasterTilesDiskCache_P::storeEntry(const QString& key, const QByteArray& data)
+{
+    // Entry is written to temporary file first, so that partially written entries are never read
+    const auto filePath = getEntryFilePath(key);
+    QFileInfo(filePath).dir().mkpath(QLatin1String("."));
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit())
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to store raster tile to '%s'",
+            qPrintable(filePath));
+        return false;
+    }
+
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    auto& entry = _entries[key];
+    if (entry.accessStamp != 0)
+        _totalSize -= entry.size;
+    entry.size = static_cast<uint64_t>(data.size());
+    _totalSize += entry.size;
+    touchEntry(key, entry);
+
+    removeLeastRecentlyUsedEntries(key);
+
+    return true;
+}
+
+void OsmAnd::RasterTilesDiskCache_P::clear()
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    for (const auto& entry : rangeOf(constOf(_entries)))
+        QFile::remove(getEntryFilePath(entry.key()));
+    _entries.clear();
+    _entriesByAccessStamp.clear();
+    _totalSize = 0;
+}
+
+uint64_t OsmAnd::RasterTilesDiskCache_P::getTotalSize() const
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    return _totalSize;
+}
+
+unsigned int OsmAnd::RasterTilesDiskCache_P::getEntriesCount() const
+{
+    QMutexLocker scopedLocker(&_entriesMutex);
+
+    return _entries.size();
+}
@@ -0,0 +1,68 @@
+#ifndef _OSMAND_CORE_RASTER_TILES_DISK_CACHE_P_H_
+#define _OSMAND_CORE_RASTER_TILES_DISK_CACHE_P_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "PrivateImplementation.h"
+
+namespace OsmAnd
+{
+    class RasterTilesDiskCache;
+    class RasterTilesDiskCache_P Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(RasterTilesDiskCache_P);
+    private:
+    protected:
+        RasterTilesDiskCache_P(RasterTilesDiskCache* const owner);
+
+        struct Entry
+        {
+            Entry()
+                : size(0)
+                , accessStamp(0)
+            {
+            }
+
+            uint64_t size;
+            uint64_t accessStamp;
+        };
+
+        mutable QMutex _entriesMutex;
+        QHash<QString, Entry> _entries;
+        QMap<uint64_t, QString> _entriesByAccessStamp;
+        uint64_t _nextAccessStamp;
+        uint64_t _totalSize;
+
+        void initialize();
+
+        QString getEntryFilePath(const QString& key) const;
+        void touchEntry(const QString& key, Entry& entry);
+        void removeEntry(const QString& key);
+        void removeLeastRecentlyUsedEntries(const QString& keyToKeep);
+    public:
+        ~RasterTilesDiskCache_P();
+
+        ImplementationInterface<RasterTilesDiskCache> owner;
+
+        bool containsEntry(const QString& key) const;
+        bool obtainEntry(const QString& key, QByteArray& outData);
+        bool storeEntry(const QString& key, const QByteArray& data);
+        void clear();
+
+        uint64_t getTotalSize() const;
+        unsigned int getEntriesCount() const;
+
+    friend class OsmAnd::RasterTilesDiskCache;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_RASTER_TILES_DISK_CACHE_P_H_)
@@ -509,3 +509,82 @@ void OsmAnd::Utilities::scanlineFillPolygon(const unsigned int verticesCount, co
     for(const auto& edge : constOf(edges))
         delete edge;
 }
+
+bool OsmAnd::Utilities::simplifyPolyline(const QVector<PointI>& points, const double tolerance, QVector<PointI>& outSimplifiedPoints)
+{
+    // Douglas-Peucker simplification, performed without recursion. First and last vertices are always kept,
+    // so closed polylines remain closed.
+    const auto pointsCount = points.size();
+    if (pointsCount <= 2 || tolerance <= 0.0)
+        return false;
+
+    const auto squaredTolerance = tolerance * tolerance;
+    const auto pPoints = points.constData();
+
+    QVector<bool> keepPoint(pointsCount, false);
+    keepPoint[0] = true;
+    keepPoint[pointsCount - 1] = true;
+    auto keptPointsCount = 2;
+
+    QVector< std::pair<int, int> > pendingRanges;
+    pendingRanges.push_back(std::make_pair(0, pointsCount - 1));
+    while (!pendingRanges.isEmpty())
+    {
+        const auto range = pendingRanges.last();
+        pendingRanges.pop_back();
+        if (range.second - range.first < 2)
+            continue;
+
+        const auto& p0 = pPoints[range.first];
+        const auto& p1 = pPoints[range.second];
+        const auto dx = static_cast<double>(p1.x) - static_cast<double>(p0.x);
+        const auto dy = static_cast<double>(p1.y) - static_cast<double>(p0.y);
+        const auto squaredSegmentLength = dx*dx + dy*dy;
+
+        // Find vertex that is the most distant from segment p0-p1
+        auto farthestPointIdx = -1;
+        auto farthestSquaredDistance = -1.0;
+        for (auto pointIdx = range.first + 1; pointIdx < range.second; pointIdx++)
+        {
+            const auto& p = pPoints[pointIdx];
+            const auto px = static_cast<double>(p.x) - static_cast<double>(p0.x);
+            const auto py = static_cast<double>(p.y) - static_cast<double>(p0.y);
+
+            auto squaredDistance = px*px + py*py;
+            if (squaredSegmentLength > 0.0)
+            {
+                const auto t = qBound(0.0, (px*dx + py*dy) / squaredSegmentLength, 1.0);
+                const auto ex = px - t*dx;
+                const auto ey = py - t*dy;
+                squaredDistance = ex*ex + ey*ey;
+            }
+
+            if (squaredDistance > farthestSquaredDistance)
+            {
+                farthestSquaredDistance = squaredDistance;
+                farthestPointIdx = pointIdx;
+            }
+        }
+
+        if (farthestSquaredDistance <= squaredTolerance)
+            continue;
+
+        keepPoint[farthestPointIdx] = true;
+        keptPointsCount++;
+        pendingRanges.push_back(std::make_pair(range.first, farthestPointIdx));
+        pendingRanges.push_back(std::make_pair(farthestPointIdx, range.second));
+    }
+
+    if (keptPointsCount == pointsCount)
+        return false;
+
+    outSimplifiedPoints.clear();
+    outSimplifiedPoints.reserve(keptPointsCount);
+    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++)
+    {
+        if (keepPoint[pointIdx])
+            outSimplifiedPoints.push_back(pPoints[pointIdx]);
+    }
+
+    return true;
+}
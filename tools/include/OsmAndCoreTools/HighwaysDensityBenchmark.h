@@ -0,0 +1,70 @@
+#ifndef _OSMAND_CORE_TOOLS_HIGHWAYS_DENSITY_BENCHMARK_H_
+#define _OSMAND_CORE_TOOLS_HIGHWAYS_DENSITY_BENCHMARK_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <iostream>
+#include <sstream>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QString>
+#include <QStringList>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+
+#include <OsmAndCoreTools.h>
+
+namespace OsmAndTools
+{
+    // Times filtering out of highways by density (as primitiviser does it for 'roadDensityZoomTile' and
+    // 'roadsDensityLimitPerTile' style constants) on synthetic dense urban tile: using hash of density cells and
+    // removing rejected lines one by one, and using flat density grid and compacting accepted lines in one pass.
+    // Both ways must keep exactly same lines, otherwise benchmark fails
+    class OSMAND_CORE_TOOLS_API HighwaysDensityBenchmark Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(HighwaysDensityBenchmark);
+
+    public:
+        struct OSMAND_CORE_TOOLS_API Configuration Q_DECL_FINAL
+        {
+            Configuration();
+
+            OsmAnd::ZoomLevel zoom;
+            unsigned int roadDensityZoomTile;
+            unsigned int roadsDensityLimitPerTile;
+            unsigned int linesCount;
+            unsigned int minPointsCount;
+            unsigned int maxPointsCount;
+            float highwaysFraction;
+            unsigned int iterationsCount;
+            unsigned int seed;
+            bool verbose;
+
+            static bool parseFromCommandLineArguments(
+                const QStringList& commandLineArgs,
+                Configuration& outConfiguration,
+                QString& outError);
+        };
+
+    private:
+#if defined(_UNICODE) || defined(UNICODE)
+        bool run(std::wostream& output);
+#else
+        bool run(std::ostream& output);
+#endif
+    protected:
+    public:
+        HighwaysDensityBenchmark(const Configuration& configuration);
+        ~HighwaysDensityBenchmark();
+
+        const Configuration configuration;
+
+        bool run(QString *pLog = nullptr);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TOOLS_HIGHWAYS_DENSITY_BENCHMARK_H_)
@@ -0,0 +1,69 @@
+#ifndef _OSMAND_CORE_TOOLS_INTERSECTIONS_BENCHMARK_H_
+#define _OSMAND_CORE_TOOLS_INTERSECTIONS_BENCHMARK_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <iostream>
+#include <sstream>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QString>
+#include <QStringList>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+
+#include <OsmAndCoreTools.h>
+
+namespace OsmAndTools
+{
+    // Times placement of synthetic dense set of labels on screen (test for intersection with already placed ones,
+    // then insert) and hit-testing of placed labels, using both UniformGrid and QuadTree as intersections index.
+    // Both indices must place exactly same labels, otherwise benchmark fails
+    class OSMAND_CORE_TOOLS_API IntersectionsBenchmark Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(IntersectionsBenchmark);
+
+    public:
+        struct OSMAND_CORE_TOOLS_API Configuration Q_DECL_FINAL
+        {
+            Configuration();
+
+            OsmAnd::PointI viewportSize;
+            unsigned int symbolsCount;
+            OsmAnd::PointI minSymbolSize;
+            OsmAnd::PointI maxSymbolSize;
+            float orientedSymbolsFraction;
+            int cellSize;
+            unsigned int hitTestsCount;
+            unsigned int iterationsCount;
+            unsigned int seed;
+            bool verbose;
+
+            static bool parseFromCommandLineArguments(
+                const QStringList& commandLineArgs,
+                Configuration& outConfiguration,
+                QString& outError);
+        };
+
+    private:
+#if defined(_UNICODE) || defined(UNICODE)
+        bool run(std::wostream& output);
+#else
+        bool run(std::ostream& output);
+#endif
+    protected:
+    public:
+        IntersectionsBenchmark(const Configuration& configuration);
+        ~IntersectionsBenchmark();
+
+        const Configuration configuration;
+
+        bool run(QString *pLog = nullptr);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TOOLS_INTERSECTIONS_BENCHMARK_H_)
@@ -0,0 +1,138 @@
+#ifndef _OSMAND_CORE_TOOLS_TILE_SERVER_H_
+#define _OSMAND_CORE_TOOLS_TILE_SERVER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <iostream>
+#include <sstream>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QCache>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QHostAddress>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/IObfsCollection.h>
+#include <OsmAndCore/Map/IMapStylesCollection.h>
+
+#include <OsmAndCoreTools.h>
+
+class QTcpSocket;
+
+namespace OsmAnd
+{
+    class MapRasterLayerProvider_Software;
+}
+
+namespace OsmAndTools
+{
+    // Serves '/z/x/y.png' raster tiles over HTTP. Tiles are rendered by software rasterizer on a bounded pool of
+    // workers, concurrent requests of same tile wait for single rendering, and recently served tiles are kept in
+    // memory cache
+    class OSMAND_CORE_TOOLS_API TileServer Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(TileServer);
+
+    public:
+        struct OSMAND_CORE_TOOLS_API Configuration Q_DECL_FINAL
+        {
+            Configuration();
+
+            std::shared_ptr<OsmAnd::IObfsCollection> obfsCollection;
+            std::shared_ptr<OsmAnd::IMapStylesCollection> stylesCollection;
+            QString styleName;
+            QHash< QString, QString > styleSettings;
+            QHostAddress address;
+            quint16 port;
+            unsigned int renderThreadsCount;
+            unsigned int connectionThreadsCount;
+            unsigned int memoryCacheSizeInMegabytes;
+            // Directory of primitivised tiles that are kept between runs, none if empty
+            QString primitivesCachePath;
+            // File of land/water surface type mask, built from basemap if missing. No mask is used if empty
+            QString surfaceTypeMaskPath;
+            unsigned int metatileSize;
+            unsigned int referenceTileSize;
+            float displayDensityFactor;
+            QString locale;
+            bool verbose;
+
+            static bool parseFromCommandLineArguments(
+                const QStringList& commandLineArgs,
+                Configuration& outConfiguration,
+                QString& outError);
+        };
+
+    private:
+        enum {
+            // Time to wait for next request on kept-alive connection
+            KeepAliveTimeoutInMilliseconds = 5000,
+
+            // Maximal size of request headers
+            MaxRequestSizeInBytes = 8192,
+        };
+
+        // Tile that is being rendered, shared by all requests that wait for it
+        struct PendingTile
+        {
+            PendingTile();
+
+            bool isReady;
+            QByteArray data;
+        };
+
+        // Tile identifier and zoom
+        typedef QPair<uint64_t, int> TileKey;
+
+        QAtomicInt _stopRequested;
+
+        QThreadPool _connectionsPool;
+        QThreadPool _renderPool;
+
+        std::shared_ptr<OsmAnd::MapRasterLayerProvider_Software> _rasterLayerProvider;
+
+        mutable QMutex _tilesMutex;
+        QWaitCondition _pendingTileReady;
+        QCache<TileKey, QByteArray> _tilesCache;
+        QHash<TileKey, std::shared_ptr<PendingTile> > _pendingTiles;
+
+        QAtomicInt _requestsCount;
+        QAtomicInt _cacheHitsCount;
+        QAtomicInt _coalescedRequestsCount;
+        QAtomicInt _renderedTilesCount;
+
+        void handleConnection(QTcpSocket& socket);
+        bool obtainTile(const OsmAnd::TileId tileId, const OsmAnd::ZoomLevel zoom, QByteArray& outData);
+        QByteArray renderTile(const OsmAnd::TileId tileId, const OsmAnd::ZoomLevel zoom);
+
+#if defined(_UNICODE) || defined(UNICODE)
+        bool serve(std::wostream& output);
+#else
+        bool serve(std::ostream& output);
+#endif
+    protected:
+    public:
+        TileServer(const Configuration& configuration);
+        ~TileServer();
+
+        const Configuration configuration;
+
+        // Blocks until stop() is called from other thread
+        bool serve(QString *pLog = nullptr);
+        void stop();
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TOOLS_TILE_SERVER_H_)
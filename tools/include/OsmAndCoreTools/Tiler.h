@@ -0,0 +1,87 @@
+#ifndef _OSMAND_CORE_TOOLS_TILER_H_
+#define _OSMAND_CORE_TOOLS_TILER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <iostream>
+#include <sstream>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/IObfsCollection.h>
+#include <OsmAndCore/Map/IMapStylesCollection.h>
+
+#include <OsmAndCoreTools.h>
+
+namespace OsmAndTools
+{
+    // Renders entire pyramid of tiles that cover given area on given zoom levels using software rasterizer.
+    // All tiles are rendered by a pool of workers that share single set of providers (and their caches)
+    class OSMAND_CORE_TOOLS_API Tiler Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(Tiler);
+
+    public:
+        enum class OutputFormat
+        {
+            // Each tile is written to 'z/x/y.png' file inside output directory
+            Directory,
+
+            // All tiles are written to single SQLite database with MBTiles layout (rows are in TMS order)
+            MBTiles
+        };
+
+        struct OSMAND_CORE_TOOLS_API Configuration Q_DECL_FINAL
+        {
+            Configuration();
+
+            std::shared_ptr<OsmAnd::IObfsCollection> obfsCollection;
+            std::shared_ptr<OsmAnd::IMapStylesCollection> stylesCollection;
+            QString styleName;
+            QHash< QString, QString > styleSettings;
+            OsmAnd::AreaI bbox31;
+            OsmAnd::ZoomLevel minZoom;
+            OsmAnd::ZoomLevel maxZoom;
+            // File of land/water surface type mask, built from basemap if missing. No mask is used if empty
+            QString surfaceTypeMaskPath;
+            QString outputPath;
+            OutputFormat outputFormat;
+            unsigned int threadsCount;
+            unsigned int metatileSize;
+            unsigned int referenceTileSize;
+            float displayDensityFactor;
+            QString locale;
+            bool verbose;
+
+            static bool parseFromCommandLineArguments(
+                const QStringList& commandLineArgs,
+                Configuration& outConfiguration,
+                QString& outError);
+        };
+
+    private:
+#if defined(_UNICODE) || defined(UNICODE)
+        bool render(std::wostream& output);
+#else
+        bool render(std::ostream& output);
+#endif
+    protected:
+    public:
+        Tiler(const Configuration& configuration);
+        ~Tiler();
+
+        const Configuration configuration;
+
+        bool render(QString *pLog = nullptr);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_TOOLS_TILER_H_)
@@ -0,0 +1,477 @@
+#include "HighwaysDensityBenchmark.h"
+
+#include <OsmAndCore/stdlib_common.h>
+#include <limits>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <random>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Common.h>
+#include <OsmAndCore/QtCommon.h>
+#include <OsmAndCore/Stopwatch.h>
+
+#include <OsmAndCoreTools.h>
+#include <OsmAndCoreTools/Utilities.h>
+
+namespace OsmAndTools
+{
+    struct Line
+    {
+        bool isHighway;
+        QVector<OsmAnd::PointI> points31;
+    };
+    typedef QList< std::shared_ptr<const Line> > LinesCollection;
+
+    struct DensityLimit
+    {
+        unsigned int densityZoom;
+        unsigned int limitPerCell;
+    };
+
+    // Lines are processed from the last one, since those are drawn on top. Density cells are counted in hash, and
+    // rejected lines are removed one by one
+    static void filterUsingHash(const DensityLimit& densityLimit, LinesCollection& lines)
+    {
+        const auto dZ = densityLimit.densityZoom;
+        const auto cellShift = 31 - dZ;
+        QHash<uint64_t, uint32_t> densityMap;
+
+        auto itLine = OsmAnd::mutableIteratorOf(lines);
+        itLine.toBack();
+        while (itLine.hasPrevious())
+        {
+            const auto& line = itLine.previous();
+            if (!line->isHighway)
+                continue;
+
+            auto accept = false;
+            auto prevX = std::numeric_limits<int32_t>::min();
+            auto prevY = std::numeric_limits<int32_t>::min();
+            for (const auto& point : OsmAnd::constOf(line->points31))
+            {
+                const auto x = point.x >> cellShift;
+                const auto y = point.y >> cellShift;
+                if (x == prevX && y == prevY)
+                    continue;
+                prevX = x;
+                prevY = y;
+
+                auto& density = densityMap[(static_cast<uint64_t>(x) << dZ) | y];
+                if (density < densityLimit.limitPerCell)
+                {
+                    accept = true;
+                    density++;
+                }
+            }
+
+            if (!accept)
+                itLine.remove();
+        }
+    }
+
+    // Same as MapPrimitiviser does: density cells touched by highways are counted in flat grid of limited size,
+    // and accepted lines are compacted in a single pass
+    static void filterUsingGrid(const DensityLimit& densityLimit, LinesCollection& lines)
+    {
+        enum {
+            MaxDensityGridSize = 128,
+        };
+
+        const auto dZ = densityLimit.densityZoom;
+        const auto cellShift = 31 - dZ;
+        const auto linesCount = lines.size();
+
+        OsmAnd::AreaI cellsBBox(
+            std::numeric_limits<int32_t>::max(),
+            std::numeric_limits<int32_t>::max(),
+            std::numeric_limits<int32_t>::min(),
+            std::numeric_limits<int32_t>::min());
+        auto highwaysCount = 0;
+        for (const auto& line : OsmAnd::constOf(lines))
+        {
+            if (!line->isHighway)
+                continue;
+            highwaysCount++;
+
+            for (const auto& point : OsmAnd::constOf(line->points31))
+                cellsBBox.enlargeToInclude(OsmAnd::PointI(point.x >> cellShift, point.y >> cellShift));
+        }
+        if (highwaysCount == 0)
+            return;
+
+        auto gridBBox = cellsBBox;
+        if (gridBBox.width() >= MaxDensityGridSize)
+        {
+            gridBBox.left() = cellsBBox.left() + (cellsBBox.width() - MaxDensityGridSize) / 2;
+            gridBBox.right() = gridBBox.left() + MaxDensityGridSize - 1;
+        }
+        if (gridBBox.height() >= MaxDensityGridSize)
+        {
+            gridBBox.top() = cellsBBox.top() + (cellsBBox.height() - MaxDensityGridSize) / 2;
+            gridBBox.bottom() = gridBBox.top() + MaxDensityGridSize - 1;
+        }
+        const auto gridWidth = gridBBox.width() + 1;
+        const auto gridHeight = gridBBox.height() + 1;
+        QVector<uint32_t> densityGrid(gridWidth * gridHeight, 0u);
+        const auto pDensityGrid = densityGrid.data();
+        QHash<uint64_t, uint32_t> outOfGridDensity;
+        const auto obtainDensity =
+            [dZ, gridBBox, gridWidth, pDensityGrid, &outOfGridDensity]
+            (const int32_t x, const int32_t y) -> uint32_t&
+            {
+                if (gridBBox.contains(x, y))
+                    return pDensityGrid[(y - gridBBox.top()) * gridWidth + (x - gridBBox.left())];
+
+                return outOfGridDensity[(static_cast<uint64_t>(x) << dZ) | y];
+            };
+
+        QVector<bool> acceptedLines(linesCount, true);
+        auto rejectedLinesCount = 0;
+        for (auto lineIdx = linesCount - 1; lineIdx >= 0; lineIdx--)
+        {
+            const auto& line = lines[lineIdx];
+            if (!line->isHighway)
+                continue;
+
+            auto accept = false;
+            auto prevX = std::numeric_limits<int32_t>::min();
+            auto prevY = std::numeric_limits<int32_t>::min();
+            for (const auto& point : OsmAnd::constOf(line->points31))
+            {
+                const auto x = point.x >> cellShift;
+                const auto y = point.y >> cellShift;
+                if (x == prevX && y == prevY)
+                    continue;
+                prevX = x;
+                prevY = y;
+
+                auto& density = obtainDensity(x, y);
+                if (density < densityLimit.limitPerCell)
+                {
+                    accept = true;
+                    density++;
+                }
+            }
+
+            if (!accept)
+            {
+                acceptedLines[lineIdx] = false;
+                rejectedLinesCount++;
+            }
+        }
+        if (rejectedLinesCount == 0)
+            return;
+
+        LinesCollection filteredLines;
+        filteredLines.reserve(linesCount - rejectedLinesCount);
+        for (auto lineIdx = 0; lineIdx < linesCount; lineIdx++)
+        {
+            if (acceptedLines[lineIdx])
+                filteredLines.push_back(lines[lineIdx]);
+        }
+        lines = qMove(filteredLines);
+    }
+
+    struct Measurement
+    {
+        Measurement()
+            : filteringTime(0.0f)
+        {
+        }
+
+        float filteringTime;
+        LinesCollection keptLines;
+    };
+
+    // Each iteration filters own copy of lines, since filtering modifies collection. Copying is not timed
+    template<typename FILTER>
+    static Measurement measure(
+        const LinesCollection& lines,
+        const DensityLimit& densityLimit,
+        const unsigned int iterationsCount,
+        const FILTER& filter)
+    {
+        Measurement measurement;
+        for (auto iteration = 0u; iteration < iterationsCount; iteration++)
+        {
+            auto linesCopy = lines;
+            linesCopy.detach();
+
+            const OsmAnd::Stopwatch filteringStopwatch(true);
+            filter(densityLimit, linesCopy);
+            measurement.filteringTime += filteringStopwatch.elapsed();
+
+            measurement.keptLines = qMove(linesCopy);
+        }
+
+        measurement.filteringTime /= iterationsCount;
+        return measurement;
+    }
+}
+
+OsmAndTools::HighwaysDensityBenchmark::HighwaysDensityBenchmark(const Configuration& configuration_)
+    : configuration(configuration_)
+{
+}
+
+OsmAndTools::HighwaysDensityBenchmark::~HighwaysDensityBenchmark()
+{
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+bool OsmAndTools::HighwaysDensityBenchmark::run(std::wostream& output)
+#else
+bool OsmAndTools::HighwaysDensityBenchmark::run(std::ostream& output)
+#endif
+{
+    // Tile is taken in the middle of the world, and lines start up to quarter of tile outside of it, as roads
+    // of real tile do. Same seed gives same set, so that runs are comparable
+    const auto tileSize31 = static_cast<int64_t>(1) << (OsmAnd::MaxZoomLevel - configuration.zoom);
+    const auto tileOrigin31 = (static_cast<int64_t>(1) << (OsmAnd::MaxZoomLevel - 1)) & ~(tileSize31 - 1);
+    const auto stepSize31 = qMax(tileSize31 / 32, static_cast<int64_t>(1));
+    std::mt19937 randomGenerator(configuration.seed);
+    std::uniform_int_distribution<int64_t> startDistribution(-tileSize31 / 4, tileSize31 + tileSize31 / 4);
+    std::uniform_int_distribution<int64_t> stepDistribution(-stepSize31, stepSize31);
+    std::uniform_int_distribution<unsigned int> pointsCountDistribution(
+        configuration.minPointsCount,
+        configuration.maxPointsCount);
+    std::bernoulli_distribution highwayDistribution(configuration.highwaysFraction);
+    LinesCollection lines;
+    lines.reserve(configuration.linesCount);
+    auto pointsCount = 0;
+    for (auto lineIndex = 0u; lineIndex < configuration.linesCount; lineIndex++)
+    {
+        const std::shared_ptr<Line> line(new Line());
+        line->isHighway = highwayDistribution(randomGenerator);
+
+        auto x = tileOrigin31 + startDistribution(randomGenerator);
+        auto y = tileOrigin31 + startDistribution(randomGenerator);
+        const auto linePointsCount = pointsCountDistribution(randomGenerator);
+        line->points31.reserve(linePointsCount);
+        for (auto pointIndex = 0u; pointIndex < linePointsCount; pointIndex++)
+        {
+            x = qBound<int64_t>(0, x, std::numeric_limits<int32_t>::max());
+            y = qBound<int64_t>(0, y, std::numeric_limits<int32_t>::max());
+            line->points31.push_back(OsmAnd::PointI(static_cast<int32_t>(x), static_cast<int32_t>(y)));
+
+            x += stepDistribution(randomGenerator);
+            y += stepDistribution(randomGenerator);
+        }
+        pointsCount += line->points31.size();
+
+        lines.push_back(line);
+    }
+    if (configuration.verbose)
+    {
+        output
+            << xT("Generated ") << lines.size() << xT(" lines with ")
+            << pointsCount << xT(" points around tile of zoom ") << configuration.zoom
+            << std::endl;
+    }
+
+    DensityLimit densityLimit;
+    densityLimit.densityZoom = configuration.zoom + configuration.roadDensityZoomTile;
+    densityLimit.limitPerCell = configuration.roadsDensityLimitPerTile;
+    const auto hashMeasurement = measure(lines, densityLimit, configuration.iterationsCount, &filterUsingHash);
+    const auto gridMeasurement = measure(lines, densityLimit, configuration.iterationsCount, &filterUsingGrid);
+
+    const auto printMeasurement =
+        [&output]
+        (const QString& name, const Measurement& measurement)
+        {
+            output
+                << QStringToStlString(name) << xT(": kept ") << measurement.keptLines.size()
+                << xT(" lines in ") << measurement.filteringTime * 1000.0f << xT("ms")
+                << std::endl;
+        };
+    printMeasurement(QLatin1String("Hash"), hashMeasurement);
+    printMeasurement(QLatin1String("Grid"), gridMeasurement);
+
+    if (hashMeasurement.keptLines != gridMeasurement.keptLines)
+    {
+        output << xT("Lines kept by hash and grid differ!") << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool OsmAndTools::HighwaysDensityBenchmark::run(QString *pLog /*= nullptr*/)
+{
+    if (pLog != nullptr)
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        std::wostringstream output;
+        const bool success = run(output);
+        *pLog = QString::fromStdWString(output.str());
+        return success;
+#else
+        std::ostringstream output;
+        const bool success = run(output);
+        *pLog = QString::fromStdString(output.str());
+        return success;
+#endif
+    }
+    else
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        return run(std::wcout);
+#else
+        return run(std::cout);
+#endif
+    }
+}
+
+OsmAndTools::HighwaysDensityBenchmark::Configuration::Configuration()
+    : zoom(OsmAnd::ZoomLevel15)
+    , roadDensityZoomTile(3)
+    , roadsDensityLimitPerTile(8)
+    , linesCount(4000)
+    , minPointsCount(2)
+    , maxPointsCount(32)
+    , highwaysFraction(0.8f)
+    , iterationsCount(20)
+    , seed(0)
+    , verbose(false)
+{
+}
+
+bool OsmAndTools::HighwaysDensityBenchmark::Configuration::parseFromCommandLineArguments(
+    const QStringList& commandLineArgs,
+    Configuration& outConfiguration,
+    QString& outError)
+{
+    outConfiguration = Configuration();
+
+    const auto parseCount =
+        []
+        (const QString& value, unsigned int& outCount) -> bool
+        {
+            bool ok = false;
+            outCount = value.toUInt(&ok);
+            return ok;
+        };
+
+    for (const auto& arg : commandLineArgs)
+    {
+        if (arg.startsWith(QLatin1String("-zoom=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-zoom=")));
+
+            bool ok = false;
+            const auto zoom = value.toInt(&ok);
+            if (!ok || zoom < OsmAnd::MinZoomLevel || zoom > OsmAnd::MaxZoomLevel)
+            {
+                outError = QString("'%1' can not be parsed as zoom").arg(value);
+                return false;
+            }
+            outConfiguration.zoom = static_cast<OsmAnd::ZoomLevel>(zoom);
+        }
+        else if (arg.startsWith(QLatin1String("-roadDensityZoomTile=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-roadDensityZoomTile=")));
+            if (!parseCount(value, outConfiguration.roadDensityZoomTile) || outConfiguration.roadDensityZoomTile == 0)
+            {
+                outError = QString("'%1' can not be parsed as road density zoom tile").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-roadsDensityLimitPerTile=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-roadsDensityLimitPerTile=")));
+            if (!parseCount(value, outConfiguration.roadsDensityLimitPerTile) || outConfiguration.roadsDensityLimitPerTile == 0)
+            {
+                outError = QString("'%1' can not be parsed as roads density limit").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-linesCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-linesCount=")));
+            if (!parseCount(value, outConfiguration.linesCount))
+            {
+                outError = QString("'%1' can not be parsed as lines count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-minPointsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-minPointsCount=")));
+            if (!parseCount(value, outConfiguration.minPointsCount) || outConfiguration.minPointsCount == 0)
+            {
+                outError = QString("'%1' can not be parsed as points count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-maxPointsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-maxPointsCount=")));
+            if (!parseCount(value, outConfiguration.maxPointsCount) || outConfiguration.maxPointsCount == 0)
+            {
+                outError = QString("'%1' can not be parsed as points count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-highwaysFraction=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-highwaysFraction=")));
+
+            bool ok = false;
+            outConfiguration.highwaysFraction = value.toFloat(&ok);
+            if (!ok || outConfiguration.highwaysFraction < 0.0f || outConfiguration.highwaysFraction > 1.0f)
+            {
+                outError = QString("'%1' can not be parsed as fraction").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-iterationsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-iterationsCount=")));
+            if (!parseCount(value, outConfiguration.iterationsCount) || outConfiguration.iterationsCount == 0)
+            {
+                outError = QString("'%1' can not be parsed as iterations count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-seed=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-seed=")));
+            if (!parseCount(value, outConfiguration.seed))
+            {
+                outError = QString("'%1' can not be parsed as seed").arg(value);
+                return false;
+            }
+        }
+        else if (arg == QLatin1String("-verbose"))
+        {
+            outConfiguration.verbose = true;
+        }
+        else
+        {
+            outError = QString("Unrecognized argument: '%1'").arg(arg);
+            return false;
+        }
+    }
+
+    // Validate
+    if (outConfiguration.minPointsCount > outConfiguration.maxPointsCount)
+    {
+        outError = QLatin1String("'minPointsCount' can not be larger than 'maxPointsCount'");
+        return false;
+    }
+    if (outConfiguration.zoom + outConfiguration.roadDensityZoomTile > OsmAnd::MaxZoomLevel)
+    {
+        outError = QLatin1String("'zoom' with 'roadDensityZoomTile' can not exceed maximal zoom");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,393 @@
+#include "IntersectionsBenchmark.h"
+
+#include <OsmAndCore/stdlib_common.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <random>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QList>
+#include <QVector>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/Common.h>
+#include <OsmAndCore/Stopwatch.h>
+#include <OsmAndCore/QuadTree.h>
+#include <OsmAndCore/UniformGrid.h>
+
+#include <OsmAndCoreTools.h>
+#include <OsmAndCoreTools/Utilities.h>
+
+namespace OsmAndTools
+{
+    typedef OsmAnd::QuadTree<unsigned int, OsmAnd::AreaI::CoordType> QuadTreeIndex;
+    typedef OsmAnd::UniformGrid<unsigned int, OsmAnd::AreaI::CoordType> UniformGridIndex;
+    typedef QuadTreeIndex::BBox BBox;
+
+    static inline bool testIntersection(const QuadTreeIndex& index, const BBox& bbox)
+    {
+        if (bbox.type == QuadTreeIndex::BBoxType::AABB)
+            return index.test(bbox.asAABB);
+        else /* if (bbox.type == QuadTreeIndex::BBoxType::OOBB) */
+            return index.test(bbox.asOOBB);
+    }
+
+    static inline bool testIntersection(const UniformGridIndex& index, const BBox& bbox)
+    {
+        return index.test(bbox);
+    }
+
+    static inline void insert(QuadTreeIndex& index, const unsigned int element, const BBox& bbox)
+    {
+        if (bbox.type == QuadTreeIndex::BBoxType::AABB)
+            index.insert(element, bbox.asAABB);
+        else /* if (bbox.type == QuadTreeIndex::BBoxType::OOBB) */
+            index.insert(element, bbox.asOOBB);
+    }
+
+    static inline void insert(UniformGridIndex& index, const unsigned int element, const BBox& bbox)
+    {
+        index.insert(element, bbox);
+    }
+
+    struct Measurement
+    {
+        Measurement()
+            : placementTime(0.0f)
+            , hitTestingTime(0.0f)
+            , hitsCount(0)
+        {
+        }
+
+        float placementTime;
+        float hitTestingTime;
+        QList<unsigned int> placedSymbols;
+        unsigned int hitsCount;
+    };
+
+    // Placement is done same way symbols stage does it: symbol is accepted only if it doesn't intersect
+    // any of already accepted ones
+    template<typename INDEX, typename INDEX_FACTORY>
+    static Measurement measure(
+        const QVector<BBox>& symbols,
+        const QVector<OsmAnd::PointI>& hitTestPoints,
+        const unsigned int iterationsCount,
+        const INDEX_FACTORY& indexFactory)
+    {
+        Measurement measurement;
+        for (auto iteration = 0u; iteration < iterationsCount; iteration++)
+        {
+            measurement.placedSymbols.clear();
+            measurement.hitsCount = 0;
+
+            const OsmAnd::Stopwatch placementStopwatch(true);
+            INDEX index(indexFactory());
+            const auto symbolsCount = symbols.size();
+            for (auto symbolIndex = 0; symbolIndex < symbolsCount; symbolIndex++)
+            {
+                const auto& bbox = symbols[symbolIndex];
+                if (testIntersection(index, bbox))
+                    continue;
+
+                insert(index, symbolIndex, bbox);
+                measurement.placedSymbols.push_back(symbolIndex);
+            }
+            measurement.placementTime += placementStopwatch.elapsed();
+
+            const OsmAnd::Stopwatch hitTestingStopwatch(true);
+            QList<unsigned int> hitSymbols;
+            for (const auto& point : OsmAnd::constOf(hitTestPoints))
+            {
+                hitSymbols.clear();
+                index.select(point, hitSymbols);
+                measurement.hitsCount += hitSymbols.size();
+            }
+            measurement.hitTestingTime += hitTestingStopwatch.elapsed();
+        }
+
+        measurement.placementTime /= iterationsCount;
+        measurement.hitTestingTime /= iterationsCount;
+        return measurement;
+    }
+}
+
+OsmAndTools::IntersectionsBenchmark::IntersectionsBenchmark(const Configuration& configuration_)
+    : configuration(configuration_)
+{
+}
+
+OsmAndTools::IntersectionsBenchmark::~IntersectionsBenchmark()
+{
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+bool OsmAndTools::IntersectionsBenchmark::run(std::wostream& output)
+#else
+bool OsmAndTools::IntersectionsBenchmark::run(std::ostream& output)
+#endif
+{
+    const OsmAnd::AreaI viewport(0, 0, configuration.viewportSize.y, configuration.viewportSize.x);
+
+    // Generate symbols and points to hit-test. Same seed gives same set, so that runs are comparable
+    std::mt19937 randomGenerator(configuration.seed);
+    std::uniform_int_distribution<int> xDistribution(0, configuration.viewportSize.x - 1);
+    std::uniform_int_distribution<int> yDistribution(0, configuration.viewportSize.y - 1);
+    std::uniform_int_distribution<int> widthDistribution(configuration.minSymbolSize.x, configuration.maxSymbolSize.x);
+    std::uniform_int_distribution<int> heightDistribution(configuration.minSymbolSize.y, configuration.maxSymbolSize.y);
+    std::uniform_real_distribution<float> rotationDistribution(0.0f, 2.0f * static_cast<float>(M_PI));
+    std::bernoulli_distribution orientedDistribution(configuration.orientedSymbolsFraction);
+    QVector<BBox> symbols;
+    symbols.reserve(configuration.symbolsCount);
+    for (auto symbolIndex = 0u; symbolIndex < configuration.symbolsCount; symbolIndex++)
+    {
+        const auto aabb = OsmAnd::AreaI::fromCenterAndSize(
+            xDistribution(randomGenerator),
+            yDistribution(randomGenerator),
+            widthDistribution(randomGenerator),
+            heightDistribution(randomGenerator));
+        if (orientedDistribution(randomGenerator))
+            symbols.push_back(BBox(OsmAnd::OOBBI(aabb, rotationDistribution(randomGenerator))));
+        else
+            symbols.push_back(BBox(aabb));
+    }
+    QVector<OsmAnd::PointI> hitTestPoints;
+    hitTestPoints.reserve(configuration.hitTestsCount);
+    for (auto pointIndex = 0u; pointIndex < configuration.hitTestsCount; pointIndex++)
+        hitTestPoints.push_back(OsmAnd::PointI(xDistribution(randomGenerator), yDistribution(randomGenerator)));
+    if (configuration.verbose)
+    {
+        output
+            << xT("Generated ") << symbols.size() << xT(" symbols and ")
+            << hitTestPoints.size() << xT(" hit-test points in ")
+            << configuration.viewportSize.x << xT("x") << configuration.viewportSize.y << xT(" viewport")
+            << std::endl;
+    }
+
+    // Tree depth is chosen same way as symbols stage does it: leaf nodes are not smaller than grid cells
+    auto treeDepth = 0u;
+    for (auto size = qMax(configuration.viewportSize.x, configuration.viewportSize.y) / configuration.cellSize; size > 0; size >>= 1)
+        treeDepth++;
+    const auto quadTreeMeasurement = measure<QuadTreeIndex>(
+        symbols,
+        hitTestPoints,
+        configuration.iterationsCount,
+        [viewport, treeDepth]
+        () -> QuadTreeIndex
+        {
+            return QuadTreeIndex(viewport, qMax(treeDepth, 1u));
+        });
+    const auto uniformGridMeasurement = measure<UniformGridIndex>(
+        symbols,
+        hitTestPoints,
+        configuration.iterationsCount,
+        [this, viewport]
+        () -> UniformGridIndex
+        {
+            return UniformGridIndex(viewport, configuration.cellSize);
+        });
+
+    const auto printMeasurement =
+        [&output]
+        (const QString& name, const Measurement& measurement)
+        {
+            output
+                << QStringToStlString(name) << xT(": placed ") << measurement.placedSymbols.size()
+                << xT(" symbols in ") << measurement.placementTime * 1000.0f << xT("ms, ")
+                << measurement.hitsCount << xT(" hits in ") << measurement.hitTestingTime * 1000.0f << xT("ms")
+                << std::endl;
+        };
+    printMeasurement(QLatin1String("QuadTree"), quadTreeMeasurement);
+    printMeasurement(QLatin1String("UniformGrid"), uniformGridMeasurement);
+
+    if (quadTreeMeasurement.placedSymbols != uniformGridMeasurement.placedSymbols ||
+        quadTreeMeasurement.hitsCount != uniformGridMeasurement.hitsCount)
+    {
+        output << xT("Results of QuadTree and UniformGrid differ!") << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool OsmAndTools::IntersectionsBenchmark::run(QString *pLog /*= nullptr*/)
+{
+    if (pLog != nullptr)
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        std::wostringstream output;
+        const bool success = run(output);
+        *pLog = QString::fromStdWString(output.str());
+        return success;
+#else
+        std::ostringstream output;
+        const bool success = run(output);
+        *pLog = QString::fromStdString(output.str());
+        return success;
+#endif
+    }
+    else
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        return run(std::wcout);
+#else
+        return run(std::cout);
+#endif
+    }
+}
+
+OsmAndTools::IntersectionsBenchmark::Configuration::Configuration()
+    : viewportSize(1920, 1080)
+    , symbolsCount(20000)
+    , minSymbolSize(16, 12)
+    , maxSymbolSize(160, 32)
+    , orientedSymbolsFraction(0.25f)
+    , cellSize(64)
+    , hitTestsCount(10000)
+    , iterationsCount(10)
+    , seed(0)
+    , verbose(false)
+{
+}
+
+bool OsmAndTools::IntersectionsBenchmark::Configuration::parseFromCommandLineArguments(
+    const QStringList& commandLineArgs,
+    Configuration& outConfiguration,
+    QString& outError)
+{
+    outConfiguration = Configuration();
+
+    const auto parsePoint =
+        []
+        (const QString& value, OsmAnd::PointI& outPoint) -> bool
+        {
+            const auto values = value.split(QLatin1Char('x'));
+            if (values.size() != 2)
+                return false;
+
+            bool xOk = false;
+            bool yOk = false;
+            outPoint.x = values[0].toInt(&xOk);
+            outPoint.y = values[1].toInt(&yOk);
+            return xOk && yOk && outPoint.x > 0 && outPoint.y > 0;
+        };
+    const auto parseCount =
+        []
+        (const QString& value, unsigned int& outCount) -> bool
+        {
+            bool ok = false;
+            outCount = value.toUInt(&ok);
+            return ok;
+        };
+
+    for (const auto& arg : commandLineArgs)
+    {
+        if (arg.startsWith(QLatin1String("-viewportSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-viewportSize=")));
+            if (!parsePoint(value, outConfiguration.viewportSize))
+            {
+                outError = QString("'%1' can not be parsed as viewport size").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-symbolsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-symbolsCount=")));
+            if (!parseCount(value, outConfiguration.symbolsCount))
+            {
+                outError = QString("'%1' can not be parsed as symbols count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-minSymbolSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-minSymbolSize=")));
+            if (!parsePoint(value, outConfiguration.minSymbolSize))
+            {
+                outError = QString("'%1' can not be parsed as symbol size").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-maxSymbolSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-maxSymbolSize=")));
+            if (!parsePoint(value, outConfiguration.maxSymbolSize))
+            {
+                outError = QString("'%1' can not be parsed as symbol size").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-orientedSymbolsFraction=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-orientedSymbolsFraction=")));
+
+            bool ok = false;
+            outConfiguration.orientedSymbolsFraction = value.toFloat(&ok);
+            if (!ok || outConfiguration.orientedSymbolsFraction < 0.0f || outConfiguration.orientedSymbolsFraction > 1.0f)
+            {
+                outError = QString("'%1' can not be parsed as fraction").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-cellSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-cellSize=")));
+
+            bool ok = false;
+            outConfiguration.cellSize = value.toInt(&ok);
+            if (!ok || outConfiguration.cellSize <= 0)
+            {
+                outError = QString("'%1' can not be parsed as cell size").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-hitTestsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-hitTestsCount=")));
+            if (!parseCount(value, outConfiguration.hitTestsCount))
+            {
+                outError = QString("'%1' can not be parsed as hit tests count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-iterationsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-iterationsCount=")));
+            if (!parseCount(value, outConfiguration.iterationsCount) || outConfiguration.iterationsCount == 0)
+            {
+                outError = QString("'%1' can not be parsed as iterations count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-seed=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-seed=")));
+            if (!parseCount(value, outConfiguration.seed))
+            {
+                outError = QString("'%1' can not be parsed as seed").arg(value);
+                return false;
+            }
+        }
+        else if (arg == QLatin1String("-verbose"))
+        {
+            outConfiguration.verbose = true;
+        }
+        else
+        {
+            outError = QString("Unrecognized argument: '%1'").arg(arg);
+            return false;
+        }
+    }
+
+    // Validate
+    if (outConfiguration.minSymbolSize.x > outConfiguration.maxSymbolSize.x ||
+        outConfiguration.minSymbolSize.y > outConfiguration.maxSymbolSize.y)
+    {
+        outError = QLatin1String("'minSymbolSize' can not be larger than 'maxSymbolSize'");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,658 @@
+#include "TileServer.h"
+
+#include <OsmAndCore/stdlib_common.h>
+#include <limits>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QDir>
+#include <QFile>
+#include <QList>
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/Stopwatch.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/Concurrent.h>
+#include <OsmAndCore/Map/MapStylesCollection.h>
+#include <OsmAndCore/Map/MapPresentationEnvironment.h>
+#include <OsmAndCore/Map/MapPrimitiviser.h>
+#include <OsmAndCore/Map/ObfMapObjectsProvider.h>
+#include <OsmAndCore/Map/MapSurfaceTypeMask.h>
+#include <OsmAndCore/Map/MapPrimitivesProvider.h>
+#include <OsmAndCore/Map/MapRasterLayerProvider_Software.h>
+#include <OsmAndCore/Map/RasterTilesDiskCache.h>
+
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <SkBitmap.h>
+#include <SkImageEncoder.h>
+#include <SkData.h>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCoreTools.h>
+#include <OsmAndCoreTools/Utilities.h>
+
+namespace OsmAndTools
+{
+    // Listener that only collects descriptors of accepted connections, so that sockets can be created
+    // in threads that handle them
+    class TileServerListener : public QTcpServer
+    {
+    public:
+        QList<qintptr> acceptedSocketDescriptors;
+
+    protected:
+        virtual void incomingConnection(qintptr socketDescriptor)
+        {
+            acceptedSocketDescriptors.push_back(socketDescriptor);
+        }
+    };
+}
+
+OsmAndTools::TileServer::TileServer(const Configuration& configuration_)
+    : _stopRequested(0)
+    , _requestsCount(0)
+    , _cacheHitsCount(0)
+    , _coalescedRequestsCount(0)
+    , _renderedTilesCount(0)
+    , configuration(configuration_)
+{
+}
+
+OsmAndTools::TileServer::~TileServer()
+{
+}
+
+OsmAndTools::TileServer::PendingTile::PendingTile()
+    : isReady(false)
+{
+}
+
+void OsmAndTools::TileServer::handleConnection(QTcpSocket& socket)
+{
+    const auto writeResponse =
+        [&socket]
+        (const char* const status, const char* const contentType, const QByteArray& body, const bool keepAlive) -> bool
+        {
+            QByteArray response;
+            response.reserve(body.size() + 256);
+            response.append("HTTP/1.1 ").append(status).append("\r\n");
+            response.append("Content-Type: ").append(contentType).append("\r\n");
+            response.append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n");
+            response.append(keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n");
+            response.append("\r\n");
+            response.append(body);
+
+            if (socket.write(response) != response.size())
+                return false;
+            while (socket.bytesToWrite() > 0)
+            {
+                if (!socket.waitForBytesWritten(KeepAliveTimeoutInMilliseconds))
+                    return false;
+            }
+            return true;
+        };
+
+    QByteArray buffer;
+    for (;;)
+    {
+        // Read entire request header. Requests with body are not expected
+        int headerEnd = -1;
+        while ((headerEnd = buffer.indexOf("\r\n\r\n")) < 0)
+        {
+            if (buffer.size() > MaxRequestSizeInBytes || _stopRequested.loadAcquire() != 0)
+                return;
+            if (socket.bytesAvailable() <= 0 && !socket.waitForReadyRead(KeepAliveTimeoutInMilliseconds))
+                return;
+            buffer.append(socket.readAll());
+        }
+        const auto requestHeader = buffer.left(headerEnd);
+        buffer.remove(0, headerEnd + 4);
+
+        // Parse request line and headers
+        const auto requestLines = requestHeader.split('\n');
+        const auto requestLine = requestLines.first().trimmed().split(' ');
+        if (requestLine.size() != 3)
+        {
+            writeResponse("400 Bad Request", "text/plain", "Malformed request", false);
+            return;
+        }
+        const auto& method = requestLine[0];
+        const auto& path = requestLine[1];
+        const auto& version = requestLine[2];
+        auto keepAlive = (version == "HTTP/1.1");
+        for (int lineIdx = 1; lineIdx < requestLines.size(); lineIdx++)
+        {
+            const auto line = requestLines[lineIdx].trimmed().toLower();
+            if (!line.startsWith("connection:"))
+                continue;
+            if (line.contains("close"))
+                keepAlive = false;
+            else if (line.contains("keep-alive"))
+                keepAlive = true;
+        }
+        if (_stopRequested.loadAcquire() != 0)
+            keepAlive = false;
+
+        if (method != "GET")
+        {
+            if (!writeResponse("405 Method Not Allowed", "text/plain", "Only GET is supported", false))
+                return;
+            break;
+        }
+
+        // Path has to be '/z/x/y.png', optionally followed by query
+        auto tilePath = path;
+        const auto queryStart = tilePath.indexOf('?');
+        if (queryStart >= 0)
+            tilePath.truncate(queryStart);
+        const auto pathParts = tilePath.split('/');
+        bool ok = (pathParts.size() == 4 && pathParts[0].isEmpty() && pathParts[3].endsWith(".png"));
+        int zoom = -1;
+        OsmAnd::TileId tileId;
+        if (ok)
+            zoom = pathParts[1].toInt(&ok);
+        ok = ok && zoom >= _rasterLayerProvider->getMinZoom() && zoom <= _rasterLayerProvider->getMaxZoom();
+        if (ok)
+            tileId.x = pathParts[2].toInt(&ok);
+        if (ok)
+            tileId.y = pathParts[3].left(pathParts[3].size() - 4).toInt(&ok);
+        const auto tilesPerSide = (static_cast<int64_t>(1) << qMax(zoom, 0));
+        ok = ok && tileId.x >= 0 && tileId.x < tilesPerSide && tileId.y >= 0 && tileId.y < tilesPerSide;
+        if (!ok)
+        {
+            if (!writeResponse("404 Not Found", "text/plain", "Expected /z/x/y.png", keepAlive))
+                return;
+        }
+        else
+        {
+            QByteArray tileData;
+            if (obtainTile(tileId, static_cast<OsmAnd::ZoomLevel>(zoom), tileData))
+            {
+                if (!writeResponse("200 OK", "image/png", tileData, keepAlive))
+                    return;
+            }
+            else
+            {
+                // Tile without any data
+                if (!writeResponse("404 Not Found", "text/plain", "No data", keepAlive))
+                    return;
+            }
+        }
+
+        if (!keepAlive)
+            break;
+    }
+
+    socket.disconnectFromHost();
+    if (socket.state() != QAbstractSocket::UnconnectedState)
+        socket.waitForDisconnected(KeepAliveTimeoutInMilliseconds);
+}
+
+bool OsmAndTools::TileServer::obtainTile(const OsmAnd::TileId tileId, const OsmAnd::ZoomLevel zoom, QByteArray& outData)
+{
+    _requestsCount.fetchAndAddOrdered(1);
+    const TileKey key(tileId.id, zoom);
+
+    QMutexLocker scopedLocker(&_tilesMutex);
+
+    if (const auto pCachedData = _tilesCache.object(key))
+    {
+        _cacheHitsCount.fetchAndAddOrdered(1);
+
+        outData = *pCachedData;
+        return !outData.isEmpty();
+    }
+
+    // In case same tile is already being rendered, just wait for it. Otherwise render it on render pool
+    auto pendingTile = _pendingTiles.value(key);
+    if (pendingTile)
+    {
+        _coalescedRequestsCount.fetchAndAddOrdered(1);
+    }
+    else
+    {
+        pendingTile.reset(new PendingTile());
+        _pendingTiles.insert(key, pendingTile);
+
+        const auto task = new OsmAnd::Concurrent::Task(
+            [this, tileId, zoom, key, pendingTile]
+            (OsmAnd::Concurrent::Task* const task)
+            {
+                const auto data = renderTile(tileId, zoom);
+
+                QMutexLocker scopedLocker(&_tilesMutex);
+
+                pendingTile->data = data;
+                pendingTile->isReady = true;
+                _pendingTiles.remove(key);
+
+                // Tiles without data are cached as well, since obtaining them is not free either
+                _tilesCache.insert(key, new QByteArray(data), qMax(data.size(), 1));
+
+                _pendingTileReady.wakeAll();
+            });
+        _renderPool.start(task);
+    }
+
+    while (!pendingTile->isReady)
+        _pendingTileReady.wait(&_tilesMutex);
+
+    outData = pendingTile->data;
+    return !outData.isEmpty();
+}
+
+QByteArray OsmAndTools::TileServer::renderTile(const OsmAnd::TileId tileId, const OsmAnd::ZoomLevel zoom)
+{
+    std::shared_ptr<OsmAnd::MapRasterLayerProvider::Data> tileData;
+    _rasterLayerProvider->obtainData(tileId, zoom, tileData, nullptr, nullptr);
+    _renderedTilesCount.fetchAndAddOrdered(1);
+    if (!tileData)
+        return QByteArray();
+
+    QByteArray data;
+    const auto encodedTile = SkImageEncoder::EncodeData(*tileData->bitmap, SkImageEncoder::kPNG_Type, 100);
+    if (encodedTile)
+    {
+        data = QByteArray(reinterpret_cast<const char*>(encodedTile->bytes()), encodedTile->size());
+        encodedTile->unref();
+    }
+    return data;
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+bool OsmAndTools::TileServer::serve(std::wostream& output)
+#else
+bool OsmAndTools::TileServer::serve(std::ostream& output)
+#endif
+{
+    // Find style
+    if (configuration.verbose)
+        output << xT("Resolving style '") << QStringToStlString(configuration.styleName) << xT("'...") << std::endl;
+    const auto mapStyle = configuration.stylesCollection->getResolvedStyleByName(configuration.styleName);
+    if (!mapStyle)
+    {
+        output << xT("Failed to resolve style '") << QStringToStlString(configuration.styleName) << xT("' from collection") << std::endl;
+        return false;
+    }
+
+    // Prepare providers, shared by all requests
+    if (configuration.verbose)
+        output << xT("Creating providers...") << std::endl;
+    const std::shared_ptr<OsmAnd::MapPresentationEnvironment> mapPresentationEnvironment(new OsmAnd::MapPresentationEnvironment(
+        mapStyle,
+        configuration.displayDensityFactor,
+        configuration.locale));
+    mapPresentationEnvironment->setSettings(configuration.styleSettings);
+    const std::shared_ptr<OsmAnd::MapPrimitiviser> primitiviser(new OsmAnd::MapPrimitiviser(
+        mapPresentationEnvironment));
+    std::shared_ptr<const OsmAnd::MapSurfaceTypeMask> surfaceTypeMask;
+    if (!configuration.surfaceTypeMaskPath.isEmpty())
+    {
+        if (configuration.verbose)
+        {
+            output
+                << xT("Obtaining surface type mask '")
+                << QStringToStlString(configuration.surfaceTypeMaskPath)
+                << xT("'...") << std::endl;
+        }
+        surfaceTypeMask = OsmAnd::MapSurfaceTypeMask::obtain(
+            configuration.obfsCollection,
+            configuration.surfaceTypeMaskPath);
+    }
+    const std::shared_ptr<OsmAnd::ObfMapObjectsProvider> mapObjectsProvider(new OsmAnd::ObfMapObjectsProvider(
+        configuration.obfsCollection,
+        OsmAnd::ObfMapObjectsProvider::Mode::BinaryMapObjectsAndRoads,
+        surfaceTypeMask));
+    std::shared_ptr<OsmAnd::RasterTilesDiskCache> primitivesDiskCache;
+    if (!configuration.primitivesCachePath.isEmpty())
+        primitivesDiskCache.reset(new OsmAnd::RasterTilesDiskCache(configuration.primitivesCachePath));
+    const std::shared_ptr<OsmAnd::MapPrimitivesProvider> mapPrimitivesProvider(new OsmAnd::MapPrimitivesProvider(
+        mapObjectsProvider,
+        primitiviser,
+        configuration.referenceTileSize,
+        OsmAnd::MapPrimitivesProvider::Mode::WithSurface,
+        primitivesDiskCache));
+    _rasterLayerProvider.reset(new OsmAnd::MapRasterLayerProvider_Software(
+        mapPrimitivesProvider,
+        true,
+        configuration.metatileSize));
+
+    // Cost of QCache is int, so cache larger than 2GB is limited to that
+    _tilesCache.setMaxCost(static_cast<int>(qMin(
+        static_cast<qint64>(configuration.memoryCacheSizeInMegabytes) * 1024 * 1024,
+        static_cast<qint64>(std::numeric_limits<int>::max()))));
+    _renderPool.setMaxThreadCount(configuration.renderThreadsCount > 0
+        ? configuration.renderThreadsCount
+        : qMax(QThread::idealThreadCount(), 1));
+    _connectionsPool.setMaxThreadCount(configuration.connectionThreadsCount > 0
+        ? configuration.connectionThreadsCount
+        : 4 * _renderPool.maxThreadCount());
+
+    // Listen without event loop, accepting connections in this thread
+    TileServerListener listener;
+    if (!listener.listen(configuration.address, configuration.port))
+    {
+        output
+            << xT("Failed to listen on ") << QStringToStlString(configuration.address.toString())
+            << xT(":") << configuration.port << xT(": ") << QStringToStlString(listener.errorString()) << std::endl;
+
+        _rasterLayerProvider.reset();
+        return false;
+    }
+    output
+        << xT("Serving tiles on http://") << QStringToStlString(listener.serverAddress().toString())
+        << xT(":") << listener.serverPort() << xT("/z/x/y.png") << std::endl;
+
+    const OsmAnd::Stopwatch servingStopwatch(true);
+    while (_stopRequested.loadAcquire() == 0)
+    {
+        if (!listener.waitForNewConnection(100))
+            continue;
+
+        for (const auto socketDescriptor : OsmAnd::constOf(listener.acceptedSocketDescriptors))
+        {
+            const auto task = new OsmAnd::Concurrent::Task(
+                [this, socketDescriptor]
+                (OsmAnd::Concurrent::Task* const task)
+                {
+                    QTcpSocket socket;
+                    if (!socket.setSocketDescriptor(socketDescriptor))
+                        return;
+
+                    handleConnection(socket);
+                });
+            _connectionsPool.start(task);
+        }
+        listener.acceptedSocketDescriptors.clear();
+    }
+    listener.close();
+
+    if (configuration.verbose)
+        output << xT("Waiting for pending requests...") << std::endl;
+    _connectionsPool.waitForDone();
+    _renderPool.waitForDone();
+
+    const auto servingTime = servingStopwatch.elapsed();
+    output
+        << xT("Served ") << _requestsCount.loadAcquire() << xT(" tile requests in ") << servingTime << xT("s: ")
+        << _cacheHitsCount.loadAcquire() << xT(" from cache, ")
+        << _coalescedRequestsCount.loadAcquire() << xT(" coalesced, ")
+        << _renderedTilesCount.loadAcquire() << xT(" rendered") << std::endl;
+
+    _tilesCache.clear();
+    _rasterLayerProvider.reset();
+
+    return true;
+}
+
+bool OsmAndTools::TileServer::serve(QString *pLog /*= nullptr*/)
+{
+    if (pLog != nullptr)
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        std::wostringstream output;
+        const bool success = serve(output);
+        *pLog = QString::fromStdWString(output.str());
+        return success;
+#else
+        std::ostringstream output;
+        const bool success = serve(output);
+        *pLog = QString::fromStdString(output.str());
+        return success;
+#endif
+    }
+    else
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        return serve(std::wcout);
+#else
+        return serve(std::cout);
+#endif
+    }
+}
+
+void OsmAndTools::TileServer::stop()
+{
+    _stopRequested.storeRelease(1);
+}
+
+OsmAndTools::TileServer::Configuration::Configuration()
+    : styleName(QLatin1String("default"))
+    , address(QHostAddress::LocalHost)
+    , port(8080)
+    , renderThreadsCount(0)
+    , connectionThreadsCount(0)
+    , memoryCacheSizeInMegabytes(128)
+    , metatileSize(1)
+    , referenceTileSize(256)
+    , displayDensityFactor(1.0f)
+    , locale(QLatin1String("en"))
+    , verbose(false)
+{
+}
+
+bool OsmAndTools::TileServer::Configuration::parseFromCommandLineArguments(
+    const QStringList& commandLineArgs,
+    Configuration& outConfiguration,
+    QString& outError)
+{
+    outConfiguration = Configuration();
+
+    const std::shared_ptr<OsmAnd::ObfsCollection> obfsCollection(new OsmAnd::ObfsCollection());
+    outConfiguration.obfsCollection = obfsCollection;
+
+    const std::shared_ptr<OsmAnd::MapStylesCollection> stylesCollection(new OsmAnd::MapStylesCollection());
+    outConfiguration.stylesCollection = stylesCollection;
+
+    for (const auto& arg : commandLineArgs)
+    {
+        if (arg.startsWith(QLatin1String("-obfsPath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfsPath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addDirectory(value, false);
+        }
+        else if (arg.startsWith(QLatin1String("-obfsRecursivePath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfsRecursivePath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addDirectory(value, true);
+        }
+        else if (arg.startsWith(QLatin1String("-obfFile=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfFile=")));
+            if (!QFile(value).exists())
+            {
+                outError = QString("'%1' file does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addFile(value);
+        }
+        else if (arg.startsWith(QLatin1String("-stylesPath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-stylesPath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            QFileInfoList styleFilesList;
+            OsmAnd::Utilities::findFiles(QDir(value), QStringList() << QLatin1String("*.render.xml"), styleFilesList, false);
+            for (const auto& styleFile : styleFilesList)
+                stylesCollection->addStyleFromFile(styleFile.absoluteFilePath());
+        }
+        else if (arg.startsWith(QLatin1String("-stylesRecursivePath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-stylesRecursivePath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            QFileInfoList styleFilesList;
+            OsmAnd::Utilities::findFiles(QDir(value), QStringList() << QLatin1String("*.render.xml"), styleFilesList, true);
+            for (const auto& styleFile : styleFilesList)
+                stylesCollection->addStyleFromFile(styleFile.absoluteFilePath());
+        }
+        else if (arg.startsWith(QLatin1String("-styleName=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-styleName=")));
+            outConfiguration.styleName = value;
+        }
+        else if (arg.startsWith(QLatin1String("-styleSetting:")))
+        {
+            const auto settingValue = arg.mid(strlen("-styleSetting:"));
+            const auto settingKeyValue = settingValue.split(QLatin1Char('='));
+            if (settingKeyValue.size() != 2)
+            {
+                outError = QString("'%1' can not be parsed as style settings key and value").arg(settingValue);
+                return false;
+            }
+
+            outConfiguration.styleSettings[settingKeyValue[0]] = Utilities::purifyArgumentValue(settingKeyValue[1]);
+        }
+        else if (arg.startsWith(QLatin1String("-address=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-address=")));
+            if (!outConfiguration.address.setAddress(value))
+            {
+                outError = QString("'%1' can not be parsed as address").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-port=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-port=")));
+
+            bool ok = false;
+            outConfiguration.port = value.toUShort(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as port").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-renderThreadsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-renderThreadsCount=")));
+
+            bool ok = false;
+            outConfiguration.renderThreadsCount = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as render threads count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-connectionThreadsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-connectionThreadsCount=")));
+
+            bool ok = false;
+            outConfiguration.connectionThreadsCount = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as connection threads count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-memoryCacheSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-memoryCacheSize=")));
+
+            bool ok = false;
+            outConfiguration.memoryCacheSizeInMegabytes = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as memory cache size in megabytes").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-surfaceTypeMask=")))
+        {
+            outConfiguration.surfaceTypeMaskPath = Utilities::resolvePath(arg.mid(strlen("-surfaceTypeMask=")));
+        }
+        else if (arg.startsWith(QLatin1String("-primitivesCachePath=")))
+        {
+            outConfiguration.primitivesCachePath = Utilities::resolvePath(arg.mid(strlen("-primitivesCachePath=")));
+        }
+        else if (arg.startsWith(QLatin1String("-metatileSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-metatileSize=")));
+
+            bool ok = false;
+            outConfiguration.metatileSize = value.toUInt(&ok);
+            if (!ok || outConfiguration.metatileSize == 0)
+            {
+                outError = QString("'%1' can not be parsed as metatile size").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-referenceTileSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-referenceTileSize=")));
+
+            bool ok = false;
+            outConfiguration.referenceTileSize = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as reference tile size in pixels").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-displayDensityFactor=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-displayDensityFactor=")));
+
+            bool ok = false;
+            outConfiguration.displayDensityFactor = value.toFloat(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as display density factor").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-locale=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-locale=")));
+
+            outConfiguration.locale = value;
+        }
+        else if (arg == QLatin1String("-verbose"))
+        {
+            outConfiguration.verbose = true;
+        }
+        else
+        {
+            outError = QString("Unrecognized argument: '%1'").arg(arg);
+            return false;
+        }
+    }
+
+    // Validate
+    if (outConfiguration.styleName.isEmpty())
+    {
+        outError = QLatin1String("'styleName' can not be empty");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,808 @@
+#include "Tiler.h"
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QVector>
+#include <QList>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QtSql>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/ObfsCollection.h>
+#include <OsmAndCore/Stopwatch.h>
+#include <OsmAndCore/Utilities.h>
+#include <OsmAndCore/Concurrent.h>
+#include <OsmAndCore/FunctorQueryController.h>
+#include <OsmAndCore/Map/MapStylesCollection.h>
+#include <OsmAndCore/Map/MapPresentationEnvironment.h>
+#include <OsmAndCore/Map/MapPrimitiviser.h>
+#include <OsmAndCore/Map/MapPrimitiviser_Metrics.h>
+#include <OsmAndCore/Map/ObfMapObjectsProvider.h>
+#include <OsmAndCore/Map/MapSurfaceTypeMask.h>
+#include <OsmAndCore/Map/ObfMapObjectsProvider_Metrics.h>
+#include <OsmAndCore/Map/MapPrimitivesProvider.h>
+#include <OsmAndCore/Map/MapPrimitivesProvider_Metrics.h>
+#include <OsmAndCore/Map/MapRasterizer_Metrics.h>
+#include <OsmAndCore/Map/MapRasterLayerProvider_Software.h>
+#include <OsmAndCore/Map/MapRasterLayerProvider_Metrics.h>
+
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <SkBitmap.h>
+#include <SkImageEncoder.h>
+#include <SkData.h>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCoreTools.h>
+#include <OsmAndCoreTools/Utilities.h>
+
+OsmAndTools::Tiler::Tiler(const Configuration& configuration_)
+    : configuration(configuration_)
+{
+}
+
+OsmAndTools::Tiler::~Tiler()
+{
+}
+
+#if defined(_UNICODE) || defined(UNICODE)
+bool OsmAndTools::Tiler::render(std::wostream& output)
+#else
+bool OsmAndTools::Tiler::render(std::ostream& output)
+#endif
+{
+    if (configuration.outputPath.isEmpty())
+        return false;
+    if (configuration.minZoom > configuration.maxZoom)
+        return false;
+
+    OsmAnd::Stopwatch totalStopwatch(true);
+
+    // Find style
+    if (configuration.verbose)
+        output << xT("Resolving style '") << QStringToStlString(configuration.styleName) << xT("'...") << std::endl;
+    const auto mapStyle = configuration.stylesCollection->getResolvedStyleByName(configuration.styleName);
+    if (!mapStyle)
+    {
+        output << xT("Failed to resolve style '") << QStringToStlString(configuration.styleName) << xT("' from collection") << std::endl;
+        return false;
+    }
+
+    // Prepare providers. All of them are shared by all workers, so that data and primitives of neighbour tiles
+    // (e.g. shared map objects, coastlines and metatiles) are reused
+    if (configuration.verbose)
+    {
+        output
+            << xT("Initializing map presentation environment with display density ")
+            << configuration.displayDensityFactor
+            << xT(" and locale '")
+            << QStringToStlString(configuration.locale)
+            << xT("'...") << std::endl;
+    }
+    const std::shared_ptr<OsmAnd::MapPresentationEnvironment> mapPresentationEnvironment(new OsmAnd::MapPresentationEnvironment(
+        mapStyle,
+        configuration.displayDensityFactor,
+        configuration.locale));
+    mapPresentationEnvironment->setSettings(configuration.styleSettings);
+
+    if (configuration.verbose)
+        output << xT("Creating providers...") << std::endl;
+    const std::shared_ptr<OsmAnd::MapPrimitiviser> primitiviser(new OsmAnd::MapPrimitiviser(
+        mapPresentationEnvironment));
+    std::shared_ptr<const OsmAnd::MapSurfaceTypeMask> surfaceTypeMask;
+    if (!configuration.surfaceTypeMaskPath.isEmpty())
+    {
+        if (configuration.verbose)
+        {
+            output
+                << xT("Obtaining surface type mask '")
+                << QStringToStlString(configuration.surfaceTypeMaskPath)
+                << xT("'...") << std::endl;
+        }
+        surfaceTypeMask = OsmAnd::MapSurfaceTypeMask::obtain(
+            configuration.obfsCollection,
+            configuration.surfaceTypeMaskPath);
+    }
+    const std::shared_ptr<OsmAnd::ObfMapObjectsProvider> mapObjectsProvider(new OsmAnd::ObfMapObjectsProvider(
+        configuration.obfsCollection,
+        OsmAnd::ObfMapObjectsProvider::Mode::BinaryMapObjectsAndRoads,
+        surfaceTypeMask));
+    // Single primitiviser cache keeps primitives groups and coastlines parts per zoom, so that objects shared by
+    // tiles that are rendered by different workers are primitivised once
+    const std::shared_ptr<OsmAnd::MapPrimitiviser::Cache> primitiviserCache(new OsmAnd::MapPrimitiviser::Cache());
+    const std::shared_ptr<OsmAnd::MapPrimitivesProvider> mapPrimitivesProvider(new OsmAnd::MapPrimitivesProvider(
+        mapObjectsProvider,
+        primitiviser,
+        configuration.referenceTileSize,
+        OsmAnd::MapPrimitivesProvider::Mode::WithSurface,
+        nullptr,
+        primitiviserCache));
+    const std::shared_ptr<OsmAnd::MapRasterLayerProvider_Software> mapRasterLayerProvider(new OsmAnd::MapRasterLayerProvider_Software(
+        mapPrimitivesProvider,
+        true,
+        configuration.metatileSize));
+
+    // Collect all tiles of pyramid. Tiles of each zoom are ordered row by row, so that concurrently rendered tiles
+    // are close to each other
+    struct TileToRender
+    {
+        OsmAnd::TileId tileId;
+        OsmAnd::ZoomLevel zoom;
+    };
+    QVector<TileToRender> tilesToRender;
+    for (int zoom = configuration.minZoom; zoom <= configuration.maxZoom; zoom++)
+    {
+        const auto shift = OsmAnd::MaxZoomLevel - zoom;
+        const auto topLeftTileId = OsmAnd::TileId::fromXY(
+            configuration.bbox31.left() >> shift,
+            configuration.bbox31.top() >> shift);
+        const auto bottomRightTileId = OsmAnd::TileId::fromXY(
+            configuration.bbox31.right() >> shift,
+            configuration.bbox31.bottom() >> shift);
+
+        for (auto y = topLeftTileId.y; y <= bottomRightTileId.y; y++)
+        {
+            for (auto x = topLeftTileId.x; x <= bottomRightTileId.x; x++)
+            {
+                TileToRender tileToRender;
+                tileToRender.tileId = OsmAnd::TileId::fromXY(x, y);
+                tileToRender.zoom = static_cast<OsmAnd::ZoomLevel>(zoom);
+                tilesToRender.push_back(tileToRender);
+            }
+        }
+    }
+    const auto tilesCount = tilesToRender.size();
+    if (configuration.verbose)
+        output << xT("Going to render ") << tilesCount << xT(" tiles") << std::endl;
+
+    // Prepare output
+    const auto mbtilesConnectionName = QLatin1String("tiler-mbtiles:") + configuration.outputPath;
+    bool success = true;
+    {
+        QSqlDatabase mbtilesDb;
+        switch (configuration.outputFormat)
+        {
+            case OutputFormat::Directory:
+                if (!QDir(configuration.outputPath).mkpath(QLatin1String(".")))
+                {
+                    output << xT("Failed to create output directory '") << QStringToStlString(configuration.outputPath) << xT("'") << std::endl;
+                    return false;
+                }
+                break;
+
+            case OutputFormat::MBTiles:
+            {
+                QFileInfo(configuration.outputPath).absoluteDir().mkpath(QLatin1String("."));
+                mbtilesDb = QSqlDatabase::addDatabase(QLatin1String("QSQLITE"), mbtilesConnectionName);
+                mbtilesDb.setDatabaseName(configuration.outputPath);
+                success = mbtilesDb.open();
+                if (success)
+                {
+                    QSqlQuery query(mbtilesDb);
+                    success = success && query.exec(QLatin1String("CREATE TABLE IF NOT EXISTS metadata (name TEXT, value TEXT)"));
+                    success = success && query.exec(QLatin1String("CREATE UNIQUE INDEX IF NOT EXISTS name ON metadata (name)"));
+                    success = success && query.exec(QLatin1String("CREATE TABLE IF NOT EXISTS tiles (zoom_level INTEGER, tile_column INTEGER, tile_row INTEGER, tile_data BLOB)"));
+                    success = success && query.exec(QLatin1String("CREATE UNIQUE INDEX IF NOT EXISTS tile_index ON tiles (zoom_level, tile_column, tile_row)"));
+
+                    const auto topLeft = OsmAnd::Utilities::convert31ToLatLon(configuration.bbox31.topLeft);
+                    const auto bottomRight = OsmAnd::Utilities::convert31ToLatLon(configuration.bbox31.bottomRight);
+                    QHash<QString, QString> metadata;
+                    metadata.insert(QLatin1String("name"), configuration.styleName);
+                    metadata.insert(QLatin1String("type"), QLatin1String("baselayer"));
+                    metadata.insert(QLatin1String("version"), QLatin1String("1.1"));
+                    metadata.insert(QLatin1String("format"), QLatin1String("png"));
+                    metadata.insert(QLatin1String("minzoom"), QString::number(configuration.minZoom));
+                    metadata.insert(QLatin1String("maxzoom"), QString::number(configuration.maxZoom));
+                    metadata.insert(QLatin1String("bounds"), QString(QLatin1String("%1,%2,%3,%4"))
+                        .arg(topLeft.longitude)
+                        .arg(bottomRight.latitude)
+                        .arg(bottomRight.longitude)
+                        .arg(topLeft.latitude));
+                    success = success && query.prepare(QLatin1String("INSERT OR REPLACE INTO metadata (name, value) VALUES (?, ?)"));
+                    for (auto itMetadataEntry = metadata.cbegin(); success && itMetadataEntry != metadata.cend(); ++itMetadataEntry)
+                    {
+                        query.addBindValue(itMetadataEntry.key());
+                        query.addBindValue(itMetadataEntry.value());
+                        success = query.exec();
+                    }
+                }
+
+                if (!success)
+                {
+                    output << xT("Failed to prepare MBTiles database '") << QStringToStlString(configuration.outputPath) << xT("': ") << QStringToStlString(mbtilesDb.lastError().text()) << std::endl;
+
+                    mbtilesDb.close();
+                    mbtilesDb = QSqlDatabase();
+                    QSqlDatabase::removeDatabase(mbtilesConnectionName);
+                    return false;
+                }
+                break;
+            }
+        }
+
+        QSqlQuery insertTileQuery(mbtilesDb);
+        if (configuration.outputFormat == OutputFormat::MBTiles)
+        {
+            insertTileQuery.prepare(QLatin1String(
+                "INSERT OR REPLACE INTO tiles (zoom_level, tile_column, tile_row, tile_data) VALUES (?, ?, ?, ?)"));
+            mbtilesDb.transaction();
+        }
+
+        // Per-stage times are summed over all workers, so they are CPU time rather than wall time
+        struct StagesTimes
+        {
+            StagesTimes()
+                : total(0.0f)
+                , readingObjects(0.0f)
+                , primitivising(0.0f)
+                , rasterizing(0.0f)
+                , encoding(0.0f)
+            {
+            }
+
+            float total;
+            float readingObjects;
+            float primitivising;
+            float rasterizing;
+            float encoding;
+
+            StagesTimes& operator+=(const StagesTimes& other)
+            {
+                total += other.total;
+                readingObjects += other.readingObjects;
+                primitivising += other.primitivising;
+                rasterizing += other.rasterizing;
+                encoding += other.encoding;
+                return *this;
+            }
+        };
+        struct RenderedTile
+        {
+            TileToRender tile;
+            bool rendered;
+            QByteArray data;
+            StagesTimes times;
+        };
+
+        const auto threadsCount = configuration.threadsCount > 0
+            ? configuration.threadsCount
+            : static_cast<unsigned int>(qMax(QThread::idealThreadCount(), 1));
+        QThreadPool workersPool;
+        workersPool.setMaxThreadCount(threadsCount);
+
+        QAtomicInt nextTileIndex(0);
+        QAtomicInt aborted(0);
+        const OsmAnd::FunctorQueryController queryController(
+            [&aborted]
+            (const OsmAnd::FunctorQueryController* const controller) -> bool
+            {
+                return aborted.loadAcquire() != 0;
+            });
+
+        // Rendered tiles are written by this thread, since database connection can not be shared by workers.
+        // Number of tiles waiting to be written is limited to keep memory usage bounded
+        QMutex renderedTilesMutex;
+        QWaitCondition renderedTilesAvailable;
+        QList<RenderedTile> renderedTilesQueue;
+        QSemaphore renderedTilesSlots(threadsCount * 4);
+
+        const auto renderTile =
+            [mapRasterLayerProvider, &queryController]
+            (RenderedTile& renderedTile)
+            {
+                OsmAnd::MapRasterLayerProvider_Metrics::Metric_obtainData metric;
+                std::shared_ptr<OsmAnd::MapRasterLayerProvider::Data> tileData;
+                mapRasterLayerProvider->obtainData(
+                    renderedTile.tile.tileId,
+                    renderedTile.tile.zoom,
+                    tileData,
+                    &metric,
+                    &queryController);
+
+                // Metatiles are primitivised by raster layer provider itself, other tiles by primitives provider
+                renderedTile.times.total = metric.elapsedTime;
+                if (const auto rasterizeMetric = metric.findSubmetricOfType<OsmAnd::MapRasterizer_Metrics::Metric_rasterize>())
+                    renderedTile.times.rasterizing += rasterizeMetric->elapsedTime;
+                if (const auto primitiviseMetric = metric.findSubmetricOfType<OsmAnd::MapPrimitiviser_Metrics::Metric_primitiviseWithSurface>())
+                    renderedTile.times.primitivising += primitiviseMetric->elapsedTime;
+                if (const auto primitivesMetric = metric.findSubmetricOfType<OsmAnd::MapPrimitivesProvider_Metrics::Metric_obtainData>())
+                {
+                    if (const auto objectsMetric = primitivesMetric->findSubmetricOfType<OsmAnd::ObfMapObjectsProvider_Metrics::Metric_obtainData>())
+                        renderedTile.times.readingObjects += objectsMetric->elapsedTime;
+                    if (const auto primitiviseMetric = primitivesMetric->findSubmetricOfType<OsmAnd::MapPrimitiviser_Metrics::Metric_primitiviseWithSurface>())
+                        renderedTile.times.primitivising += primitiviseMetric->elapsedTime;
+                }
+                if (!tileData)
+                    return;
+
+                const OsmAnd::Stopwatch encodingStopwatch(true);
+                const auto encodedTile = SkImageEncoder::EncodeData(*tileData->bitmap, SkImageEncoder::kPNG_Type, 100);
+                if (encodedTile)
+                {
+                    renderedTile.data = QByteArray(reinterpret_cast<const char*>(encodedTile->bytes()), encodedTile->size());
+                    encodedTile->unref();
+                }
+                renderedTile.times.encoding = encodingStopwatch.elapsed();
+            };
+
+        if (configuration.verbose)
+            output << xT("Rendering using ") << threadsCount << xT(" workers...") << std::endl;
+        OsmAnd::Stopwatch renderingStopwatch(true);
+        for (auto workerIdx = 0u; workerIdx < threadsCount; workerIdx++)
+        {
+            const auto worker = new OsmAnd::Concurrent::Task(
+                [renderTile, &tilesToRender, tilesCount, &nextTileIndex, &aborted, &renderedTilesMutex, &renderedTilesAvailable, &renderedTilesQueue, &renderedTilesSlots]
+                (OsmAnd::Concurrent::Task* const task)
+                {
+                    for (;;)
+                    {
+                        const auto tileIndex = nextTileIndex.fetchAndAddOrdered(1);
+                        if (tileIndex >= tilesCount)
+                            break;
+
+                        renderedTilesSlots.acquire();
+
+                        RenderedTile renderedTile;
+                        renderedTile.tile = tilesToRender[tileIndex];
+                        renderedTile.rendered = (aborted.loadAcquire() == 0);
+                        if (renderedTile.rendered)
+                            renderTile(renderedTile);
+
+                        QMutexLocker scopedLocker(&renderedTilesMutex);
+                        renderedTilesQueue.push_back(qMove(renderedTile));
+                        renderedTilesAvailable.wakeOne();
+                    }
+                });
+            workersPool.start(worker);
+        }
+
+        StagesTimes totalTimes;
+        float writingTime = 0.0f;
+        auto tilesProcessed = 0;
+        auto tilesWritten = 0;
+        auto tilesEmpty = 0;
+        while (tilesProcessed < tilesCount)
+        {
+            QList<RenderedTile> renderedTiles;
+            {
+                QMutexLocker scopedLocker(&renderedTilesMutex);
+                while (renderedTilesQueue.isEmpty())
+                    renderedTilesAvailable.wait(&renderedTilesMutex);
+                renderedTiles = qMove(renderedTilesQueue);
+                renderedTilesQueue.clear();
+            }
+            renderedTilesSlots.release(renderedTiles.size());
+
+            for (const auto& renderedTile : OsmAnd::constOf(renderedTiles))
+            {
+                tilesProcessed++;
+                if (!renderedTile.rendered)
+                    continue;
+                totalTimes += renderedTile.times;
+                if (renderedTile.data.isEmpty())
+                {
+                    tilesEmpty++;
+                    continue;
+                }
+
+                const OsmAnd::Stopwatch writingStopwatch(true);
+                const auto& tileId = renderedTile.tile.tileId;
+                const auto zoom = renderedTile.tile.zoom;
+                bool written = false;
+                switch (configuration.outputFormat)
+                {
+                    case OutputFormat::Directory:
+                    {
+                        const QDir tileDir(QString(QLatin1String("%1/%2/%3"))
+                            .arg(configuration.outputPath)
+                            .arg(zoom)
+                            .arg(tileId.x));
+                        tileDir.mkpath(QLatin1String("."));
+                        QFile tileFile(tileDir.absoluteFilePath(QString(QLatin1String("%1.png")).arg(tileId.y)));
+                        if (tileFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+                        {
+                            written = (tileFile.write(renderedTile.data) == renderedTile.data.size());
+                            tileFile.close();
+                        }
+                        break;
+                    }
+
+                    case OutputFormat::MBTiles:
+                        // MBTiles uses TMS scheme, where rows are counted from the bottom
+                        insertTileQuery.addBindValue(static_cast<int>(zoom));
+                        insertTileQuery.addBindValue(tileId.x);
+                        insertTileQuery.addBindValue((1 << zoom) - 1 - tileId.y);
+                        insertTileQuery.addBindValue(renderedTile.data);
+                        written = insertTileQuery.exec();
+                        break;
+                }
+                writingTime += writingStopwatch.elapsed();
+
+                if (!written)
+                {
+                    output << xT("Failed to write tile ") << tileId.x << xT("x") << tileId.y << xT("@") << zoom << std::endl;
+                    aborted.storeRelease(1);
+                    success = false;
+                    continue;
+                }
+                tilesWritten++;
+
+                if (configuration.verbose && (tilesWritten % 1000) == 0)
+                {
+                    output
+                        << xT("Written ") << tilesWritten << xT(" of ") << tilesCount << xT(" tiles, ")
+                        << (tilesProcessed / renderingStopwatch.elapsed()) << xT(" tiles/s") << std::endl;
+                }
+            }
+        }
+        workersPool.waitForDone();
+        const auto renderingTime = renderingStopwatch.elapsed();
+
+        if (configuration.outputFormat == OutputFormat::MBTiles && mbtilesDb.isOpen())
+        {
+            if (!mbtilesDb.commit())
+            {
+                output << xT("Failed to commit MBTiles database: ") << QStringToStlString(mbtilesDb.lastError().text()) << std::endl;
+                success = false;
+            }
+            insertTileQuery.clear();
+            mbtilesDb.close();
+        }
+
+        output
+            << xT("Rendered ") << tilesProcessed << xT(" tiles (") << tilesWritten << xT(" written, ") << tilesEmpty << xT(" empty) in ")
+            << renderingTime << xT("s: ") << (tilesProcessed / qMax(renderingTime, 0.001f)) << xT(" tiles/s") << std::endl;
+        output << xT("CPU time by stages:") << std::endl;
+        output << xT("\tobtaining tiles   : ") << totalTimes.total << xT("s") << std::endl;
+        output << xT("\treading objects   : ") << totalTimes.readingObjects << xT("s") << std::endl;
+        output << xT("\tprimitivising     : ") << totalTimes.primitivising << xT("s") << std::endl;
+        output << xT("\trasterizing       : ") << totalTimes.rasterizing << xT("s") << std::endl;
+        output << xT("\tencoding          : ") << totalTimes.encoding << xT("s") << std::endl;
+        output << xT("\twriting           : ") << writingTime << xT("s") << std::endl;
+    }
+    if (configuration.outputFormat == OutputFormat::MBTiles)
+        QSqlDatabase::removeDatabase(mbtilesConnectionName);
+
+    if (configuration.verbose)
+        output << xT("Tiling took ") << totalStopwatch.elapsed() << xT("s") << std::endl;
+
+    return success;
+}
+
+bool OsmAndTools::Tiler::render(QString *pLog /*= nullptr*/)
+{
+    if (pLog != nullptr)
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        std::wostringstream output;
+        const bool success = render(output);
+        *pLog = QString::fromStdWString(output.str());
+        return success;
+#else
+        std::ostringstream output;
+        const bool success = render(output);
+        *pLog = QString::fromStdString(output.str());
+        return success;
+#endif
+    }
+    else
+    {
+#if defined(_UNICODE) || defined(UNICODE)
+        return render(std::wcout);
+#else
+        return render(std::cout);
+#endif
+    }
+}
+
+OsmAndTools::Tiler::Configuration::Configuration()
+    : styleName(QLatin1String("default"))
+    , minZoom(OsmAnd::ZoomLevel10)
+    , maxZoom(OsmAnd::ZoomLevel15)
+    , outputFormat(OutputFormat::Directory)
+    , threadsCount(0)
+    , metatileSize(1)
+    , referenceTileSize(256)
+    , displayDensityFactor(1.0f)
+    , locale(QLatin1String("en"))
+    , verbose(false)
+{
+}
+
+bool OsmAndTools::Tiler::Configuration::parseFromCommandLineArguments(
+    const QStringList& commandLineArgs,
+    Configuration& outConfiguration,
+    QString& outError)
+{
+    outConfiguration = Configuration();
+
+    const std::shared_ptr<OsmAnd::ObfsCollection> obfsCollection(new OsmAnd::ObfsCollection());
+    outConfiguration.obfsCollection = obfsCollection;
+
+    const std::shared_ptr<OsmAnd::MapStylesCollection> stylesCollection(new OsmAnd::MapStylesCollection());
+    outConfiguration.stylesCollection = stylesCollection;
+
+    const auto parseZoom =
+        []
+        (const QString& value, OsmAnd::ZoomLevel& outZoom) -> bool
+        {
+            bool ok = false;
+            const auto zoom = value.toInt(&ok);
+            if (!ok || zoom < OsmAnd::MinZoomLevel || zoom > OsmAnd::MaxZoomLevel)
+                return false;
+
+            outZoom = static_cast<OsmAnd::ZoomLevel>(zoom);
+            return true;
+        };
+
+    bool bboxSpecified = false;
+    for (const auto& arg : commandLineArgs)
+    {
+        if (arg.startsWith(QLatin1String("-obfsPath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfsPath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addDirectory(value, false);
+        }
+        else if (arg.startsWith(QLatin1String("-obfsRecursivePath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfsRecursivePath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addDirectory(value, true);
+        }
+        else if (arg.startsWith(QLatin1String("-obfFile=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-obfFile=")));
+            if (!QFile(value).exists())
+            {
+                outError = QString("'%1' file does not exist").arg(value);
+                return false;
+            }
+
+            obfsCollection->addFile(value);
+        }
+        else if (arg.startsWith(QLatin1String("-stylesPath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-stylesPath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            QFileInfoList styleFilesList;
+            OsmAnd::Utilities::findFiles(QDir(value), QStringList() << QLatin1String("*.render.xml"), styleFilesList, false);
+            for (const auto& styleFile : styleFilesList)
+                stylesCollection->addStyleFromFile(styleFile.absoluteFilePath());
+        }
+        else if (arg.startsWith(QLatin1String("-stylesRecursivePath=")))
+        {
+            const auto value = Utilities::resolvePath(arg.mid(strlen("-stylesRecursivePath=")));
+            if (!QDir(value).exists())
+            {
+                outError = QString("'%1' path does not exist").arg(value);
+                return false;
+            }
+
+            QFileInfoList styleFilesList;
+            OsmAnd::Utilities::findFiles(QDir(value), QStringList() << QLatin1String("*.render.xml"), styleFilesList, true);
+            for (const auto& styleFile : styleFilesList)
+                stylesCollection->addStyleFromFile(styleFile.absoluteFilePath());
+        }
+        else if (arg.startsWith(QLatin1String("-styleName=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-styleName=")));
+            outConfiguration.styleName = value;
+        }
+        else if (arg.startsWith(QLatin1String("-styleSetting:")))
+        {
+            const auto settingValue = arg.mid(strlen("-styleSetting:"));
+            const auto settingKeyValue = settingValue.split(QLatin1Char('='));
+            if (settingKeyValue.size() != 2)
+            {
+                outError = QString("'%1' can not be parsed as style settings key and value").arg(settingValue);
+                return false;
+            }
+
+            outConfiguration.styleSettings[settingKeyValue[0]] = Utilities::purifyArgumentValue(settingKeyValue[1]);
+        }
+        else if (arg.startsWith(QLatin1String("-bbox=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-bbox=")));
+            const auto bboxValues = value.split(QLatin1Char(';'));
+            if (bboxValues.size() != 4)
+            {
+                outError = QString("'%1' can not be parsed as top latitude, left longitude, bottom latitude and right longitude").arg(value);
+                return false;
+            }
+
+            double coordinates[4];
+            for (int idx = 0; idx < 4; idx++)
+            {
+                bool ok = false;
+                coordinates[idx] = bboxValues[idx].toDouble(&ok);
+                if (!ok)
+                {
+                    outError = QString("'%1' can not be parsed as coordinate").arg(bboxValues[idx]);
+                    return false;
+                }
+            }
+
+            outConfiguration.bbox31 = OsmAnd::AreaI(
+                OsmAnd::Utilities::convertLatLonTo31(OsmAnd::LatLon(coordinates[0], coordinates[1])),
+                OsmAnd::Utilities::convertLatLonTo31(OsmAnd::LatLon(coordinates[2], coordinates[3])));
+            bboxSpecified = true;
+        }
+        else if (arg.startsWith(QLatin1String("-bbox31=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-bbox31=")));
+            const auto bboxValues = value.split(QLatin1Char(';'));
+            if (bboxValues.size() != 4)
+            {
+                outError = QString("'%1' can not be parsed as top, left, bottom and right 31-coordinates").arg(value);
+                return false;
+            }
+
+            int32_t coordinates[4];
+            for (int idx = 0; idx < 4; idx++)
+            {
+                bool ok = false;
+                coordinates[idx] = bboxValues[idx].toInt(&ok);
+                if (!ok)
+                {
+                    outError = QString("'%1' can not be parsed as 31-coordinate").arg(bboxValues[idx]);
+                    return false;
+                }
+            }
+
+            outConfiguration.bbox31 = OsmAnd::AreaI(coordinates[0], coordinates[1], coordinates[2], coordinates[3]);
+            bboxSpecified = true;
+        }
+        else if (arg.startsWith(QLatin1String("-minZoom=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-minZoom=")));
+            if (!parseZoom(value, outConfiguration.minZoom))
+            {
+                outError = QString("'%1' can not be parsed as minimal zoom").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-maxZoom=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-maxZoom=")));
+            if (!parseZoom(value, outConfiguration.maxZoom))
+            {
+                outError = QString("'%1' can not be parsed as maximal zoom").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-surfaceTypeMask=")))
+        {
+            outConfiguration.surfaceTypeMaskPath = Utilities::resolvePath(arg.mid(strlen("-surfaceTypeMask=")));
+        }
+        else if (arg.startsWith(QLatin1String("-outputPath=")))
+        {
+            outConfiguration.outputPath = Utilities::resolvePath(arg.mid(strlen("-outputPath=")));
+        }
+        else if (arg.startsWith(QLatin1String("-outputFormat=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-outputFormat=")));
+            if (value.compare(QLatin1String("directory"), Qt::CaseInsensitive) == 0)
+                outConfiguration.outputFormat = OutputFormat::Directory;
+            else if (value.compare(QLatin1String("mbtiles"), Qt::CaseInsensitive) == 0)
+                outConfiguration.outputFormat = OutputFormat::MBTiles;
+            else
+            {
+                outError = QString("'%1' can not be parsed as output format").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-threadsCount=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-threadsCount=")));
+
+            bool ok = false;
+            outConfiguration.threadsCount = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as threads count").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-metatileSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-metatileSize=")));
+
+            bool ok = false;
+            outConfiguration.metatileSize = value.toUInt(&ok);
+            if (!ok || outConfiguration.metatileSize == 0)
+            {
+                outError = QString("'%1' can not be parsed as metatile size").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-referenceTileSize=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-referenceTileSize=")));
+
+            bool ok = false;
+            outConfiguration.referenceTileSize = value.toUInt(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as reference tile size in pixels").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-displayDensityFactor=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-displayDensityFactor=")));
+
+            bool ok = false;
+            outConfiguration.displayDensityFactor = value.toFloat(&ok);
+            if (!ok)
+            {
+                outError = QString("'%1' can not be parsed as display density factor").arg(value);
+                return false;
+            }
+        }
+        else if (arg.startsWith(QLatin1String("-locale=")))
+        {
+            const auto value = Utilities::purifyArgumentValue(arg.mid(strlen("-locale=")));
+
+            outConfiguration.locale = value;
+        }
+        else if (arg == QLatin1String("-verbose"))
+        {
+            outConfiguration.verbose = true;
+        }
+        else
+        {
+            outError = QString("Unrecognized argument: '%1'").arg(arg);
+            return false;
+        }
+    }
+
+    // Validate
+    if (outConfiguration.styleName.isEmpty())
+    {
+        outError = QLatin1String("'styleName' can not be empty");
+        return false;
+    }
+    if (!bboxSpecified || outConfiguration.bbox31.top() > outConfiguration.bbox31.bottom() || outConfiguration.bbox31.left() > outConfiguration.bbox31.right())
+    {
+        outError = QLatin1String("'bbox' or 'bbox31' has to specify valid area");
+        return false;
+    }
+    if (outConfiguration.minZoom > outConfiguration.maxZoom)
+    {
+        outError = QLatin1String("'minZoom' can not be greater than 'maxZoom'");
+        return false;
+    }
+    if (outConfiguration.outputPath.isEmpty())
+    {
+        outError = QLatin1String("'outputPath' can not be empty");
+        return false;
+    }
+
+    return true;
+}